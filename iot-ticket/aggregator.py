@@ -0,0 +1,114 @@
+"""Gateway-side aggregation of the samples before the upload.
+
+The samples of each datanode are collected in windows of window s, aligned to multiples of the
+window. When a window closes its min, max, mean and last value are sent to the sink as the
+datanodes <name>_min, <name>_max, <name>_mean and <name>_last on the same path, stamped with the
+start of the window.
+
+The raw samples are passed through as well while a datanode is triggered: a sample at or above
+its threshold, or an anomaly, a sample more than anomaly_k standard deviations off the moving
+average, triggers it for raw_hold s. The defaults of the thresholds are the alarm thresholds of
+the firmware (src/alarm.h).
+
+The sink is an uploader.Uploader or uploader.Worker, the aggregator has the same add() and can
+be put in front of it.
+"""
+import math
+
+import uploader
+
+STATS = ("min", "max", "mean", "last")
+THRESHOLDS = {"CO2eq": 1500, "CO2": 1500, "TVOC": 660}  # ALARM_CO2_HIGH, ALARM_TVOC_HIGH
+WARMUP = 10  # samples before the anomaly detection starts
+ALPHA = 0.1  # weight of a new sample in the moving average and variance
+
+
+class Window:
+    """Window and anomaly state of one datanode."""
+
+    def __init__(self, node):
+        self.node = node
+        self.outputs = [uploader.Datanode("{}_{}".format(node.name, stat), node.path, node.unit,
+                                          "double" if stat == "mean" else node.dataType)
+                        for stat in STATS]
+        self.start = None
+        self.count = 0
+        self.min = self.max = self.sum = self.last = None
+        self.samples = 0
+        self.mean = 0.0
+        self.var = 0.0
+        self.raw_until = None
+
+    def anomaly(self, v, k):
+        """Update the exponentially weighted mean and variance, True when v is an outlier."""
+        self.samples += 1
+        if self.samples == 1:
+            self.mean = float(v)
+            return False
+        deviation = v - self.mean
+        outlier = self.samples > WARMUP and abs(deviation) > k * math.sqrt(self.var) + 1.0
+        self.mean += ALPHA * deviation
+        self.var = (1 - ALPHA) * (self.var + ALPHA * deviation * deviation)
+        return outlier
+
+
+class Aggregator:
+    """Aggregation stage, see the module docstring."""
+
+    def __init__(self, sink, window=60.0, thresholds=THRESHOLDS, anomaly_k=4.0, raw_hold=300.0):
+        self.sink = sink
+        self.window = int(window * 1000)
+        self.thresholds = thresholds
+        self.anomaly_k = anomaly_k
+        self.raw_hold = int(raw_hold * 1000)
+        self.windows = {}
+        self.raw = 0  # samples passed through
+        self.aggregated = 0  # samples folded into windows
+
+    def add(self, node, v, ts):
+        """Fold one sample of node (uploader.Datanode), ts in ms."""
+        key = node.key()
+        w = self.windows.get(key)
+        if w is None:
+            w = self.windows[key] = Window(node)
+        start = ts - ts % self.window
+        if w.start is not None and start != w.start:
+            self.emit(w)
+        if w.count == 0:
+            w.start = start
+            w.min = w.max = v
+            w.sum = 0
+        w.count += 1
+        w.sum += v
+        w.min = min(w.min, v)
+        w.max = max(w.max, v)
+        w.last = v
+        self.aggregated += 1
+
+        threshold = self.thresholds.get(node.name)
+        triggered = w.anomaly(v, self.anomaly_k)
+        if threshold is not None and v >= threshold:
+            triggered = True
+        if triggered:
+            w.raw_until = ts + self.raw_hold
+        if w.raw_until is not None and ts < w.raw_until:
+            self.raw += 1
+            self.sink.add(node, v, ts)
+
+    def emit(self, w):
+        """Send the aggregates of the window of w and clear it."""
+        if w.count:
+            for output, value in zip(w.outputs, (w.min, w.max, w.sum / w.count, w.last)):
+                self.sink.add(output, value, w.start)
+        w.count = 0
+        w.start = None
+
+    def flush(self, now=None):
+        """Close the windows that ended before now (ms), all of them when now is None.
+
+        Call periodically when the samples of a datanode can stop, and before the upload is
+        flushed at exit.
+        """
+        for w in self.windows.values():
+            if w.count and (now is None or now >= w.start + self.window):
+                self.emit(w)
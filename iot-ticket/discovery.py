@@ -0,0 +1,172 @@
+"""RS-485 bus discovery: find the slaves on a segment and build a node inventory.
+
+Every address of the range is probed with Report Slave ID (FC 0x11), a node that answers with
+data or with an exception is present, then its CO2eq register is read with FC 0x04. The probe
+timeout starts at timeout and then shrinks to the response times measured on the bus, as the
+timeouts of the gateway do, so an empty address costs about 20 ms and a full scan of 1-247
+takes seconds. A slower node answers late, its reply then arrives during a later probe and
+comes back as a corrupted or mismatched reply. The address of that reply, the probed address
+and the address before it are probed again with the long timeout at the end.
+
+The nodes running this firmware send the CRC high byte first, standard Modbus slaves low byte
+first, and a slave ignores a request with the CRC in the other order. With --crc both, the
+default, an address silent in the node order is probed again in the standard order, which
+doubles the cost of an empty address. Each node of the inventory has its "crc" order.
+
+Usage: python discovery.py PORT [PORT ...] [--baudrate 9600] [--first 1] [--last 247]
+                           [--timeout 0.05] [--crc both] [--out inventory.json]
+The inventory is printed and written as JSON, with a "buses" list for the gateway config. The
+gateway polls in the node order only, so the "buses" list leaves the standard nodes out.
+"""
+import argparse
+import asyncio
+import json
+import struct
+import time
+
+import serial
+
+import gateway
+import modbus_map
+import modbus_rtu
+
+FIRST = 1
+LAST = 247  # highest unicast address
+CRC_ORDERS = {"node": modbus_rtu.CRC_NODE, "standard": modbus_rtu.CRC_STANDARD}
+
+
+def parse_slave_id(data):
+    """Decode the FC 0x11 data of the SGP30 node (src/device_id.c), other nodes keep raw."""
+    info = {"slave_id": data[0] if data else None, "run": len(data) > 1 and data[1] == 0xFF}
+    if len(data) >= 19 and data[0] == 0x30:
+        info["version"] = "{}.{}.{}".format(data[2], data[3], data[4])
+        info["build"] = "{:08X}".format(struct.unpack(">I", data[5:9])[0])
+        info["serial"] = "{:012X}".format(int.from_bytes(data[9:15], "big"))
+        info["feature_set"] = struct.unpack(">H", data[15:17])[0]
+        info["vendor"] = data[17:].decode("ascii", "replace")
+    else:
+        info["raw"] = data.hex()
+    return info
+
+
+class Scanner:
+    """Scan of one serial port."""
+
+    def __init__(self, port, baudrate=9600, timeout=0.05, port_factory=serial.serial_for_url,
+                 crc=("node", "standard")):
+        self.url = port
+        self.crc = crc  # CRC_ORDERS names, probed in this order
+        self.baudrate = baudrate
+        self.timeout = timeout
+        self.timing = gateway.SlaveState(0, 0)  # response time estimate of the bus
+        self.timing.timeout = timeout
+        self.port_factory = port_factory
+        self.suspects = []
+        self.probes = 0
+
+    async def probe(self, address, timeout):
+        """Probe one address in each CRC order, return its inventory entry or None when it does
+        not answer."""
+        for crc in self.crc:
+            node = await self.probe_order(address, timeout, crc)
+            if node:
+                return node
+        return None
+
+    async def probe_order(self, address, timeout, crc):
+        order = CRC_ORDERS[crc]
+        req = modbus_rtu.report_slave_id_request(address, order)
+        self.probes += 1
+        try:
+            data, rtt = await self.port.transact(req, timeout)
+        except modbus_rtu.ModbusTimeout:
+            return None
+        except modbus_rtu.ModbusFrameError as e:
+            self.suspects.append(address)
+            if e.address is not None:
+                self.suspects.append(e.address)
+            return None
+        except modbus_rtu.ModbusException as e:
+            node = {"address": address, "crc": crc, "slave_id": None,
+                    "report_slave_id": e.name}
+        else:
+            self.timing.on_reply(rtt)
+            node = dict({"address": address, "crc": crc, "rtt_ms": round(rtt * 1000, 1)},
+                        **parse_slave_id(data[1:1 + data[0]]))
+        start = modbus_map.ADDRESS["CO2"]
+        req = modbus_rtu.request(address, modbus_rtu.READ_INPUT_REGISTERS, start, 2, order)
+        try:
+            data, _ = await self.port.transact(req, gateway.TIMEOUT_MAX)
+            node["values"] = modbus_map.decode(start, modbus_rtu.words(data))
+        except modbus_rtu.ModbusException as e:
+            node["read_input_registers"] = e.name
+        except modbus_rtu.ModbusError as e:
+            node["read_input_registers"] = type(e).__name__
+        return node
+
+    async def scan(self, first=FIRST, last=LAST):
+        self.port = gateway.AsyncPort(self.url, self.baudrate, self.port_factory)
+        nodes = []
+        try:
+            for address in range(first, last + 1):
+                # a slow node does not slow the scan down, it is found as a suspect
+                node = await self.probe(address, min(self.timing.timeout, self.timeout))
+                if node:
+                    nodes.append(node)
+            # a corrupted reply can be the late reply of the address before, a reply of another
+            # slave names the address it came from
+            found = {n["address"] for n in nodes}
+            suspects = sorted({a for s in self.suspects for a in (s - 1, s)
+                               if first <= a <= last and a not in found})
+            self.suspects = []
+            for address in suspects:
+                node = await self.probe(address, gateway.TIMEOUT_MAX)
+                if node:
+                    nodes.append(node)
+        finally:
+            self.port.close()
+        return sorted(nodes, key=lambda n: n["address"])
+
+
+async def scan_all(ports, baudrate, first, last, timeout, crc=("node", "standard")):
+    scanners = [Scanner(port, baudrate, timeout, crc=crc) for port in ports]
+    results = await asyncio.gather(*(s.scan(first, last) for s in scanners))
+    return scanners, results
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("ports", nargs="+", help="serial ports, scanned concurrently")
+    parser.add_argument("--baudrate", type=int, default=9600)
+    parser.add_argument("--first", type=int, default=FIRST)
+    parser.add_argument("--last", type=int, default=LAST)
+    parser.add_argument("--timeout", type=float, default=0.05, help="initial probe timeout in s")
+    parser.add_argument("--crc", choices=("node", "standard", "both"), default="both",
+                        help="CRC byte order to probe, node: high byte first as this firmware")
+    parser.add_argument("--out", default="inventory.json")
+    args = parser.parse_args()
+
+    crc = ("node", "standard") if args.crc == "both" else (args.crc,)
+    start = time.monotonic()
+    scanners, results = asyncio.run(scan_all(args.ports, args.baudrate, args.first, args.last,
+                                             args.timeout, crc))
+    elapsed = time.monotonic() - start
+    inventory = {"buses": [], "nodes": {}}
+    for scanner, nodes in zip(scanners, results):
+        print("{}: {} nodes, {} probes, timeout {:.0f} ms".format(
+            scanner.url, len(nodes), scanner.probes, scanner.timing.timeout * 1000))
+        for node in nodes:
+            print("  {:3d}  {}".format(node["address"], json.dumps(
+                {k: v for k, v in node.items() if k != "address"})))
+        inventory["nodes"][scanner.url] = nodes
+        slaves = [n["address"] for n in nodes if n["crc"] == "node"]
+        if slaves:
+            inventory["buses"].append({"port": scanner.url, "baudrate": args.baudrate,
+                                       "slaves": slaves})
+    print("scanned in {:.1f} s, inventory written to {}".format(elapsed, args.out))
+    with open(args.out, "w") as f:
+        json.dump(inventory, f, indent=4)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,354 @@
+"""Asynchronous Modbus RTU gateway, one scheduler per serial port over many slaves.
+
+Each bus is driven by its own task, the buses run concurrently on one event loop. The scheduler
+of a bus polls the slave that is due first and keeps the Modbus inter-frame gap between frames.
+The reply timeout of each slave adapts to its measured response time, a slave that stops
+answering is taken offline and probed with an exponential backoff, so a dead node costs its bus
+one timeout per backoff period instead of one per cycle.
+
+Usage: python gateway.py [config.json]
+
+The buses are listed in the config file:
+    "buses": [{"port": "/dev/ttyUSB0", "baudrate": 9600, "slaves": [5, 6], "period": 5}]
+The request telemetry is served in Prometheus format at http://localhost:<metrics_port>/metrics
+and written every 60 s to metrics_file when these are set in the config.
+"""
+import asyncio
+import collections
+import concurrent.futures
+import heapq
+import json
+import sys
+import time
+
+import serial
+
+import modbus_map
+import modbus_rtu
+import telemetry
+
+BITS_PER_CHAR = 11  # start, 8 data bits, parity or second stop bit, stop
+GAP_CHARS = 3.5
+GAP_MIN = 0.00175  # fixed 1.75 ms gap above 19200 baud
+REPLY_SLACK = 0.02  # USB adapters deliver the bytes of a reply in bursts
+
+TIMEOUT_INIT = 0.2
+TIMEOUT_MIN = 0.02
+TIMEOUT_MAX = 1.0
+FAIL_LIMIT = 3  # failed polls in a row before the slave is taken offline
+BACKOFF_MIN = 1.0
+BACKOFF_MAX = 60.0
+
+# (function, start, count), CO2eq and TVOC in one request
+DEFAULT_POLLS = ((modbus_rtu.READ_INPUT_REGISTERS, modbus_map.ADDRESS["CO2"], 2),)
+
+Sample = collections.namedtuple("Sample", "port slave time values")
+
+
+def char_time(baudrate):
+    return BITS_PER_CHAR / baudrate
+
+
+def frame_gap(baudrate):
+    return GAP_MIN if baudrate > 19200 else GAP_CHARS * char_time(baudrate)
+
+
+class AsyncPort:
+    """Non-blocking serial port on the event loop, the received bytes are buffered by a reader
+    callback. Needs a port with a fileno, i.e. a POSIX tty or pty.
+    """
+
+    def __init__(self, url, baudrate=9600, port_factory=serial.serial_for_url):
+        self.loop = asyncio.get_running_loop()
+        self.port = port_factory(url, baudrate=baudrate, timeout=0)
+        self.baudrate = baudrate
+        self.buf = bytearray()
+        self.idle_since = time.monotonic()  # end of the last frame on the bus, either direction
+        self.first_byte = None
+        self.rtt = None  # response time of the last reply, exception replies included
+        self.event = asyncio.Event()
+        self.loop.add_reader(self.port.fileno(), self._on_readable)
+
+    def _on_readable(self):
+        data = self.port.read(self.port.in_waiting or 1)
+        if not data:
+            return
+        now = time.monotonic()
+        if self.first_byte is None:
+            self.first_byte = now
+        self.idle_since = now
+        self.buf += data
+        self.event.set()
+
+    def close(self):
+        self.loop.remove_reader(self.port.fileno())
+        self.port.close()
+
+    async def wait_gap(self):
+        """Wait until the bus has been silent for the inter-frame gap, late replies included."""
+        gap = frame_gap(self.baudrate)
+        while True:
+            delay = self.idle_since + gap - time.monotonic()
+            if delay <= 0:
+                return
+            await asyncio.sleep(delay)
+
+    async def transact(self, req, timeout):
+        """Send a request and return (reply PDU data, response time in s).
+
+        timeout bounds the wait for the first reply byte, counted from the end of the request,
+        the rest of the reply gets its wire time plus REPLY_SLACK.
+        """
+        await self.wait_gap()
+        self.buf.clear()
+        self.first_byte = None
+        self.rtt = None
+        self.port.write(req)
+        ct = char_time(self.baudrate)
+        sent = time.monotonic() + len(req) * ct
+        self.idle_since = sent
+        deadline = sent + timeout
+        while True:
+            missing = modbus_rtu.reply_remaining(req[1], self.buf)
+            if missing <= 0:
+                break
+            if self.first_byte is not None:
+                deadline = max(deadline, time.monotonic() + missing * ct + REPLY_SLACK)
+            self.event.clear()
+            try:
+                await asyncio.wait_for(self.event.wait(), deadline - time.monotonic())
+            except asyncio.TimeoutError:
+                raise modbus_rtu.ModbusTimeout("slave {} FC 0x{:02X}: {} bytes".format(
+                    req[0], req[1], len(self.buf))) from None
+        reply = bytes(self.buf)
+        self.buf.clear()
+        self.rtt = max(self.first_byte - sent, 0.0)
+        return modbus_rtu.check_reply(req, reply), self.rtt
+
+
+class SlaveState:
+    """Poll schedule, adaptive timeout and backoff of one slave."""
+
+    def __init__(self, address, period, polls=DEFAULT_POLLS, retries=1):
+        self.address = address
+        self.period = period
+        self.polls = polls
+        self.retries = retries
+        self.due = 0.0
+        self.srtt = None
+        self.rttvar = 0.0
+        self.timeout = TIMEOUT_INIT
+        self.online = True
+        self.failures = 0
+        self.backoff = BACKOFF_MIN
+        self.stats = collections.Counter()
+
+    def on_reply(self, rtt=None):
+        """Smoothed response time and variance as in RFC 6298.
+
+        timeout = srtt + 4 * rttvar, with at least TIMEOUT_MIN over srtt for the jitter of a
+        steady slave.
+
+        rtt is None for an exception reply, the slave is alive but the time is not sampled.
+        """
+        if rtt is not None:
+            if self.srtt is None:
+                self.srtt, self.rttvar = rtt, rtt / 2
+            else:
+                self.rttvar = 0.75 * self.rttvar + 0.25 * abs(self.srtt - rtt)
+                self.srtt = 0.875 * self.srtt + 0.125 * rtt
+            self.timeout = min(self.srtt + max(4 * self.rttvar, TIMEOUT_MIN), TIMEOUT_MAX)
+        if not self.online:
+            self.stats["recoveries"] += 1
+        self.online = True
+        self.failures = 0
+        self.backoff = BACKOFF_MIN
+
+    def on_failure(self, now):
+        """Count a failed poll, return True when the slave is offline and waits its backoff."""
+        self.failures += 1
+        if self.online and self.failures < FAIL_LIMIT:
+            return False
+        if self.online:
+            self.stats["offline"] += 1
+        else:
+            self.backoff = min(self.backoff * 2, BACKOFF_MAX)
+        self.online = False
+        self.due = now + self.backoff
+        return True
+
+
+class Bus:
+    """Scheduler of one serial port. on_sample is called with a Sample for every good poll, the
+    outcome of every request is recorded in telemetry when given.
+    """
+
+    def __init__(self, port, slaves, baudrate=9600, on_sample=print,
+                 port_factory=serial.serial_for_url, telemetry=None):
+        self.url = port
+        self.baudrate = baudrate
+        self.slaves = slaves
+        self.on_sample = on_sample
+        self.telemetry = telemetry
+        self.port_factory = port_factory
+        self.port = None
+
+    async def poll(self, slave, function, start, count):
+        """One request with the retries of the slave, offline slaves get a single probe."""
+        req = modbus_rtu.request(slave.address, function, start, count)
+        attempts = 1 + (slave.retries if slave.online else 0)
+        for attempt in range(attempts):
+            slave.stats["requests"] += 1
+            try:
+                data, rtt = await self.port.transact(req, slave.timeout)
+            except modbus_rtu.ModbusException as e:
+                slave.stats["exceptions"] += 1
+                slave.on_reply()
+                self.record(slave, e.code)
+                raise
+            except modbus_rtu.ModbusTimeout:
+                slave.stats["timeouts"] += 1
+                error = "timeout"
+            except modbus_rtu.ModbusCrcError:
+                slave.stats["crc_errors"] += 1
+                error = "crc"
+            except modbus_rtu.ModbusFrameError:
+                slave.stats["frame_errors"] += 1
+                error = "frame"
+            else:
+                slave.on_reply(rtt)
+                self.record(slave, "ok")
+                return data
+            self.record(slave, error)
+            if attempt + 1 < attempts:
+                slave.stats["retries"] += 1
+        raise modbus_rtu.ModbusTimeout(error)
+
+    def record(self, slave, outcome):
+        if self.telemetry is not None:
+            self.telemetry.record(self.url, slave.address, outcome,
+                                  None if outcome == "timeout" else self.port.rtt)
+
+    async def run_slave(self, slave):
+        values = {}
+        for function, start, count in slave.polls:
+            try:
+                data = await self.poll(slave, function, start, count)
+            except modbus_rtu.ModbusException as e:
+                print("{} slave {}: {}".format(self.url, slave.address, e.name))
+                continue
+            except modbus_rtu.ModbusTimeout:
+                if slave.on_failure(time.monotonic()):
+                    return
+                continue
+            if function in (modbus_rtu.READ_INPUT_REGISTERS, modbus_rtu.READ_HOLDING_REGISTERS):
+                values.update(modbus_map.decode(start, modbus_rtu.words(data)))
+            else:
+                names = modbus_map.DISCRETE_INPUTS if function == modbus_rtu.READ_DISCRETE_INPUTS \
+                    else modbus_map.COILS
+                for n, bit in enumerate(modbus_rtu.bits(data, count)):
+                    values[names.get(start + n, start + n)] = bit
+        slave.due = max(slave.due + slave.period, time.monotonic())
+        if values:
+            self.on_sample(Sample(self.url, slave.address, time.time(), values))
+
+    async def run(self):
+        self.port = AsyncPort(self.url, self.baudrate, self.port_factory)
+        now = time.monotonic()
+        queue = []
+        for n, slave in enumerate(self.slaves):
+            slave.due = now
+            heapq.heappush(queue, (slave.due, n, slave))
+        try:
+            while True:
+                due, n, slave = heapq.heappop(queue)
+                delay = due - time.monotonic()
+                if delay > 0:
+                    await asyncio.sleep(delay)
+                await self.run_slave(slave)
+                heapq.heappush(queue, (slave.due, n, slave))
+        finally:
+            self.port.close()
+
+
+class Gateway:
+    """All the buses of a config, see the module docstring."""
+
+    def __init__(self, buses, on_sample=print, port_factory=serial.serial_for_url,
+                 telemetry=None):
+        self.telemetry = telemetry
+        if telemetry is not None:
+            telemetry.state = self.shared_stats
+        self.loop = None
+        self.last_stats = {}
+        self.buses = []
+        for cfg in buses:
+            polls = tuple((f, modbus_map.ADDRESS.get(s, s), c)
+                          for f, s, c in cfg.get("polls", DEFAULT_POLLS))
+            slaves = [SlaveState(address, cfg.get("period", 5), polls, cfg.get("retries", 1))
+                      for address in cfg["slaves"]]
+            self.buses.append(Bus(cfg["port"], slaves, cfg.get("baudrate", 9600), on_sample,
+                                  port_factory, telemetry))
+
+    async def run(self):
+        self.loop = asyncio.get_running_loop()
+        try:
+            await asyncio.gather(*(bus.run() for bus in self.buses))
+        finally:
+            self.loop = None
+
+    def stats(self):
+        """Return {(port, slave): counters} with the current timeout and state."""
+        result = {}
+        for bus in self.buses:
+            for slave in bus.slaves:
+                result[(bus.url, slave.address)] = dict(slave.stats, timeout=slave.timeout,
+                                                        online=slave.online)
+        return result
+
+    def shared_stats(self, timeout=1.0):
+        """stats() for the other threads, e.g. the metrics server.
+
+        The slave state belongs to the event loop, so the copy is taken on the loop. The last copy
+        is returned when the loop does not get to it within timeout s.
+        """
+        loop = self.loop
+        try:
+            on_loop = asyncio.get_running_loop() is loop
+        except RuntimeError:
+            on_loop = False
+        if loop is None or on_loop:
+            self.last_stats = self.stats()
+            return self.last_stats
+        future = concurrent.futures.Future()
+
+        def copy():
+            try:
+                future.set_result(self.stats())
+            except Exception as e:
+                future.set_exception(e)
+        try:
+            loop.call_soon_threadsafe(copy)
+            self.last_stats = future.result(timeout)
+        except (RuntimeError, concurrent.futures.TimeoutError):
+            pass  # loop closed or busy
+        return self.last_stats
+
+
+if __name__ == "__main__":
+    config = json.load(open(sys.argv[1] if len(sys.argv) > 1 else "config.json"))
+    metrics = telemetry.Telemetry()
+    gw = Gateway(config["buses"], telemetry=metrics)
+    if config.get("metrics_port"):
+        metrics.serve(config["metrics_port"])
+    exporter = None
+    if config.get("metrics_file"):
+        exporter = telemetry.FileExporter(metrics, config["metrics_file"])
+        exporter.start()
+    try:
+        asyncio.run(gw.run())
+    except KeyboardInterrupt:
+        pass
+    finally:
+        if exporter is not None:
+            exporter.stop()
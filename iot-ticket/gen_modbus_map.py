@@ -0,0 +1,118 @@
+"""Generate modbus_map.py from the firmware register map in src/modbus_map.h.
+
+Usage: python gen_modbus_map.py [path/to/modbus_map.h] [path/to/modbus_map.py]
+"""
+import os
+import re
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+DEFAULT_HEADER = os.path.join(HERE, "..", "src", "modbus_map.h")
+DEFAULT_OUTPUT = os.path.join(HERE, "modbus_map.py")
+
+# X(name, address, source, type, scale, unit, access, flag)
+REGISTER_RE = re.compile(r'X\(\s*(\w+)\s*,\s*(0x[0-9A-Fa-f]+|\d+)\s*,(.*),\s*([US]16)\s*,'
+                         r'\s*(\d+)\s*,\s*"([^"]*)"\s*,\s*(R|RW)\s*,\s*(\w+)\s*\)')
+# X(name, base, count, reader, access)
+BLOCK_RE = re.compile(r'X\(\s*(\w+)\s*,\s*(0x[0-9A-Fa-f]+|\d+)\s*,\s*(0x[0-9A-Fa-f]+|\d+)\s*,'
+                      r'\s*(\w+)\s*,\s*(R|RW)\s*\)')
+# X(name, address, source), discrete inputs and coils
+BIT_RE = re.compile(r'X\(\s*(\w+)\s*,\s*(0x[0-9A-Fa-f]+|\d+)\s*,(.*)\)')
+
+TEMPLATE = '''"""Modbus register map of the SGP30 node.
+
+Generated by gen_modbus_map.py from src/modbus_map.h, do not edit.
+"""
+
+# address: (name, type, scale, unit, access)
+REGISTERS = {{
+{registers}}}
+
+# name: (base, count, access)
+BLOCKS = {{
+{blocks}}}
+
+# address: name, FC 0x02
+DISCRETE_INPUTS = {{
+{inputs}}}
+
+# address: name, FC 0x01 and 0x05
+COILS = {{
+{coils}}}
+
+ADDRESS = {{name: address for address, (name, *_) in REGISTERS.items()}}
+
+
+def decode_register(address, raw):
+    """Return (name, physical value) of one register, raw is the unsigned 16-bit value."""
+    name, rtype, scale, _unit, _access = REGISTERS[address]
+    if rtype == "S16" and raw & 0x8000:
+        raw -= 0x10000
+    return name, raw / scale if scale != 1 else raw
+
+
+def decode(start, words):
+    """Decode a block read starting from register address start into a dict name: value.
+
+    Registers that are not in REGISTERS (ex. register blocks) are returned as raw words under
+    their address.
+    """
+    result = {{}}
+    for offset, raw in enumerate(words):
+        address = start + offset
+        if address in REGISTERS:
+            name, value = decode_register(address, raw)
+            result[name] = value
+        else:
+            result[address] = raw
+    return result
+'''
+
+
+def parse(header_text):
+    start = header_text.index("#define MODBUS_REGISTER_MAP(X)")
+    end = header_text.index("#define MODBUS_REGISTER_ADDR_MIN")
+    registers = [m.groups() for m in REGISTER_RE.finditer(header_text[start:end])]
+    start = header_text.index("#define MODBUS_REGISTER_BLOCKS(X)")
+    end = header_text.index("\n\n", start)
+    blocks = [m.groups() for m in BLOCK_RE.finditer(header_text[start:end])]
+    bits = []
+    for table in ("#define MODBUS_DISCRETE_INPUTS(X)", "#define MODBUS_COILS(X)"):
+        start = header_text.index(table)
+        end = header_text.index("\n\n", start)
+        bits.append([m.groups() for m in BIT_RE.finditer(header_text[start:end])])
+    return registers, blocks, bits[0], bits[1]
+
+
+def render_bits(bits):
+    return "".join('    {}: "{}",\n'.format(int(address, 0), name) for name, address, _ in bits)
+
+
+def render(registers, blocks, inputs, coils):
+    reg_lines = ""
+    for name, address, _source, rtype, scale, unit, access, _flag in registers:
+        reg_lines += '    0x{:04X}: ("{}", "{}", {}, "{}", "{}"),\n'.format(
+            int(address, 0), name, rtype, int(scale), unit, access)
+    block_lines = ""
+    for name, base, count, _reader, access in blocks:
+        block_lines += '    "{}": (0x{:04X}, {}, "{}"),\n'.format(
+            name, int(base, 0), int(count, 0), access)
+    return TEMPLATE.format(registers=reg_lines, blocks=block_lines, inputs=render_bits(inputs),
+                           coils=render_bits(coils))
+
+
+def main():
+    header = sys.argv[1] if len(sys.argv) > 1 else DEFAULT_HEADER
+    output = sys.argv[2] if len(sys.argv) > 2 else DEFAULT_OUTPUT
+    with open(header) as f:
+        registers, blocks, inputs, coils = parse(f.read())
+    if not registers:
+        sys.exit("No registers found in " + header)
+    with open(output, "w", newline="\n") as f:
+        f.write(render(registers, blocks, inputs, coils))
+    print("{} registers, {} blocks, {} inputs, {} coils -> {}".format(
+        len(registers), len(blocks), len(inputs), len(coils), output))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,76 @@
+"""Decoder of the compressed history blocks of the SGP30 node (src/history_codec.h).
+
+A block is read from the HIST_BLOCK register window: register 0 is the block length in bytes,
+the next registers hold the block bytes, two per register, first byte in the high half.
+"""
+import struct
+
+HEADER_SIZE = 8
+CRC_SIZE = 2
+CHANNELS = ("CO2", "TVOC", "H2", "ethanol")
+INVALID = 0xFFFF
+
+
+def crc16(data):
+    """Modbus CRC-16, same as CRC16() of the firmware."""
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte
+        for _ in range(8):
+            crc = (crc >> 1) ^ 0xA001 if crc & 1 else crc >> 1
+    return crc
+
+
+def unpack_registers(words):
+    """Return the block bytes from the register words of the block window."""
+    length = words[0]
+    data = b"".join(struct.pack(">H", w) for w in words[1:])
+    if len(data) < length:
+        raise ValueError("block truncated, read more registers")
+    return data[:length]
+
+
+def decode(block):
+    """Decode one block into (seq, time_s, records).
+
+    records is a list of dicts channel: value, None when the channel was not measured. Record i
+    was taken at uptime time_s + i seconds. Raises ValueError when the block is corrupted.
+    """
+    if len(block) < HEADER_SIZE + CRC_SIZE:
+        raise ValueError("block too short")
+    end = len(block) - CRC_SIZE
+    crc = crc16(block[:end])
+    if block[end] != crc >> 8 or block[end + 1] != crc & 0xFF:
+        raise ValueError("block CRC mismatch")
+    seq, time_s, count, mask = struct.unpack_from("<HIBB", block)
+    if count == 0 or mask >> len(CHANNELS):
+        raise ValueError("bad header")
+
+    pos = HEADER_SIZE
+    prev = [0] * len(CHANNELS)
+    records = []
+    for _ in range(count):
+        record = {}
+        for ch, name in enumerate(CHANNELS):
+            if not mask & (1 << ch):
+                record[name] = None
+                continue
+            zz, shift = 0, 0
+            while True:
+                if pos >= end or shift > 14:
+                    raise ValueError("bad varint")
+                byte = block[pos]
+                pos += 1
+                zz |= (byte & 0x7F) << shift
+                shift += 7
+                if not byte & 0x80:
+                    break
+            if zz > 0xFFFF:
+                raise ValueError("bad varint")
+            delta = (zz >> 1) ^ (0xFFFF if zz & 1 else 0)
+            prev[ch] = (prev[ch] + delta) & 0xFFFF
+            record[name] = None if prev[ch] == INVALID else prev[ch]
+        records.append(record)
+    if pos != end:
+        raise ValueError("trailing bytes")
+    return seq, time_s, records
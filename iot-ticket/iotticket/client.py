@@ -22,8 +22,11 @@
 import urllib.request as url  # import request
 import urllib.error as err
 import urllib.parse
+import http.client
 import json  # import json
 import datetime
+import gzip
+import random
 import time
 import ssl
 from pprint import pprint
@@ -33,7 +36,11 @@ from iotticket.models import errorinfo
 from iotticket.models import criteria
 from iotticket.exception import ValidAPIParamException
 from iotticket.validation import validate
+from iotticket.validation import validate_bulk
 import base64
+import copy
+import queue
+import threading
 
 
 # main class
@@ -46,37 +53,104 @@ class Client(object):
     readdataresourceformat = "process/read/{}/"
     quotaallresource = "quota/all/"
     quotadeviceresourceformat = "quota/{}/"
+    # request bodies smaller than this are sent uncompressed
+    gzipminsize = 1024
 
-    def __init__(self, baseUrl, username, password, verify=True):
+    def __init__(self, baseUrl, username, password, verify=True, timeout=30, retries=3,
+                 backoff=0.5, backoffmax=10.0, compress=False):
+        """ timeout is the socket timeout in seconds. A request that times out, loses its
+        connection or gets a 5xx status is retried up to retries times, after a random wait of
+        up to backoff * 2^attempt seconds, at most backoffmax. compress sends gzip request bodies.
+        """
         self.baseUrl = baseUrl
         self.username = username
         self.password = password
+        self.timeout = timeout
+        self.retries = retries
+        self.backoff = backoff
+        self.backoffmax = backoffmax
+        self.compress = compress
         if verify == False:
             self.context = ssl._create_unverified_context()
         else:
             self.context = None
+        # persistent connections, one per host
+        self.connections = {}
 
         usrPass = username+":"+password
         usrPass = usrPass.encode("UTF-8")
         b64auth = base64.b64encode(usrPass)
         authstring = b64auth.decode("UTF-8")
-        self.headers={'content-type': 'application/json','Authorization': 'Basic ' + authstring}
+        self.headers={'content-type': 'application/json','Authorization': 'Basic ' + authstring,
+                      'Accept-Encoding': 'gzip', 'Connection': 'keep-alive'}
 
+    # persistent connection function
+    def get_connection(self, parts):
+        """ Return the open connection to the host of the URL parts, open it if needed."""
+        key = (parts.scheme, parts.netloc)
+        conn = self.connections.get(key)
+        if conn is None:
+            if parts.scheme == "https":
+                conn = http.client.HTTPSConnection(parts.netloc, timeout=self.timeout,
+                                                   context=self.context)
+            else:
+                conn = http.client.HTTPConnection(parts.netloc, timeout=self.timeout)
+            self.connections[key] = conn
+        return conn
+
+    # close connections function
+    def close(self):
+        """ Close the persistent connections."""
+        for conn in self.connections.values():
+            conn.close()
+        self.connections = {}
 
+    # request function
+    def request(self, method, pathUrl, data=None):
+        """ Send a request over the persistent connection and return the response body.
+
+        Timeouts, lost connections and 5xx responses are retried with a jittered exponential
+        backoff. A stale keep-alive connection closed by the server is reopened and the request
+        sent again at once. Raises errorinfo on a HTTP error status, OSError or
+        http.client.HTTPException when the server can not be reached after the retries.
+        """
+        parts = urllib.parse.urlsplit(pathUrl)
+        target = parts.path + ("?" + parts.query if parts.query else "")
+        headers = dict(self.headers)
+        if data is not None and self.compress and len(data) >= self.gzipminsize:
+            data = gzip.compress(data)
+            headers['Content-Encoding'] = 'gzip'
+        attempt = 0
+        while True:
+            conn = self.get_connection(parts)
+            reused = conn.sock is not None
+            try:
+                conn.request(method, target, body=data, headers=headers)
+                response = conn.getresponse()
+                body = response.read()
+            except (OSError, http.client.HTTPException) as e:
+                conn.close()
+                if reused and isinstance(e, (http.client.RemoteDisconnected, BrokenPipeError,
+                                             ConnectionResetError)):
+                    continue
+                if attempt >= self.retries:
+                    raise
+            else:
+                if response.getheader('Content-Encoding') == 'gzip':
+                    body = gzip.decompress(body)
+                if response.will_close:
+                    conn.close()
+                if response.status < 400:
+                    return body
+                if response.status < 500 or attempt >= self.retries:
+                    raise self.get_errorinfo(response.status, body) from None
+            time.sleep(random.uniform(0, min(self.backoffmax, self.backoff * 2 ** attempt)))
+            attempt += 1
 
     # connection function
     def connect(self, pathUrl, clz):
         """ Function to connect to server with different URL path to get different response"""
-        try:
-            req = urllib.request.Request(pathUrl, headers=self.headers)
-
-            with urllib.request.urlopen(req, context=self.context) as response:
-                response = response.read()
-
-        except err.HTTPError as e:
-            raise self.get_errorinfo(e.code, e.read()) from None
-        else:
-            return self.get_response(response, clz)
+        return self.get_response(self.request("GET", pathUrl), clz)
 
     # date time to timestamp
     def dttots(self, dt):
@@ -107,9 +181,12 @@ class Client(object):
     # get error function
     def get_errorinfo(self, statuscode, jsonres):
         """ Return error object"""
-        info = errorinfo()
+        try:
+            info = self.get_response(jsonres, "iotticket.models.errorinfo")
+        except ValueError:
+            info = errorinfo(description=jsonres.decode("utf-8", "replace"), code=statuscode)
         info.set_httpstatus(statuscode)
-        return self.get_response(jsonres, "iotticket.models.errorinfo")
+        return info
 
     # get device function
     def getdevice(self, deviceId):
@@ -149,44 +226,28 @@ class Client(object):
 
     # move device function
     def movedevice(self,deviceid,enterpriseid):
-        try:
-            destination={"enterpriseId":enterpriseid}
-            j=json.dumps(destination)
-            data=j.encode("utf8")
-            pathUrl=self.baseUrl+self.deviceresource+"move/"+deviceid+"/"
-            req = urllib.request.Request(pathUrl, data=data, headers=self.headers)
-            with urllib.request.urlopen(req, context=self.context) as response:
-                response = response.read()
-
-        except err.HTTPError as e:
-            raise self.get_errorinfo(e.code, e.read()) from None
-        else:
-            return self.get_response(response, "iotticket.models.device")
+        destination={"enterpriseId":enterpriseid}
+        j=json.dumps(destination)
+        data=j.encode("utf8")
+        pathUrl=self.baseUrl+self.deviceresource+"move/"+deviceid+"/"
+        response = self.request("POST", pathUrl, data)
+        return self.get_response(response, "iotticket.models.device")
 
     # register device function
     def registerdevice(self, deviceobj):
         """Register new device."""
         if (validate(deviceobj)):
-            try:
-                # parse to json and encode
-                device_dict = deviceobj.__dict__
-                enterprise = device_dict["enterpriseId"]
-                print(device_dict)
-                if enterprise == "":
-                    device_dict.pop("enterpriseId")
-                j = json.dumps(device_dict, sort_keys=True, indent=4)
-                data = j.encode("utf8")
-                pathUrl = self.baseUrl + self.deviceresource
-
-                req = urllib.request.Request(pathUrl,data=data, headers=self.headers)
-
-                with urllib.request.urlopen(req, context=self.context) as response:
-                    response = response.read()
-
-            except err.HTTPError as e:
-                raise self.get_errorinfo(e.code, e.read()) from None
-            else:
-                return self.get_response(response, "iotticket.models.device")
+            # parse to json and encode
+            device_dict = deviceobj.__dict__
+            enterprise = device_dict["enterpriseId"]
+            print(device_dict)
+            if enterprise == "":
+                device_dict.pop("enterpriseId")
+            j = json.dumps(device_dict, sort_keys=True, indent=4)
+            data = j.encode("utf8")
+            pathUrl = self.baseUrl + self.deviceresource
+            response = self.request("POST", pathUrl, data)
+            return self.get_response(response, "iotticket.models.device")
         else:
             return "Device is not valid."
 
@@ -224,26 +285,120 @@ class Client(object):
         pathUrl = self.baseUrl + self.readdataresourceformat.format(deviceId) + param
         return self.connect(pathUrl, "iotticket.models.datanodesvaluelist")
 
+    # paged read data function
+    def iterdata(self, deviceId, criteriaobj, fromdater=None, todater=None, pagesize=10000,
+                 prefetch=True):
+        """Generator reading datanode values page by page, yields (name, path, vts).
+
+        The values of each datanode are yielded in ascending time order, datanode after datanode,
+        from fromdater (default 0) to todater (default now). Both can be a datetime, a string as
+        in readdata or a timestamp in ms. Each page reads up to pagesize values, the next page
+        starts at the last timestamp of the page, the values already yielded at that timestamp
+        are skipped. With prefetch the next page is fetched by a thread, on its own connection,
+        while the current one is consumed, at most one page waits, so memory stays bounded.
+        """
+        fromdate = fromdater if isinstance(fromdater, int) else (self.dttots(fromdater) or 0)
+        todate = todater if isinstance(todater, int) else self.dttots(todater)
+        if not todate:
+            todate = int(time.time() * 1000)
+        pagesize = min(pagesize, 10000)
+        args = (deviceId, list(criteriaobj.criterialist), fromdate, todate, pagesize)
+        if prefetch:
+            pager = copy.copy(self)
+            pager.connections = {}
+            pages = self.prefetch(pager.readpages(*args), pager)
+        else:
+            pages = self.readpages(*args)
+        try:
+            for page in pages:
+                for read in page:
+                    for value in read.get("values", ()):
+                        yield read.get("name"), read.get("path"), vts(value["v"], value["ts"])
+        finally:
+            pages.close()
+
+    def readpages(self, deviceId, names, fromdate, todate, pagesize):
+        """Generator of the pages of iterdata: lists of datanodeReads, one datanode per request."""
+        for name in names:
+            start = fromdate
+            skip = 0  # values at ts == start that were in the previous page
+            while True:
+                param = "?datanodes={}&fromdate={}&todate={}&limit={}&order=ascending".format(
+                    urllib.parse.quote(str(name), safe="/"), start, todate, pagesize)
+                pathUrl = self.baseUrl + self.readdataresourceformat.format(deviceId) + param
+                reads = parsejson(self.request("GET", pathUrl)).get("datanodeReads") or []
+                count = max((len(read.get("values") or ()) for read in reads), default=0)
+                last = max((v["ts"] for read in reads for v in read.get("values") or ()),
+                           default=start)
+                for read in reads:
+                    values = read.get("values") or []
+                    n = 0
+                    while n < len(values) and n < skip and values[n]["ts"] == start:
+                        n += 1
+                    read["values"] = values[n:]
+                yield reads
+                if count < pagesize:
+                    break
+                if last == start:
+                    # a full page at one timestamp, the rest of it can not be paged
+                    start, skip = last + 1, 0
+                else:
+                    skip = sum(1 for read in reads for v in read["values"] if v["ts"] == last)
+                    start = last
+
+    def prefetch(self, pages, pager):
+        """Run the page generator of pager, a copy of the client with its own connections, in a
+        thread. Returns a generator of the pages, exceptions of the thread are raised in it.
+        """
+        slot = queue.Queue(maxsize=1)
+        stop = threading.Event()
+        done = object()
+
+        def run():
+            try:
+                for page in pages:
+                    while not stop.is_set():
+                        try:
+                            slot.put(page, timeout=0.1)
+                            break
+                        except queue.Full:
+                            pass
+                    if stop.is_set():
+                        return
+                item = done
+            except Exception as e:
+                item = e
+            while not stop.is_set():
+                try:
+                    slot.put(item, timeout=0.1)
+                    return
+                except queue.Full:
+                    pass
+
+        thread = threading.Thread(target=run, daemon=True)
+        thread.start()
+        try:
+            while True:
+                item = slot.get()
+                if item is done:
+                    return
+                if isinstance(item, Exception):
+                    raise item
+                yield item
+        finally:
+            stop.set()
+            thread.join()
+            pager.close()
+
     # write data node function
     def writedata(self, deviceId, *datanodevalueobj):
         """Function to write data to server."""
-        dv = []
-        for dvo in datanodevalueobj:
-            if (validate(dvo)):
-                dv.append(dvo.__dict__)
+        dv = [dvo.__dict__ for dvo in validate_bulk(datanodevalueobj)]
         if len(dv) > 0:
-            try:
-                j = json.dumps(dv)
-                data = j.encode("utf8")
-                pathUrl = self.baseUrl + self.writedataresourceformat.format(deviceId)
-
-                req = urllib.request.Request(pathUrl, data=data, headers=self.headers)
-
-                with urllib.request.urlopen(req, context=self.context) as response:
-                    response = response.read()
-            except err.HTTPError as e:
-                raise self.get_errorinfo(e.code, e.read()) from None
-            else:
-                return self.get_response(response, "iotticket.models.writeresults")
+            j = json.dumps(dv)
+            data = j.encode("utf8")
+            pathUrl = self.baseUrl + self.writedataresourceformat.format(deviceId)
+            response = self.request("POST", pathUrl, data)
+            return self.get_response(response, "iotticket.models.writeresults")
         else:
             return "All datanodes are not valid"
\ No newline at end of file
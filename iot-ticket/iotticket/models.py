@@ -366,10 +366,10 @@ class datanodesvalue(object):
 	def get_path(self):
 		return self.path
 	def set_values(self, *new_value):
+		if self.values is None:
+			self.values = []
 		for a in new_value:
-			j_data = {"v":a.v,"ts":a.ts}
-			self.j_list.append(j_data)
-			self.values = self.j_list
+			self.values.append({"v":a.v,"ts":a.ts})
 	def get_values(self):
 		return self.valueslist	
 	def set_value(self, v):
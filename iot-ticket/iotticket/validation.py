@@ -19,42 +19,74 @@
  # DEALINGS IN THE SOFTWARE.
  
 import re
-def validate(obj):
-	""" Validate function is used to check the max length, nullable and datatype of an object attribute."""
-	isValid = True
-	for n in obj.crit:
+
+# dataType of a datanode: type of its value, for the "multi" criterion
+MULTI_TYPES = {"string": str, "String": str, "double": float, "Double": float, "boolean": bool,
+	"Boolean": bool, "long": int, "Long": int}
+
+# class: (crit, check), the check of a model class is compiled on its first validation
+_validators = {}
+
+def _compile(crit):
+	""" Compile the criteria of a model class into one check function, True when obj is valid.
+
+	Every criterion becomes an inline test on a local, regexes are compiled once and bound as
+	default arguments, so a validation costs one call and no lookups in the criteria.
+	"""
+	lines = []
+	env = {"MULTI_TYPES": MULTI_TYPES}
+	for n in crit:
 		for key in n:
 			critlist = n[key]
+			if key.isidentifier():
+				lines.append("value = obj." + key)
+			else:
+				lines.append("value = getattr(obj, %r)" % key)
 			for critlistkey in critlist:
+				limit = critlist[critlistkey]
 				if critlistkey == "max_length":
-					if getattr(obj,key) != None:
-						if len(getattr(obj,key)) > critlist[critlistkey]:
-							isValid = False
-				if critlistkey == "nullable":
-					if critlist[critlistkey] is False:
-						if(getattr(obj,key) == "" or getattr(obj,key) == None):
-							isValid = False
-				if critlistkey == "regex":
-					if( not re.match(critlist[critlistkey], getattr(obj,key), flags = 0)):	
-						isValid = False
-				if critlistkey == "dataType":
-					if critlist[critlistkey] == "multi":
-						if obj.dataType == "string" or obj.dataType == "String":
-							if not isinstance(getattr(obj,key), str):
-								isValid = False
-						elif obj.dataType == "Double" or obj.dataType == "double":
-							if not isinstance(getattr(obj,key), float):
-								isValid = False
-						elif obj.dataType == "Boolean" or obj.dataType == "boolean":
-							if not isinstance(getattr(obj,key), bool):
-								isValid = False
-						elif obj.dataType == "Long" or obj.dataType == "long":
-							if not isinstance(getattr(obj,key), int):
-								isValid = False
-						else:
-							isValid = False
-					else:		
-						if not isinstance(getattr(obj,key), critlist[critlistkey]):
-							isValid = False
-	return isValid						
-				
\ No newline at end of file
+					lines.append("if value is not None and len(value) > %d: return False" % limit)
+				elif critlistkey == "nullable" and limit is False:
+					lines.append("if value == '' or value is None: return False")
+				elif critlistkey == "regex":
+					name = "match%d" % len(env)
+					env[name] = re.compile(limit).match
+					lines.append("if not %s(value): return False" % name)
+				elif critlistkey == "dataType" and limit == "multi":
+					lines.append("t = MULTI_TYPES.get(obj.dataType)")
+					lines.append("if t is None or not isinstance(value, t): return False")
+				elif critlistkey == "dataType":
+					name = "type%d" % len(env)
+					env[name] = limit
+					lines.append("if not isinstance(value, %s): return False" % name)
+	lines.append("return True")
+	source = "def check(obj):\n" + "".join("\t" + line + "\n" for line in lines)
+	exec(source, env)
+	return env["check"]
+
+def _validator(obj):
+	""" Return the check of the class of obj, compile it when its crit was not seen yet."""
+	clz = type(obj)
+	crit = obj.crit
+	cached = _validators.get(clz)
+	if cached is None or cached[0] is not crit:
+		cached = (crit, _compile(crit))
+		_validators[clz] = cached
+	return cached[1]
+
+def validate(obj):
+	""" Validate function is used to check the max length, nullable and datatype of an object attribute."""
+	return _validator(obj)(obj)
+
+def validate_bulk(objs):
+	""" Return the valid objects of objs in their order, the check is looked up once per class."""
+	valid = []
+	check = None
+	clz = None
+	for obj in objs:
+		if type(obj) is not clz:
+			clz = type(obj)
+			check = _validator(obj)
+		if check(obj):
+			valid.append(obj)
+	return valid
@@ -0,0 +1,136 @@
+"""End-to-end gateway load test: simulated slaves -> gateway -> uploader -> stand-in server.
+
+Runs modbus_sim buses on ptys, the asyncio gateway over them, the batched uploader in its worker
+thread and the stand-in server, all in one process, and reports the samples per second polled
+from the slaves and written to the server. The samples count as written when the server has
+stored them, after the last batch has been flushed. The spool left over is drained for at most
+--drain-timeout s, what is still spooled then is reported, and the exit status is 1 when samples
+were neither written nor spooled.
+
+Usage: python loadtest.py [--buses 2] [--slaves 10] [--duration 10] [--batch 500]
+                          [--latency 0.05] [--error-rate 0.01] [--drain-timeout 30]
+"""
+import argparse
+import asyncio
+import os
+import sys
+import tempfile
+import threading
+import time
+
+import aggregator
+import gateway
+import modbus_map
+import modbus_sim
+import standin_server
+import uploader
+from iotticket.client import Client
+
+UNITS = {name: unit for name, _, _, unit, _ in modbus_map.REGISTERS.values()}
+
+
+def datanode(bus, slave, name, value):
+    """Datanode of a register of a slave, the path tells the bus and the slave apart."""
+    return uploader.Datanode(name, "/bus{}/slave{}".format(bus, slave), UNITS.get(name, ""),
+                             "double" if isinstance(value, float) else "long")
+
+
+def spooled_samples(up):
+    """Samples left in the spool of up, one per complete line after the read position."""
+    if not up.spooled():
+        return 0
+    with open(up.spool, "rb") as f:
+        f.seek(up.read_pos())
+        return f.read().count(b"\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--buses", type=int, default=2, help="simulated serial ports")
+    parser.add_argument("--slaves", type=int, default=10, help="slaves per bus")
+    parser.add_argument("--period", type=float, default=0.0, help="poll period in s, 0 = flat out")
+    parser.add_argument("--baudrate", type=int, default=9600, help="timing of the gaps")
+    parser.add_argument("--slave-latency", type=float, default=0.0, help="response time in s")
+    parser.add_argument("--duration", type=float, default=10.0, help="polling time in s")
+    parser.add_argument("--batch", type=int, default=500, help="samples per upload")
+    parser.add_argument("--latency", type=float, default=0.0, help="server delay in s")
+    parser.add_argument("--error-rate", type=float, default=0.0, help="share of 503 replies")
+    parser.add_argument("--drop-rate", type=float, default=0.0, help="share of dropped requests")
+    parser.add_argument("--window", type=float, default=0.0, help="aggregation window in s")
+    parser.add_argument("--compress", action="store_true", help="gzip the request bodies")
+    parser.add_argument("--drain-timeout", type=float, default=30.0,
+                        help="time limit in s of the final drain of the spool")
+    args = parser.parse_args()
+
+    server = standin_server.StandInServer(latency=args.latency, error_rate=args.error_rate,
+                                          drop_rate=args.drop_rate)
+    threading.Thread(target=server.serve_forever, daemon=True).start()
+    sims = [modbus_sim.SimBus([modbus_sim.SimSlave(a, args.slave_latency)
+                               for a in range(1, args.slaves + 1)]).start()
+            for _ in range(args.buses)]
+    bus_index = {sim.path: n for n, sim in enumerate(sims)}
+
+    spool = os.path.join(tempfile.mkdtemp(), "spool.jsonl")
+    client = Client(server.url, "load", "test", retries=5, backoff=0.05, compress=args.compress)
+    up = uploader.Uploader(client, "loadtest", batch_size=args.batch, max_age=1.0, spool=spool,
+                           retry=1.0, log=lambda *a: None)
+    worker = uploader.Worker(up, interval=0.2)
+    worker.start()
+    sink = aggregator.Aggregator(worker, args.window) if args.window else worker
+    polled = [0]
+
+    def on_sample(sample):
+        ts = int(sample.time * 1000)
+        for name, value in sample.values.items():
+            sink.add(datanode(bus_index[sample.port], sample.slave, name, value), value, ts)
+            polled[0] += 1
+
+    gw = gateway.Gateway([{"port": sim.path, "slaves": list(range(1, args.slaves + 1)),
+                           "period": args.period, "baudrate": args.baudrate} for sim in sims],
+                         on_sample)
+
+    async def run():
+        try:
+            await asyncio.wait_for(gw.run(), args.duration)
+        except asyncio.TimeoutError:
+            pass
+
+    start = time.monotonic()
+    asyncio.run(run())
+    polled_time = time.monotonic() - start
+    if args.window:
+        sink.flush()
+    worker.stop()
+    deadline = time.monotonic() + args.drain_timeout
+    while up.spooled() and time.monotonic() < deadline:
+        up.drain()
+        if not up.online:
+            time.sleep(max(0.0, min(up.retry_at, deadline) - time.monotonic()))
+    total_time = time.monotonic() - start
+    spooled = spooled_samples(up)
+    for sim in sims:
+        sim.stop()
+    server.shutdown()
+
+    stats = server.store.stats
+    timeouts = sum(s.get("timeouts", 0) for s in gw.stats().values())
+    print("buses {} x slaves {}, {:.1f} s".format(args.buses, args.slaves, polled_time))
+    print("polled   {:8d} samples {:10.1f} samples/s, {} timeouts".format(
+        polled[0], polled[0] / polled_time, timeouts))
+    print("written  {:8d} samples {:10.1f} samples/s end to end".format(
+        stats["samples"], stats["samples"] / total_time))
+    print("requests {:8d}, {} writes, {} injected errors, {} dropped".format(
+        stats["requests"], stats["writes"], stats["errors"], stats["dropped"]))
+    if spooled:
+        print("spooled  {:8d} samples left after the {:.0f} s drain".format(
+            spooled, args.drain_timeout))
+    if args.window:
+        print("window   {:8.1f} s, {} raw samples passed through".format(args.window, sink.raw))
+    elif stats["samples"] + spooled != polled[0]:
+        print("LOST     {:8d} samples".format(polled[0] - stats["samples"] - spooled))
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,113 @@
+"""Modbus register map of the SGP30 node.
+
+Generated by gen_modbus_map.py from src/modbus_map.h, do not edit.
+"""
+
+# address: (name, type, scale, unit, access)
+REGISTERS = {
+    0x0001: ("CO2", "U16", 1, "ppm", "R"),
+    0x0002: ("TVOC", "U16", 1, "ppb", "R"),
+    0x0003: ("BASE_CO2", "U16", 1, "ppm", "R"),
+    0x0004: ("BASE_TVOC", "U16", 1, "ppb", "R"),
+    0x0005: ("FEATURE_SET", "U16", 1, "", "R"),
+    0x0006: ("RAW_H2", "U16", 1, "", "R"),
+    0x0007: ("RAW_ETHANOL", "U16", 1, "", "R"),
+    0x0008: ("SERIAL_ID", "U16", 1, "", "R"),
+    0x0009: ("SERIAL_ID_1", "U16", 1, "", "R"),
+    0x000A: ("SERIAL_ID_2", "U16", 1, "", "R"),
+    0x0010: ("RAW_MODE", "U16", 1, "", "RW"),
+    0x0011: ("RAW_WIN_SEQ", "U16", 1, "", "R"),
+    0x0012: ("RAW_WIN_COUNT", "U16", 1, "", "R"),
+    0x0013: ("RAW_SERIES_SEQ", "U16", 1, "", "R"),
+    0x0014: ("RAW_H2_MIN", "U16", 1, "", "R"),
+    0x0015: ("RAW_H2_MAX", "U16", 1, "", "R"),
+    0x0016: ("RAW_H2_MEAN", "U16", 1, "", "R"),
+    0x0017: ("RAW_ETH_MIN", "U16", 1, "", "R"),
+    0x0018: ("RAW_ETH_MAX", "U16", 1, "", "R"),
+    0x0019: ("RAW_ETH_MEAN", "U16", 1, "", "R"),
+    0x0020: ("HIST_HEAD", "U16", 1, "", "R"),
+    0x0021: ("HIST_COUNT", "U16", 1, "", "R"),
+    0x0022: ("HIST_CURSOR", "U16", 1, "", "RW"),
+    0x0023: ("HIST_TIME_HI", "U16", 1, "s", "R"),
+    0x0024: ("HIST_TIME_LO", "U16", 1, "s", "R"),
+    0x0025: ("HIST_BLK_HEAD", "U16", 1, "", "R"),
+    0x0026: ("HIST_BLK_COUNT", "U16", 1, "", "R"),
+    0x0027: ("HIST_BLK_CUR", "U16", 1, "", "RW"),
+    0x0030: ("TEMPERATURE", "S16", 10, "C", "RW"),
+    0x0031: ("REL_HUMIDITY", "U16", 10, "%", "RW"),
+    0x0032: ("ABS_HUMIDITY", "U16", 256, "g/m3", "R"),
+    0x0033: ("DHT_TEMP", "S16", 10, "C", "R"),
+    0x0034: ("DHT_RH", "U16", 10, "%", "R"),
+    0x0035: ("DHT_ERRORS", "U16", 1, "", "R"),
+    0x0036: ("DHT_STATUS", "U16", 1, "", "R"),
+    0x0037: ("CHG_STATUS", "U16", 1, "", "R"),
+    0x0038: ("CHG_SEQ", "U16", 1, "", "R"),
+    0x0039: ("CHG_ACK", "U16", 1, "", "RW"),
+    0x003A: ("CHG_DB_CO2", "U16", 1, "ppm", "RW"),
+    0x003B: ("CHG_DB_TVOC", "U16", 1, "ppb", "RW"),
+    0x003C: ("ALM_CO2_HIGH", "U16", 1, "ppm", "RW"),
+    0x003D: ("ALM_CO2_HYST", "U16", 1, "ppm", "RW"),
+    0x003E: ("ALM_TVOC_HIGH", "U16", 1, "ppb", "RW"),
+    0x003F: ("ALM_TVOC_HYST", "U16", 1, "ppb", "RW"),
+    0x0040: ("SUP_STATE", "U16", 1, "", "R"),
+    0x0041: ("SUP_FAULTS", "U16", 1, "", "R"),
+    0x0042: ("SUP_RESETS", "U16", 1, "", "R"),
+    0x0043: ("SUP_RECOVERIES", "U16", 1, "", "R"),
+    0x0044: ("SUP_BACKOFF", "U16", 1, "s", "R"),
+    0x0045: ("SUP_RESTORED", "U16", 1, "", "R"),
+}
+
+# name: (base, count, access)
+BLOCKS = {
+    "IRQ_STATS": (0x0100, 160, "R"),
+    "RAW_SERIES": (0x0200, 64, "R"),
+    "HISTORY": (0x0400, 124, "R"),
+    "HIST_BLOCK": (0x0480, 390, "R"),
+    "REMOTE_STAT": (0x0700, 128, "R"),
+    "REMOTE": (0x0780, 128, "R"),
+}
+
+# address: name, FC 0x02
+DISCRETE_INPUTS = {
+    0: "ALM_CO2",
+    1: "ALM_TVOC",
+    2: "DATA_CHANGED",
+    3: "MEAS_VALID",
+    4: "SGP30_ONLINE",
+    5: "DHT22_VALID",
+    6: "RELAY_OUT",
+}
+
+# address: name, FC 0x01 and 0x05
+COILS = {
+    0: "RELAY",
+    1: "RELAY_AUTO",
+    2: "LED_ALARM",
+}
+
+ADDRESS = {name: address for address, (name, *_) in REGISTERS.items()}
+
+
+def decode_register(address, raw):
+    """Return (name, physical value) of one register, raw is the unsigned 16-bit value."""
+    name, rtype, scale, _unit, _access = REGISTERS[address]
+    if rtype == "S16" and raw & 0x8000:
+        raw -= 0x10000
+    return name, raw / scale if scale != 1 else raw
+
+
+def decode(start, words):
+    """Decode a block read starting from register address start into a dict name: value.
+
+    Registers that are not in REGISTERS (ex. register blocks) are returned as raw words under
+    their address.
+    """
+    result = {}
+    for offset, raw in enumerate(words):
+        address = start + offset
+        if address in REGISTERS:
+            name, value = decode_register(address, raw)
+            result[name] = value
+        else:
+            result[address] = raw
+    return result
@@ -0,0 +1,208 @@
+"""Modbus RTU master side of the SGP30 node protocol (src/modbus_rtu.h).
+
+Frames are built and checked here, the transport only moves bytes. The reply length is derived
+from the bytes received so far (reply_remaining), so a reader asks for exactly the missing bytes
+and never waits out the serial timeout on a complete reply.
+
+The nodes send the CRC high byte first (CRC_NODE), standard Modbus RTU slaves low byte first
+(CRC_STANDARD). Requests are built in the node order unless told otherwise, and a reply is
+checked in the order of its request, as a slave answers in its own order.
+"""
+import struct
+
+import serial
+
+READ_COILS = 0x01
+READ_DISCRETE_INPUTS = 0x02
+READ_HOLDING_REGISTERS = 0x03
+READ_INPUT_REGISTERS = 0x04
+WRITE_SINGLE_COIL = 0x05
+WRITE_SINGLE_REGISTER = 0x06
+REPORT_SLAVE_ID = 0x11
+READ_DEVICE_ID = 0x2B
+
+MEI_READ_DEVICE_ID = 0x0E
+COIL_ON = 0xFF00
+COIL_OFF = 0x0000
+EXCEPTION_LENGTH = 5  # address, function code | 0x80, exception code, CRC
+CRC_NODE = ">H"  # CRC byte orders for struct
+CRC_STANDARD = "<H"
+
+# MODBUS_RTU_ERR of the firmware
+EXCEPTIONS = {
+    1: "BAD_CRC",
+    2: "BAD_SLAVE_ADDR",
+    3: "BAD_FUNCTION_CODE",
+    4: "BAD_REGISTER_ADDR",
+    5: "BAD_QUANTITY",
+    6: "DATA_UNAVAILABLE",
+}
+
+
+class ModbusError(Exception):
+    """Base class of the request errors."""
+
+
+class ModbusTimeout(ModbusError):
+    """No reply or a truncated reply."""
+
+
+class ModbusFrameError(ModbusError):
+    """Bad CRC, or a reply that does not match the request.
+
+    address is the address byte of the reply, None when it has none. A reply of another slave
+    is mostly the late reply to an earlier request, address tells whose.
+    """
+
+    def __init__(self, message, address=None):
+        self.address = address
+        super().__init__(message)
+
+
+class ModbusCrcError(ModbusFrameError):
+    """Reply with a bad CRC."""
+
+
+class ModbusException(ModbusError):
+    """Exception reply of the slave."""
+
+    def __init__(self, slave, function, code):
+        self.slave = slave
+        self.function = function
+        self.code = code
+        self.name = EXCEPTIONS.get(code, "UNKNOWN")
+        super().__init__("slave {} FC 0x{:02X}: exception {} {}".format(
+            slave, function, code, self.name))
+
+
+def crc16(data):
+    """Modbus CRC-16, same as CRC16() of the firmware."""
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte
+        for _ in range(8):
+            crc = (crc >> 1) ^ 0xA001 if crc & 1 else crc >> 1
+    return crc
+
+
+def with_crc(pdu, order=CRC_NODE):
+    """Append the CRC, high byte first by default."""
+    return bytes(pdu) + struct.pack(order, crc16(pdu))
+
+
+def crc_orders(frame):
+    """Return the CRC byte orders in which frame is valid, both when the CRC bytes are equal."""
+    if len(frame) < 4:
+        return []
+    crc = crc16(frame[:-2])
+    return [order for order in (CRC_NODE, CRC_STANDARD)
+            if struct.unpack(order, frame[-2:])[0] == crc]
+
+
+def request(slave, function, address, value, order=CRC_NODE):
+    """Build a FC 0x01...0x06 request, value is the quantity or the value to write."""
+    return with_crc(struct.pack(">BBHH", slave, function, address, value), order)
+
+
+def report_slave_id_request(slave, order=CRC_NODE):
+    return with_crc(bytes([slave, REPORT_SLAVE_ID]), order)
+
+
+def read_device_id_request(slave, code=1, object_id=0, order=CRC_NODE):
+    return with_crc(bytes([slave, READ_DEVICE_ID, MEI_READ_DEVICE_ID, code, object_id]), order)
+
+
+def reply_remaining(function, buf):
+    """Return the number of bytes still missing from the reply buf to a request of function."""
+    if len(buf) < 2:
+        return 2 - len(buf)
+    if buf[1] & 0x80:
+        return EXCEPTION_LENGTH - len(buf)
+    if function in (WRITE_SINGLE_COIL, WRITE_SINGLE_REGISTER):
+        return 8 - len(buf)
+    if function == READ_DEVICE_ID:
+        # MEI type, code, conformity, more follows, next object, count, then id, length, value
+        if len(buf) < 8:
+            return 8 - len(buf)
+        pos = 8
+        for _ in range(buf[7]):
+            if len(buf) < pos + 2:
+                return pos + 2 - len(buf)
+            pos += 2 + buf[pos + 1]
+        return pos + 2 - len(buf)
+    # byte count replies: FC 0x01...0x04, 0x11
+    if len(buf) < 3:
+        return 3 - len(buf)
+    return 3 + buf[2] + 2 - len(buf)
+
+
+def check_reply(req, reply):
+    """Check a complete reply against its request, return the PDU data after the function code.
+
+    Raises ModbusFrameError or ModbusException.
+    """
+    if not set(crc_orders(reply)) & set(crc_orders(req)):
+        raise ModbusCrcError("bad CRC", reply[0] if reply else None)
+    if reply[0] != req[0] or (reply[1] & 0x7F) != req[1]:
+        raise ModbusFrameError("reply of slave {} does not match the request".format(reply[0]),
+                               reply[0])
+    if reply[1] & 0x80:
+        raise ModbusException(reply[0], req[1], reply[2])
+    return reply[2:-2]
+
+
+def words(data):
+    """Register values of a FC 0x03/0x04 reply data: byte count, values."""
+    return list(struct.unpack(">{}H".format(data[0] // 2), data[1:1 + data[0]]))
+
+
+def bits(data, count):
+    """Bit values of a FC 0x01/0x02 reply data: byte count, packed bits."""
+    return [(data[1 + n // 8] >> (n % 8)) & 1 for n in range(count)]
+
+
+class Poller:
+    """Blocking master on one serial port, the port is kept open between requests.
+
+    timeout bounds the wait for the first reply byte and the gap between bytes, a complete reply
+    returns as soon as its last byte arrives.
+    """
+
+    def __init__(self, port, baudrate=9600, timeout=0.2, port_factory=serial.serial_for_url):
+        self.port = port_factory(port, baudrate=baudrate, timeout=timeout)
+
+    def close(self):
+        self.port.close()
+
+    def transact(self, req):
+        """Send a request and return the PDU data of its reply."""
+        self.port.reset_input_buffer()
+        self.port.write(req)
+        reply = b""
+        while True:
+            missing = reply_remaining(req[1], reply)
+            if missing <= 0:
+                break
+            chunk = self.port.read(missing)
+            if not chunk:
+                raise ModbusTimeout("slave {} FC 0x{:02X}: {} of {} bytes".format(
+                    req[0], req[1], len(reply), len(reply) + missing))
+            reply += chunk
+        return check_reply(req, reply)
+
+    def read_registers(self, slave, address, count, function=READ_INPUT_REGISTERS):
+        return words(self.transact(request(slave, function, address, count)))
+
+    def write_register(self, slave, address, value):
+        self.transact(request(slave, WRITE_SINGLE_REGISTER, address, value))
+
+    def read_bits(self, slave, address, count, function=READ_DISCRETE_INPUTS):
+        return bits(self.transact(request(slave, function, address, count)), count)
+
+    def write_coil(self, slave, address, on):
+        self.transact(request(slave, WRITE_SINGLE_COIL, address, COIL_ON if on else COIL_OFF))
+
+    def report_slave_id(self, slave):
+        """Return the FC 0x11 data after the byte count, see src/device_id.h."""
+        data = self.transact(report_slave_id_request(slave))
+        return data[1:1 + data[0]]
@@ -0,0 +1,203 @@
+"""Simulated SGP30 nodes on a pseudo-terminal, for running the gateway without hardware.
+
+The slaves answer like the firmware (src/modbus_rtu.c): registers of modbus_map, discrete
+inputs, coils, FC 0x11 and the basic objects of FC 0x2B, exception replies with the
+MODBUS_RTU_ERR codes. CO2eq and TVOC follow a random walk. A slave can be made slow with a
+latency, silent with dead, or noisy with corrupt, the share of replies with a flipped bit. A
+slave with crc CRC_STANDARD stands for a third-party slave: it sends the CRC low byte first and,
+as the standard asks, ignores the requests with a bad CRC, the node order included.
+
+Usage: python modbus_sim.py [--slaves 1-10] [--dead 3,7] [--latency 0.01] [--corrupt 0.01]
+                            [--standard 20-22]
+The path of the pty to open in the gateway is printed.
+"""
+import argparse
+import os
+import random
+import select
+import struct
+import threading
+import time
+import tty
+
+import modbus_map
+import modbus_rtu
+from modbus_rtu import with_crc
+
+GAP = 0.004  # end of a frame of an unknown function code
+
+
+def request_length(function):
+    """Length of a request of function, None when not supported by the firmware."""
+    if function in (0x01, 0x02, 0x03, 0x04, 0x05, 0x06):
+        return 8
+    if function == modbus_rtu.REPORT_SLAVE_ID:
+        return 4
+    if function == modbus_rtu.READ_DEVICE_ID:
+        return 7
+    return None
+
+
+class SimSlave:
+    """One simulated node, handle() returns the reply to a request frame or None."""
+
+    def __init__(self, address, latency=0.0, dead=False, corrupt=0.0, crc=modbus_rtu.CRC_NODE):
+        self.address = address
+        self.crc = crc
+        self.latency = latency
+        self.dead = dead
+        self.corrupt = corrupt
+        self.registers = {a: 0 for a in modbus_map.REGISTERS}
+        self.registers[modbus_map.ADDRESS["CO2"]] = 400
+        self.inputs = {a: 0 for a in modbus_map.DISCRETE_INPUTS}
+        self.coils = {a: 0 for a in modbus_map.COILS}
+        self.requests = 0
+
+    def step(self):
+        """Random walk of CO2eq and TVOC, once per read."""
+        co2, tvoc = modbus_map.ADDRESS["CO2"], modbus_map.ADDRESS["TVOC"]
+        self.registers[co2] = min(max(self.registers[co2] + random.randint(-5, 5), 400), 60000)
+        self.registers[tvoc] = min(max(self.registers[tvoc] + random.randint(-2, 2), 0), 60000)
+
+    def exception(self, function, code):
+        return with_crc(bytes([self.address, function | 0x80, code]), self.crc)
+
+    def handle(self, frame):
+        self.requests += 1
+        if self.crc not in modbus_rtu.crc_orders(frame):
+            if self.crc == modbus_rtu.CRC_STANDARD:
+                return None
+            return self.exception(frame[1] if len(frame) > 1 else 0, 1)  # BAD_CRC
+        function = frame[1]
+        if request_length(function) is None:
+            return self.exception(function, 3)  # BAD_FUNCTION_CODE
+        if len(frame) != request_length(function):
+            return self.exception(function, 5)  # BAD_QUANTITY
+        if function == modbus_rtu.REPORT_SLAVE_ID:
+            data = bytes([0x30, 0xFF, 1, 4, 0]) + bytes(12) + b"VAMK"
+            return with_crc(bytes([self.address, function, len(data)]) + data, self.crc)
+        if function == modbus_rtu.READ_DEVICE_ID:
+            objects = (b"VAMK", b"SGP30-MODBUS", b"V1.4.0")
+            data = bytes([0x0E, frame[3], 0x83, 0, 0, len(objects)])
+            for n, value in enumerate(objects):
+                data += bytes([n, len(value)]) + value
+            return with_crc(bytes([self.address, function]) + data, self.crc)
+        address, value = struct.unpack(">HH", frame[2:6])
+        if function in (modbus_rtu.READ_HOLDING_REGISTERS, modbus_rtu.READ_INPUT_REGISTERS):
+            if not 1 <= value <= 125:
+                return self.exception(function, 5)
+            if any(a not in self.registers for a in range(address, address + value)):
+                return self.exception(function, 4)  # BAD_REGISTER_ADDR
+            self.step()
+            data = b"".join(struct.pack(">H", self.registers[a])
+                            for a in range(address, address + value))
+            return with_crc(bytes([self.address, function, len(data)]) + data, self.crc)
+        if function in (modbus_rtu.READ_COILS, modbus_rtu.READ_DISCRETE_INPUTS):
+            table = self.coils if function == modbus_rtu.READ_COILS else self.inputs
+            if not 1 <= value <= 2000:
+                return self.exception(function, 5)
+            if any(a not in table for a in range(address, address + value)):
+                return self.exception(function, 4)
+            data = bytearray((value + 7) // 8)
+            for n in range(value):
+                data[n // 8] |= table[address + n] << (n % 8)
+            return with_crc(bytes([self.address, function, len(data)]) + data, self.crc)
+        if function == modbus_rtu.WRITE_SINGLE_COIL:
+            if address not in self.coils:
+                return self.exception(function, 4)
+            if value not in (modbus_rtu.COIL_ON, modbus_rtu.COIL_OFF):
+                return self.exception(function, 5)
+            self.coils[address] = int(value == modbus_rtu.COIL_ON)
+            return bytes(frame)
+        # WRITE_SINGLE_REGISTER
+        if address not in self.registers or modbus_map.REGISTERS[address][4] != "RW":
+            return self.exception(function, 4)
+        self.registers[address] = value
+        return bytes(frame)
+
+
+class SimBus:
+    """Slaves on the master end of a pty, the gateway opens the slave end (path).
+
+    The requests are split by their length, as the firmware splits them by the idle line.
+    """
+
+    def __init__(self, slaves):
+        self.slaves = {s.address: s for s in slaves}
+        self.fd, slave_fd = os.openpty()
+        tty.setraw(slave_fd)
+        self.path = os.ttyname(slave_fd)
+        self._slave_fd = slave_fd  # kept open, a pty without an open slave end reads EIO
+        self._stop = False
+        self._thread = threading.Thread(target=self._run, daemon=True)
+
+    def start(self):
+        self._thread.start()
+        return self
+
+    def stop(self):
+        self._stop = True
+        self._thread.join()
+        os.close(self.fd)
+        os.close(self._slave_fd)
+
+    def _run(self):
+        buf = b""
+        while not self._stop:
+            ready, _, _ = select.select([self.fd], [], [], GAP if buf else 0.1)
+            if ready:
+                buf += os.read(self.fd, 256)
+            elif buf:
+                buf = b""  # silence after an unknown frame, resync
+            while len(buf) >= 2:
+                length = request_length(buf[1])
+                if length is None or len(buf) < length:
+                    break
+                frame, buf = buf[:length], buf[length:]
+                self._answer(frame)
+
+    def _answer(self, frame):
+        slave = self.slaves.get(frame[0])
+        if slave is None or slave.dead:
+            return
+        reply = slave.handle(frame)
+        if reply is None:
+            return
+        if random.random() < slave.corrupt:
+            n = random.randrange(2, len(reply))  # keep address and function, the CRC catches it
+            reply = reply[:n] + bytes([reply[n] ^ 1 << random.randrange(8)]) + reply[n + 1:]
+        if slave.latency:
+            time.sleep(slave.latency)
+        os.write(self.fd, reply)
+
+
+def parse_addresses(text):
+    """'1-3,7' -> [1, 2, 3, 7]"""
+    result = []
+    for part in filter(None, text.split(",")):
+        first, _, last = part.partition("-")
+        result.extend(range(int(first), int(last or first) + 1))
+    return result
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--slaves", default="5", help="slave addresses, e.g. 1-10,20")
+    parser.add_argument("--dead", default="", help="addresses that never answer")
+    parser.add_argument("--latency", type=float, default=0.0, help="response time in s")
+    parser.add_argument("--corrupt", type=float, default=0.0, help="share of corrupted replies")
+    parser.add_argument("--standard", default="",
+                        help="addresses that send the CRC low byte first, as standard Modbus")
+    args = parser.parse_args()
+    dead = set(parse_addresses(args.dead))
+    standard = set(parse_addresses(args.standard))
+    bus = SimBus([SimSlave(a, args.latency, a in dead, args.corrupt,
+                           modbus_rtu.CRC_STANDARD if a in standard else modbus_rtu.CRC_NODE)
+                  for a in parse_addresses(args.slaves)])
+    bus.start()
+    print(bus.path, flush=True)
+    try:
+        while True:
+            time.sleep(1)
+    except KeyboardInterrupt:
+        bus.stop()
@@ -3,12 +3,11 @@ import json
 import sys
 import time
 import random
-import serial
 import time
-from iotticket.models import device
-from iotticket.models import criteria
-from iotticket.models import deviceattribute
-from iotticket.models import datanodesvalue
+import modbus_map
+import modbus_rtu
+import aggregator
+import uploader
 from iotticket.client import Client
 
 #main
@@ -19,58 +18,42 @@ username = data["username"]
 password = data["password"]
 deviceId = data["deviceId"]
 baseurl = data["baseurl"]
+port = data.get("port", "COM6")
+slave = data.get("slave", 5)
 
 c = Client(baseurl, username, password)
 
+CO2EQ = uploader.Datanode("CO2eq", "/co2eq", "ppm", "long")
+TVOC = uploader.Datanode("TVOC", "/tvoc", "ppb", "long")
+
+# 100 cycles of CO2eq and TVOC per request, samples of an outage go to the spool file
+up = uploader.Uploader(c, deviceId, batch_size=data.get("batch_size", 200),
+                       max_age=data.get("max_age", 600), spool=data.get("spool", "spool.jsonl"))
+# 1-minute min/max/mean/last, raw samples only around alarms and anomalies, window 0 sends all
+window = data.get("window", 60)
+sink = aggregator.Aggregator(up, window) if window else up
+
 def send_data_to_iot_ticket(v1,v2):
-    print("WRITE DEVICE DATANODES FUNTION.")
-    listofvalues=[]
-    nv = datanodesvalue()
-    nv.set_name("CO2eq") #needed for writing datanode
-    nv.set_path("co2eq")
-    nv.set_dataType("long")
-    nv.set_unit("ppm")
-    nv.set_value(v1) #needed for writing datanode
-    nv.set_timestamp(int(round(time.time() * 1000)))
+    ts = int(round(time.time() * 1000))
+    sink.add(CO2EQ, v1, ts)
+    sink.add(TVOC, v2, ts)
 
-    nv1 = datanodesvalue()
-    nv1.set_name("TVOC") #needed for writing datanode
-    nv1.set_path("tvoc")
-    nv1.set_dataType("long")
-    nv1.set_unit("ppb")
-    nv1.set_value(v2) #needed for writing datanode
-    nv1.set_timestamp(int(round(time.time() * 1000)))
-    listofvalues.append(nv)
-    listofvalues.append(nv1)
-    print(c.writedata(deviceId, *listofvalues)) # another way to make this would be c.writedata(deviceId, nv, nv1)
-    print("END WRITE DEVICE DATANODES FUNCTION")
-    print("-------------------------------------------------------\n")
+poller = modbus_rtu.Poller(port, 9600, timeout=0.2)
+start = modbus_map.ADDRESS["CO2"]
 
 while True:
-    #write datanode demo
-    
-    ser_usart1 = serial.Serial('COM6', 9600, timeout=1)
-    err = 0
-    commands = {"Co2eq": bytes([5, 4, 0, 1, 0, 1, 142, 97]),
-                "Tvoc": bytes([5, 4, 0, 2, 0, 1, 142, 145]),
-                "BaseCo2eq": bytes([5, 4, 0, 3, 0, 1, 78, 192]),
-                "BaseTvoc": bytes([5, 4, 0, 4, 0, 1, 143, 113])}
-    ser_usart1.write(commands["Co2eq"])
-    r = ser_usart1.read(10)
-    err += r[1]
-    co2eq = (r[3] << 8) + r[4]
-    print("co2eq:", co2eq)
-    ser_usart1.write(commands["Tvoc"])
-    r = ser_usart1.read(10)
-    err += r[1]
-    tvoc = (r[3] << 8) + r[4]
-    print("tvoc:", tvoc)
-    
-    if err == 8:    #some error checking here. Because if error reply function code is not 4 but 4 + 0x80 = 132
-        send_data_to_iot_ticket(co2eq,tvoc)
-    
-    ser_usart1.close()
+    # CO2eq and TVOC are adjacent registers, one request reads both
+    try:
+        values = modbus_map.decode(start, poller.read_registers(slave, start, 2))
+    except modbus_rtu.ModbusError as e:
+        print("poll failed:", e)
+    else:
+        print("co2eq:", values["CO2"])
+        print("tvoc:", values["TVOC"])
+        send_data_to_iot_ticket(values["CO2"], values["TVOC"])
+    if window:
+        sink.flush(int(round(time.time() * 1000)))
+    up.poll()
 
     print("sleeping 5s...")
     time.sleep(5)
-
@@ -0,0 +1,262 @@
+"""Local stand-in for the IoT-Ticket REST API, for running the client and the gateway offline.
+
+Implements the endpoints of iotticket.client.Client: process/write/{}, process/read/{},
+devices/ (list, get, register, move, datanodes) and quota/ (all, per device). Any base path and
+any credentials are accepted, e.g. baseurl "http://127.0.0.1:8080/api/v1/". The data is kept
+in memory, at most keep values per datanode.
+
+Latency and errors can be injected: every request is delayed by latency plus a uniform jitter,
+error_rate of the requests get a 503 and drop_rate of the requests are dropped by closing the
+connection without a response.
+
+Usage: python standin_server.py [--port 8080] [--latency 0.05] [--error-rate 0.01]
+"""
+import argparse
+import collections
+import gzip
+import http.server
+import json
+import random
+import re
+import threading
+import time
+import urllib.parse
+
+ROUTES = [
+    ("POST", re.compile(r"/process/write/([^/]+)/?$"), "write"),
+    ("GET", re.compile(r"/process/read/([^/]+)/?$"), "read"),
+    ("GET", re.compile(r"/devices/([^/]+)/datanodes/?$"), "datanodes"),
+    ("POST", re.compile(r"/devices/move/([^/]+)/?$"), "move"),
+    ("GET", re.compile(r"/devices/([^/]+)/?$"), "device"),
+    ("GET", re.compile(r"/devices/?$"), "devices"),
+    ("POST", re.compile(r"/devices/?$"), "register"),
+    ("GET", re.compile(r"/quota/all/?$"), "quota"),
+    ("GET", re.compile(r"/quota/([^/]+)/?$"), "devicequota"),
+]
+
+
+class HttpError(Exception):
+    def __init__(self, status, description, code):
+        self.status = status
+        self.body = {"description": description, "code": code,
+                     "moreInfo": "https://my.iot-ticket.com/api/v1/errorcodes", "apiver": 1}
+
+
+class Store:
+    """Devices and datanode values, shared by the handler threads."""
+
+    def __init__(self, keep=100000):
+        self.keep = keep
+        self.lock = threading.Lock()
+        self.devices = {}
+        # deviceId: {(name, path): {"unit", "dataType", "values": deque of (ts, v)}}
+        self.nodes = {}
+        self.stats = collections.Counter()
+
+    def count(self, key):
+        with self.lock:
+            self.stats[key] += 1
+
+    def register(self, body):
+        with self.lock:
+            deviceId = body.get("deviceId") or "{:032x}".format(random.getrandbits(128))
+            dev = dict(body, deviceId=deviceId, createdAt=time.strftime("%Y-%m-%dT%H:%M:%SZ"))
+            dev.setdefault("enterpriseId", "E0000")
+            self.devices[deviceId] = dev
+            return dev
+
+    def device(self, deviceId):
+        dev = self.devices.get(deviceId)
+        if dev is None:
+            dev = self.register({"deviceId": deviceId, "name": deviceId, "manufacturer": ""})
+        return dev
+
+    def write(self, deviceId, body):
+        results = []
+        total = 0
+        with self.lock:
+            nodes = self.nodes.setdefault(deviceId, {})
+            for item in body:
+                if not item.get("name"):
+                    raise HttpError(400, "datanode name is required", 8001)
+                key = (item["name"], item.get("path") or "")
+                node = nodes.get(key)
+                if node is None:
+                    node = nodes[key] = {"unit": item.get("unit", ""),
+                                         "dataType": item.get("dataType", ""),
+                                         "values": collections.deque(maxlen=self.keep)}
+                values = item.get("values") or [{"v": item.get("v"), "ts": item.get("ts")}]
+                for value in values:
+                    node["values"].append((int(value["ts"]), value["v"]))
+                total += len(values)
+                results.append({"href": "/process/read/{}/?datanodes={}".format(
+                    deviceId, item["name"]), "writtenCount": len(values)})
+            self.stats["samples"] += total
+            self.stats["writes"] += 1
+        return {"totalWritten": total, "writeResults": results}
+
+    def read(self, deviceId, query):
+        names = [n for n in query.get("datanodes", [""])[0].split(",") if n]
+        fromdate = int(query.get("fromdate", ["0"])[0])
+        todate = int(query.get("todate", ["0"])[0]) or 1 << 62
+        limit = min(int(query.get("limit", ["1000"])[0]), 10000)
+        descending = query.get("order", ["ascending"])[0] == "descending"
+        reads = []
+        with self.lock:
+            for (name, path), node in self.nodes.get(deviceId, {}).items():
+                if name not in names and (path.strip("/") + "/" + name) not in names:
+                    continue
+                values = [(ts, v) for ts, v in node["values"] if fromdate <= ts <= todate]
+                values.sort(reverse=descending)
+                reads.append({"name": name, "path": path, "unit": node["unit"],
+                              "dataType": node["dataType"],
+                              "values": [{"v": v, "ts": ts} for ts, v in values[:limit]]})
+        return {"href": "/process/read/{}/".format(deviceId), "datanodeReads": reads}
+
+    def datanodes(self, deviceId):
+        with self.lock:
+            items = [{"name": name, "path": path, "unit": node["unit"],
+                      "dataType": node["dataType"]}
+                     for (name, path), node in self.nodes.get(deviceId, {}).items()]
+        return items
+
+
+class Handler(http.server.BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"  # keep-alive
+
+    def log_message(self, format, *args):
+        if self.server.verbose:
+            super().log_message(format, *args)
+
+    def do_GET(self):
+        self.dispatch("GET")
+
+    def do_POST(self):
+        self.dispatch("POST")
+
+    def reply(self, status, obj):
+        body = json.dumps(obj).encode("utf-8")
+        if "gzip" in self.headers.get("Accept-Encoding", "") and len(body) >= 1024:
+            body = gzip.compress(body)
+            self.send_response(status)
+            self.send_header("Content-Encoding", "gzip")
+        else:
+            self.send_response(status)
+        self.send_header("Content-Type", "application/json")
+        self.send_header("Content-Length", str(len(body)))
+        self.end_headers()
+        self.wfile.write(body)
+
+    def dispatch(self, method):
+        server = self.server
+        length = int(self.headers.get("Content-Length", 0))
+        data = self.rfile.read(length) if length else b""
+        server.store.count("requests")
+        if server.latency or server.jitter:
+            time.sleep(server.latency + random.uniform(0, server.jitter))
+        if random.random() < server.drop_rate:
+            server.store.count("dropped")
+            self.close_connection = True
+            return
+        try:
+            if random.random() < server.error_rate:
+                server.store.count("errors")
+                raise HttpError(503, "injected error", 503)
+            if self.headers.get("Content-Encoding") == "gzip":
+                data = gzip.decompress(data)
+            parts = urllib.parse.urlsplit(self.path)
+            for route_method, pattern, name in ROUTES:
+                match = pattern.search(parts.path)
+                if route_method == method and match:
+                    body = json.loads(data.decode("utf-8")) if data else None
+                    query = urllib.parse.parse_qs(parts.query)
+                    self.reply(200, getattr(self, "api_" + name)(*match.groups(), body=body,
+                                                                 query=query))
+                    return
+            raise HttpError(404, "Not found", 404)
+        except HttpError as e:
+            self.reply(e.status, e.body)
+        except (ValueError, KeyError, TypeError) as e:
+            self.reply(400, HttpError(400, "bad request: {}".format(e), 8000).body)
+
+    def api_write(self, deviceId, body, query):
+        if not isinstance(body, list):
+            raise HttpError(400, "expected a list of datanode values", 8000)
+        return self.server.store.write(deviceId, body)
+
+    def api_read(self, deviceId, body, query):
+        return self.server.store.read(deviceId, query)
+
+    def api_datanodes(self, deviceId, body, query):
+        items = self.server.store.datanodes(deviceId)
+        return page(items, query)
+
+    def api_move(self, deviceId, body, query):
+        dev = self.server.store.device(deviceId)
+        dev["enterpriseId"] = body["enterpriseId"]
+        return dev
+
+    def api_device(self, deviceId, body, query):
+        return self.server.store.device(deviceId)
+
+    def api_devices(self, body, query):
+        return page(list(self.server.store.devices.values()), query)
+
+    def api_register(self, body, query):
+        return self.server.store.register(body)
+
+    def api_quota(self, body, query):
+        store = self.server.store
+        return {"totalDevices": len(store.devices), "maxNumberOfDevices": -1,
+                "maxDataNodePerDevice": -1, "usedStorageSize": store.stats["samples"] * 16,
+                "maxStorageSize": -1}
+
+    def api_devicequota(self, deviceId, body, query):
+        store = self.server.store
+        return {"deviceId": deviceId, "totalRequestToday": store.stats["requests"],
+                "maxReadRequestPerDay": -1, "numberOfDataNodes": len(store.datanodes(deviceId)),
+                "storageSize": 0}
+
+
+def page(items, query):
+    limit = min(int(query.get("limit", ["10"])[0]), 100)
+    offset = int(query.get("offset", ["0"])[0])
+    return {"fullSize": len(items), "limit": limit, "offset": offset,
+            "items": items[offset:offset + limit]}
+
+
+class StandInServer(http.server.ThreadingHTTPServer):
+    """Stand-in server, run serve_forever() in a thread and point the client to url."""
+
+    daemon_threads = True
+
+    def __init__(self, host="127.0.0.1", port=0, latency=0.0, jitter=0.0, error_rate=0.0,
+                 drop_rate=0.0, keep=100000, verbose=False):
+        super().__init__((host, port), Handler)
+        self.latency = latency
+        self.jitter = jitter
+        self.error_rate = error_rate
+        self.drop_rate = drop_rate
+        self.verbose = verbose
+        self.store = Store(keep)
+        self.url = "http://{}:{}/api/v1/".format(host, self.server_port)
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--host", default="127.0.0.1")
+    parser.add_argument("--port", type=int, default=8080)
+    parser.add_argument("--latency", type=float, default=0.0, help="delay of a request in s")
+    parser.add_argument("--jitter", type=float, default=0.0, help="random extra delay in s")
+    parser.add_argument("--error-rate", type=float, default=0.0, help="share of 503 replies")
+    parser.add_argument("--drop-rate", type=float, default=0.0, help="share of dropped requests")
+    parser.add_argument("--keep", type=int, default=100000, help="values kept per datanode")
+    parser.add_argument("--verbose", action="store_true", help="log the requests")
+    args = parser.parse_args()
+    server = StandInServer(args.host, args.port, args.latency, args.jitter, args.error_rate,
+                           args.drop_rate, args.keep, args.verbose)
+    print("baseurl", server.url, flush=True)
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        server.server_close()
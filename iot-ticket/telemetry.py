@@ -0,0 +1,245 @@
+"""Request telemetry of the gateway, per slave and per port.
+
+Each request is recorded with its outcome: the response time for the replies (data or
+exception), and a count for the timeouts, CRC failures, mismatched replies and exceptions, by
+exception code. Response times go to histograms with fixed buckets, so recording is a few
+additions. The port series are the sums of the slave series, computed on export.
+
+Exports:
+    render()            Prometheus text exposition format
+    serve(port)         HTTP server thread with render() at /metrics
+    FileExporter        JSON snapshot lines in a rotating file
+"""
+import collections
+import http.server
+import json
+import logging
+import logging.handlers
+import threading
+import time
+
+# response time buckets in s, from the end of the request to the first reply byte
+BUCKETS = (0.002, 0.005, 0.01, 0.02, 0.05, 0.1, 0.2, 0.5, 1.0)
+COUNTERS = ("requests", "timeouts", "crc_errors", "frame_errors", "exceptions")
+HELP = {
+    "requests": "Requests sent",
+    "timeouts": "Requests without a complete reply",
+    "crc_errors": "Replies with a bad CRC",
+    "frame_errors": "Replies of another slave or function code",
+    "exceptions": "Exception replies, by exception code",
+}
+
+
+class Histogram:
+    """Response time histogram. counts[i] are the samples of bucket i alone, in
+    BUCKETS[i - 1] < value <= BUCKETS[i], the last one above BUCKETS[-1]. cumulative() gives the
+    running totals of the Prometheus buckets."""
+
+    def __init__(self):
+        self.counts = [0] * (len(BUCKETS) + 1)
+        self.sum = 0.0
+        self.count = 0
+
+    def observe(self, value):
+        for i, bound in enumerate(BUCKETS):
+            if value <= bound:
+                break
+        else:
+            i = len(BUCKETS)
+        self.counts[i] += 1
+        self.sum += value
+        self.count += 1
+
+    def merge(self, other):
+        for i, n in enumerate(other.counts):
+            self.counts[i] += n
+        self.sum += other.sum
+        self.count += other.count
+
+    def cumulative(self):
+        total = 0
+        result = []
+        for n in self.counts:
+            total += n
+            result.append(total)
+        return result
+
+    def quantile(self, q):
+        """Upper bound of the bucket holding the q quantile, "+Inf" above the last bucket, None
+        when empty."""
+        if not self.count:
+            return None
+        for bound, total in zip(BUCKETS + ("+Inf",), self.cumulative()):
+            if total >= q * self.count:
+                return bound
+
+
+class Series:
+    """Counters and response time histogram of one slave."""
+
+    def __init__(self):
+        self.counters = collections.Counter()
+        self.exceptions = collections.Counter()  # exception code: count
+        self.latency = Histogram()
+
+
+class Telemetry:
+    """Recorder of the request outcomes, shared by the buses and read by the exporters.
+
+    state, when set, returns {(port, slave): {"online": bool, "timeout": s}} for the gauges. It is
+    called from the exporter threads, so it must not read state that another thread mutates.
+    """
+
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.series = {}  # (port, slave): Series
+        self.state = None
+
+    def record(self, port, slave, outcome, rtt=None):
+        """outcome is "ok", "timeout", "crc", "frame" or the exception code of the reply."""
+        with self.lock:
+            s = self.series.get((port, slave))
+            if s is None:
+                s = self.series[(port, slave)] = Series()
+            s.counters["requests"] += 1
+            if outcome == "timeout":
+                s.counters["timeouts"] += 1
+            elif outcome == "crc":
+                s.counters["crc_errors"] += 1
+            elif outcome == "frame":
+                s.counters["frame_errors"] += 1
+            elif outcome != "ok":
+                s.counters["exceptions"] += 1
+                s.exceptions[outcome] += 1
+            if rtt is not None:
+                s.latency.observe(rtt)
+
+    def snapshot(self):
+        """Return {(port, slave): Series} and {port: Series}, copies taken under the lock."""
+        slaves = {}
+        ports = {}
+        with self.lock:
+            for key, s in self.series.items():
+                copy = Series()
+                copy.counters.update(s.counters)
+                copy.exceptions.update(s.exceptions)
+                copy.latency.merge(s.latency)
+                slaves[key] = copy
+                port = ports.setdefault(key[0], Series())
+                port.counters.update(s.counters)
+                port.exceptions.update(s.exceptions)
+                port.latency.merge(s.latency)
+        return slaves, ports
+
+    def render(self):
+        """Prometheus text exposition format."""
+        slaves, ports = self.snapshot()
+        lines = []
+        for prefix, series, labels in (
+                ("modbus_slave", slaves, lambda k: 'port="{}",slave="{}"'.format(*k)),
+                ("modbus_port", ports, lambda k: 'port="{}"'.format(k))):
+            for name in COUNTERS:
+                lines.append("# HELP {}_{}_total {}".format(prefix, name, HELP[name]))
+                lines.append("# TYPE {}_{}_total counter".format(prefix, name))
+                for key, s in sorted(series.items()):
+                    if name == "exceptions":
+                        for code, n in sorted(s.exceptions.items()):
+                            lines.append('{}_exceptions_total{{{},code="{}"}} {}'.format(
+                                prefix, labels(key), code, n))
+                    else:
+                        lines.append("{}_{}_total{{{}}} {}".format(
+                            prefix, name, labels(key), s.counters[name]))
+            metric = prefix + "_response_seconds"
+            lines.append("# HELP {} Time from the end of the request to the first reply byte"
+                         .format(metric))
+            lines.append("# TYPE {} histogram".format(metric))
+            for key, s in sorted(series.items()):
+                for bound, total in zip(BUCKETS + ("+Inf",), s.latency.cumulative()):
+                    lines.append('{}_bucket{{{},le="{}"}} {}'.format(metric, labels(key), bound,
+                                                                    total))
+                lines.append("{}_sum{{{}}} {}".format(metric, labels(key), s.latency.sum))
+                lines.append("{}_count{{{}}} {}".format(metric, labels(key), s.latency.count))
+        if self.state is not None:
+            state = self.state()
+            lines.append("# HELP modbus_slave_online 1 when the slave answers, 0 when backed off")
+            lines.append("# TYPE modbus_slave_online gauge")
+            for key, st in sorted(state.items()):
+                lines.append('modbus_slave_online{{port="{}",slave="{}"}} {}'.format(
+                    key[0], key[1], int(st["online"])))
+            lines.append("# HELP modbus_slave_timeout_seconds Current adaptive reply timeout")
+            lines.append("# TYPE modbus_slave_timeout_seconds gauge")
+            for key, st in sorted(state.items()):
+                lines.append('modbus_slave_timeout_seconds{{port="{}",slave="{}"}} {:.4f}'.format(
+                    key[0], key[1], st["timeout"]))
+        return "\n".join(lines) + "\n"
+
+    def serve(self, port=9105, host=""):
+        """Serve render() at http://host:port/metrics from a thread, return the server."""
+        telemetry = self
+
+        class Handler(http.server.BaseHTTPRequestHandler):
+            def log_message(self, format, *args):
+                pass
+
+            def do_GET(self):
+                if self.path.split("?")[0] != "/metrics":
+                    self.send_error(404)
+                    return
+                body = telemetry.render().encode("utf-8")
+                self.send_response(200)
+                self.send_header("Content-Type", "text/plain; version=0.0.4")
+                self.send_header("Content-Length", str(len(body)))
+                self.end_headers()
+                self.wfile.write(body)
+
+        server = http.server.ThreadingHTTPServer((host, port), Handler)
+        server.daemon_threads = True
+        threading.Thread(target=server.serve_forever, daemon=True).start()
+        return server
+
+
+class FileExporter(threading.Thread):
+    """Append a JSON snapshot line every interval s to path, rotated at max_bytes with backups
+    old files kept. Each line holds the counters, the histogram and the p50/p99 bucket bounds of
+    every slave and port. The histogram is bucket_counts, the per bucket counts of
+    Histogram.counts, not cumulative, against the upper bounds in bucket_bounds.
+    """
+
+    def __init__(self, telemetry, path, interval=60.0, max_bytes=1 << 20, backups=5):
+        super().__init__(daemon=True)
+        self.telemetry = telemetry
+        self.interval = interval
+        self.stop_event = threading.Event()
+        self.logger = logging.getLogger("telemetry." + path)
+        self.logger.propagate = False
+        self.logger.setLevel(logging.INFO)
+        handler = logging.handlers.RotatingFileHandler(path, maxBytes=max_bytes,
+                                                       backupCount=backups)
+        handler.setFormatter(logging.Formatter("%(message)s"))
+        self.logger.addHandler(handler)
+        self.handler = handler
+
+    @staticmethod
+    def entry(s):
+        return dict(s.counters, exception_codes=dict(s.exceptions),
+                    bucket_counts=s.latency.counts,
+                    sum=round(s.latency.sum, 6), p50=s.latency.quantile(0.5),
+                    p99=s.latency.quantile(0.99))
+
+    def write(self):
+        slaves, ports = self.telemetry.snapshot()
+        self.logger.info(json.dumps({
+            "time": time.time(), "bucket_bounds": BUCKETS,
+            "ports": {port: self.entry(s) for port, s in ports.items()},
+            "slaves": [dict(self.entry(s), port=key[0], slave=key[1])
+                       for key, s in sorted(slaves.items())]}))
+
+    def run(self):
+        while not self.stop_event.wait(self.interval):
+            self.write()
+
+    def stop(self):
+        self.stop_event.set()
+        self.join()
+        self.write()
+        self.handler.close()
@@ -0,0 +1,240 @@
+"""Batched IoT-Ticket uploads with an offline spool.
+
+Samples are collected per datanode and written with one writedata call per batch, each datanode
+carrying its samples in the values list. A batch that cannot be sent because the server is
+unreachable or overloaded (5xx or 429 after the retries of the client) is appended to the spool
+file, one JSON sample per line. The spool is drained in
+chunks of drain_size lines once the server answers again, it is probed every retry s while
+offline. The read position is kept in <spool>.pos, so memory stays bounded however long the
+outage was. The spool is removed when it has been drained completely.
+"""
+import http.client
+import json
+import os
+import queue
+import threading
+import time
+
+from iotticket.models import datanodesvalue
+from iotticket.models import errorinfo
+from iotticket.models import vts
+
+# errors of an unreachable server, urllib.error.URLError and socket.timeout are OSErrors
+OFFLINE_ERRORS = (OSError, http.client.HTTPException)
+TOO_MANY_REQUESTS = 429  # with the 5xx statuses a refusal of the moment, not of the batch
+
+
+class Datanode:
+    """Definition of a datanode, the key of its samples."""
+
+    def __init__(self, name, path, unit="", dataType="long"):
+        self.name = name
+        self.path = path
+        self.unit = unit
+        self.dataType = dataType
+
+    def key(self):
+        return (self.name, self.path, self.unit, self.dataType)
+
+
+class Uploader:
+    """Collect samples and write them in batches, see the module docstring.
+
+    A batch is sent when batch_size samples are pending or the oldest one is max_age s old.
+    """
+
+    def __init__(self, client, deviceId, batch_size=100, max_age=600.0, spool="spool.jsonl",
+                 drain_size=500, retry=60.0, log=print):
+        self.client = client
+        self.deviceId = deviceId
+        self.batch_size = batch_size
+        self.max_age = max_age
+        self.spool = spool
+        self.drain_size = drain_size
+        self.retry = retry
+        self.log = log
+        self.pending = {}  # key: [(v, ts)]
+        self.count = 0
+        self.oldest = None
+        self.online = True
+        self.retry_at = 0.0
+
+    def add(self, node, v, ts=None):
+        """Queue one sample of node (Datanode), ts in ms, default now."""
+        if ts is None:
+            ts = int(round(time.time() * 1000))
+        self.pending.setdefault(node.key(), []).append((v, ts))
+        self.count += 1
+        if self.oldest is None:
+            self.oldest = time.monotonic()
+
+    def poll(self):
+        """Send the pending batch when it is due and drain the spool.
+
+        Call after add, or periodically.
+
+        While the server is unreachable the batches go to the spool, and the spool is retried
+        every retry s.
+        """
+        now = time.monotonic()
+        if self.count >= self.batch_size or (
+                self.oldest is not None and now - self.oldest >= self.max_age):
+            self.flush()
+        if self.spooled() and (self.online or now >= self.retry_at):
+            self.drain()
+
+    def flush(self):
+        """Send the pending samples now, spool them when the server is unreachable.
+
+        Behind a spool they are spooled too, so the samples reach the server in order.
+        """
+        if not self.count:
+            return
+        samples = [(key, v, ts) for key, values in self.pending.items() for v, ts in values]
+        self.pending = {}
+        self.count = 0
+        self.oldest = None
+        if not self.online or self.spooled() or not self.send(samples):
+            self.append_spool(samples)
+
+    def send(self, samples):
+        """Write [(key, v, ts)] in one request, return False when the server is unreachable.
+
+        A 5xx or 429 status left after the retries of the client counts as unreachable. A batch
+        rejected with another status is logged and dropped, retrying it cannot succeed.
+        """
+        nodes = {}
+        for key, v, ts in samples:
+            node = nodes.get(key)
+            if node is None:
+                name, path, unit, dataType = key
+                node = nodes[key] = datanodesvalue(unit, dataType, name, path)
+            node.set_values(vts(v, ts))
+            node.set_value(v)  # validate() checks v, the last sample
+            node.set_timestamp(ts)
+        try:
+            result = self.client.writedata(self.deviceId, *nodes.values())
+        except errorinfo as e:
+            status = e.get_httpstatus() or 0
+            if status < 500 and status != TOO_MANY_REQUESTS:
+                self.log("upload rejected, {} samples dropped: {}".format(len(samples), e))
+            else:
+                return self.offline("HTTP {} {}".format(status, e.description))
+        except OFFLINE_ERRORS as e:
+            return self.offline(e)
+        else:
+            self.log("uploaded {} samples: {}".format(len(samples), str(result).strip()))
+        self.online = True
+        self.retry_at = 0.0
+        return True
+
+    def offline(self, error):
+        """Mark the server unreachable until the next probe, return False."""
+        if self.online:
+            self.log("upload failed, spooling: {}".format(error))
+        self.online = False
+        self.retry_at = time.monotonic() + self.retry
+        return False
+
+    def append_spool(self, samples):
+        with open(self.spool, "ab+") as f:
+            if f.tell() > 0:
+                f.seek(-1, os.SEEK_END)
+                if f.read(1) != b"\n":
+                    f.write(b"\n")  # end the torn line of an interrupted append
+            for (name, path, unit, dataType), v, ts in samples:
+                f.write(json.dumps([name, path, unit, dataType, v, ts]).encode() + b"\n")
+            f.flush()
+            os.fsync(f.fileno())
+
+    def spooled(self):
+        """True when the spool has samples left to send."""
+        try:
+            return os.path.getsize(self.spool) > self.read_pos()
+        except OSError:
+            return False
+
+    def read_pos(self):
+        try:
+            with open(self.spool + ".pos") as f:
+                return int(f.read() or 0)
+        except (OSError, ValueError):
+            return 0
+
+    def write_pos(self, pos):
+        tmp = self.spool + ".pos.tmp"
+        with open(tmp, "w") as f:
+            f.write(str(pos))
+        os.replace(tmp, self.spool + ".pos")
+
+    def drain(self):
+        """Send the spool, drain_size samples per request, stop when the server is unreachable.
+
+        The first request after an outage is the probe, when it succeeds the server is online.
+        """
+        pos = self.read_pos()
+        with open(self.spool, "rb") as f:
+            f.seek(pos)
+            while True:
+                samples = []
+                end = pos
+                while len(samples) < self.drain_size:
+                    line = f.readline()
+                    if not line.endswith(b"\n"):
+                        break  # end of the spool, or the torn line of an interrupted append
+                    end += len(line)
+                    try:
+                        name, path, unit, dataType, v, ts = json.loads(line)
+                    except ValueError:
+                        continue  # torn line
+                    samples.append(((name, path, unit, dataType), v, ts))
+                if not samples:
+                    if end > pos:
+                        pos = end
+                        self.write_pos(pos)
+                        continue
+                    break
+                if not self.send(samples):
+                    return
+                pos = end
+                self.write_pos(pos)
+        if pos >= os.path.getsize(self.spool):
+            os.remove(self.spool)
+            if os.path.exists(self.spool + ".pos"):
+                os.remove(self.spool + ".pos")
+
+
+class Worker(threading.Thread):
+    """Run an Uploader in its own thread, add() only queues the sample, so a slow or retried
+    upload does not hold up the polling. The uploader is polled every interval s.
+    """
+
+    def __init__(self, uploader, interval=1.0):
+        super().__init__(daemon=True)
+        self.uploader = uploader
+        self.interval = interval
+        self.queue = queue.Queue()
+
+    def add(self, node, v, ts=None):
+        if ts is None:
+            ts = int(round(time.time() * 1000))
+        self.queue.put((node, v, ts))
+
+    def stop(self):
+        """Send everything queued and pending, then end the thread."""
+        self.queue.put(None)
+        self.join()
+
+    def run(self):
+        while True:
+            try:
+                item = self.queue.get(timeout=self.interval)
+            except queue.Empty:
+                self.uploader.poll()
+                continue
+            if item is None:
+                self.uploader.flush()
+                return
+            self.uploader.add(*item)
+            if self.queue.empty() or self.uploader.count >= self.uploader.batch_size:
+                self.uploader.poll()
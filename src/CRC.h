@@ -3,8 +3,50 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#if defined(STM32L152xE)
+#include "stm32l1xx.h"
+#endif
+
+/*
+ * CRC backend, selected at build time with CRC_HW_EN. Parts with a configurable CRC unit (CRC_POL
+ * register, e.g. STM32L0/F0/F3) compute CRC16 and CRC8 in hardware when built with -DCRC_HW_EN=1
+ * and their device header in CRC_DEVICE_HEADER, e.g. -DCRC_DEVICE_HEADER='"stm32l0xx.h"'. The
+ * default, and the only choice on the CRC-32 only unit of the STM32L1, is the software kernels:
+ * slicing-by-4 for the Modbus CRC16 and a table for the SGP30 CRC8 polynomial. The reference
+ * kernels are kept for validation of the others (test/crc_test.c).
+ */
+#ifndef CRC_HW_EN
+#define CRC_HW_EN 0
+#endif
+
+#if (CRC_HW_EN > 0u)
+#if defined(CRC_DEVICE_HEADER)
+#include CRC_DEVICE_HEADER
+#endif
+#if !defined(CRC_POL_POL)
+#error "CRC_HW_EN needs the device header of a part with a configurable CRC unit (CRC_POL)"
+#endif
+#endif
+
+#define CRC16_MODBUS_POLY 0x8005U  // x^16 + x^15 + x^2 + 1, reflected 0xA001
+#define CRC16_MODBUS_INIT 0xFFFFU
+#define CRC8_TABLE_POLY   0x31U    // polynomial of the CRC8 table, SGP30_CRC8_POLY
+
+void     crc_Init(void);
 uint8_t  CRC8(const uint8_t *data, const size_t length, const uint8_t polynomial,
               const uint8_t crc_init, const uint8_t final_xor);
 uint16_t CRC16(const uint8_t *nData, const uint16_t wLength);
 
+/* Backend kernels, CRC8 and CRC16 dispatch to the fastest one available */
+uint8_t  crc8_Bitwise(const uint8_t *data, const size_t length, const uint8_t polynomial,
+                      const uint8_t crc_init);
+uint8_t  crc8_Table(const uint8_t *data, const size_t length, const uint8_t crc_init);
+uint16_t crc16_Table(const uint8_t *data, const size_t length);
+uint16_t crc16_Slice4(const uint8_t *data, const size_t length);
+#if (CRC_HW_EN > 0u)
+uint8_t  crc8_Hardware(const uint8_t *data, const size_t length, const uint8_t polynomial,
+                       const uint8_t crc_init);
+uint16_t crc16_Hardware(const uint8_t *data, const size_t length);
+#endif
+
 #endif
@@ -5,11 +5,7 @@
 
 #include "stm32l1xx.h"
 
+/* Transfers go through the bus manager, see i2c_bus.h */
 void I2C1_init(void);
-void I2C_Stop(void);
-void I2C_StartTransmission(const uint8_t address);
-void I2C_WriteCommand(const size_t length, const uint8_t *command);
-void I2C_WriteData(const size_t length, const uint8_t *command);
-void I2C_Read(const uint8_t address, const size_t data_length, uint8_t *data);
 
 #endif
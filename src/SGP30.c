@@ -1,8 +1,8 @@
 #include "sgp30.h"
 
 #include "crc.h"
-#include "i2c.h"
-#include "utils.h"
+#include "i2c_bus.h"
+#include "profiler.h"
 
 /* SGP30 constants */
 const uint8_t Init_air_quality[2]        = {0x20, 0x03};
@@ -15,7 +15,35 @@ const uint8_t Get_feature_set_version[2] = {0x20, 0x2f};
 const uint8_t Measure_raw_signals[2]     = {0x20, 0x50};
 const uint8_t Get_seiral_id[2]           = {0x36, 0x82};
 
+static i2c_device_t s_device      = {SGP30_ADDR, SGP30_I2C_PRIORITY, 0};
+static i2c_device_t s_generalCall = {SGP30_GENERAL_CALL_ADDR, SGP30_I2C_PRIORITY, 0};
+
 /* Private function delcaration */
+/* Write the command and its data, wait the execution time and read the reply, if any */
+static SGP30ERR s_Command(const uint8_t *const command, const uint8_t *const data,
+                          const size_t data_length, uint8_t *const reply,
+                          const size_t reply_length, const uint16_t wait_ms) {
+    i2c_transaction_t tr;
+    I2C_BUS_STATUS    status;
+
+    tr.device = &s_device;
+    tr.tx[0]  = command[0];
+    tr.tx[1]  = command[1];
+    for (size_t i = 0; i < data_length; i++) {
+        tr.tx[2 + i] = data[i];
+    }
+    tr.txLen  = (uint8_t)(2 + data_length);
+    tr.rx     = reply;
+    tr.rxLen  = (uint8_t)reply_length;
+    tr.waitMs = wait_ms;
+    tr.done   = NULL;
+
+    PROFILER_BEGIN(PROF_ZONE_SGP30_I2C);
+    status = i2cBus_Transfer(&tr, wait_ms + SGP30_I2C_TIMEOUT_MS);
+    PROFILER_END(PROF_ZONE_SGP30_I2C);
+    return (I2C_BUS_DONE == status) ? SGP30_SUCCESS : SGP30_ERR_I2C;
+}
+
 static inline void s_SetCo2(sgp30_t *const sgp_data, const uint8_t *const sgp_binary_data) {
     sgp_data->CO2  = ((uint16_t)sgp_binary_data[0] << 8) + (uint16_t)sgp_binary_data[1];
     sgp_data->TVOC = ((uint16_t)sgp_binary_data[3] << 8) + (uint16_t)sgp_binary_data[4];
@@ -56,24 +84,45 @@ sgp30_t sgp30_create() {
 
 /**
  * \brief Start air quality measurement. Initialization period takes about 15s.
- * \return SGP30_SUCCESS
+ * \return SGP30_SUCCESS, SGP30_ERR_I2C
  * \author siyuan xu, e2101066@edu.vamk.fi, Jan.2023
  * \details After InitAirQuality, MeasureAirQuality should be called in regular intervals of 1s.
  * During initialization phase, returns fixed values of 400 ppm CO2eq and 0ppb TVOC.
  */
 SGP30ERR sgp30_InitAirQuality() {
-    I2C1_init();
-    I2C_StartTransmission(SGP30_ADDR);
-    I2C_WriteCommand(2, Init_air_quality);
-    delay_ms(10);
-    I2C_Stop();
-    return SGP30_SUCCESS;
+    return s_Command(Init_air_quality, NULL, 0, NULL, 0, 10);
+}
+
+/**
+ * \brief Soft reset with the I2C general call reset
+ * \return SGP30_SUCCESS, SGP30_ERR_I2C
+ * \author agent, agent@local, Oct.2026
+ * \details The sensor restarts and enters the idle mode, the air quality algorithm and the
+ * humidity compensation are lost and sgp30_InitAirQuality has to be called again. The general
+ * call also resets the other devices on the bus that support it.
+ */
+SGP30ERR sgp30_SoftReset(void) {
+    i2c_transaction_t tr;
+    I2C_BUS_STATUS    status;
+
+    tr.device = &s_generalCall;
+    tr.tx[0]  = I2C_RESET_COMMAND;
+    tr.txLen  = 1;
+    tr.rx     = NULL;
+    tr.rxLen  = 0;
+    tr.waitMs = SGP30_SOFT_RESET_TIME_MS;
+    tr.done   = NULL;
+
+    PROFILER_BEGIN(PROF_ZONE_SGP30_I2C);
+    status = i2cBus_Transfer(&tr, SGP30_SOFT_RESET_TIME_MS + SGP30_I2C_TIMEOUT_MS);
+    PROFILER_END(PROF_ZONE_SGP30_I2C);
+    return (I2C_BUS_DONE == status) ? SGP30_SUCCESS : SGP30_ERR_I2C;
 }
 
 /**
  * \brief Measure and calculate CO2eq and total VOC(TVOC)
  * \param[out] sgp_data - The memory address where the date would be stored, 6 bytes.
- * \return SGP30_SUCCESS, SGP30_ERR_BAD_CRC
+ * \return SGP30_SUCCESS, SGP30_ERR_BAD_CRC, SGP30_ERR_I2C
  * \author siyuan xu, e2101066@edu.vamk.fi, Jan.2023
  * \details After InitAirQuality, MeasureAirQuality should be called in regular intervals of 1s.
  * During initialization phase, returns fixed values of 400 ppm CO2eq and 0ppb TVOC. For better
@@ -83,10 +132,9 @@ SGP30ERR sgp30_MeasureAirQuality(sgp30_t *const sgp_data) {
     uint8_t crc_co2 = 0, crc_tvoc = 0;
     uint8_t binary_data[6];
 
-    I2C_StartTransmission(SGP30_ADDR);
-    I2C_WriteCommand(2, Measure_air_quality);
-    delay_ms(12);
-    I2C_Read(SGP30_ADDR, 6, binary_data);
+    if (SGP30_SUCCESS != s_Command(Measure_air_quality, NULL, 0, binary_data, 6, 12)) {
+        return SGP30_ERR_I2C;
+    }
 
     // CRC check
     crc_co2 = CRC8(binary_data, 2, SGP30_CRC8_POLY, SGP30_CRC8_INIT, SGP30_CRC8_XOR);
@@ -107,7 +155,7 @@ SGP30ERR sgp30_MeasureAirQuality(sgp30_t *const sgp_data) {
 /**
  * \brief Measure and calculate CO2eq and total VOC(TVOC) baseline.
  * \param[out] sgp_data - The memory address where the date would be stored, 6 bytes.
- * \return SGP30_SUCCESS, SGP30_ERR_BAD_CRC
+ * \return SGP30_SUCCESS, SGP30_ERR_BAD_CRC, SGP30_ERR_I2C
  * \author siyuan xu, e2101066@edu.vamk.fi, Jan.2023
  * \details For better accuracy, returned data from GetBaseline should be stored and SetBaseline
  * every hour.
@@ -116,10 +164,9 @@ SGP30ERR spg30_GetBaseLine(sgp30_t *const sgp_data) {
     uint8_t crc_co2 = 0, crc_tvoc = 0;
     uint8_t binary_data[6];
 
-    I2C_StartTransmission(SGP30_ADDR);
-    I2C_WriteCommand(2, Get_baseline);
-    delay_ms(10);
-    I2C_Read(SGP30_ADDR, 6, binary_data);
+    if (SGP30_SUCCESS != s_Command(Get_baseline, NULL, 0, binary_data, 6, 10)) {
+        return SGP30_ERR_I2C;
+    }
 
     // CRC check
     crc_co2 = CRC8(binary_data, 2, SGP30_CRC8_POLY, SGP30_CRC8_INIT, SGP30_CRC8_XOR);
@@ -141,7 +188,7 @@ SGP30ERR spg30_GetBaseLine(sgp30_t *const sgp_data) {
  * \brief Set CO2eq and total VOC(TVOC) baseline for compensation algorithm.
  * \param[in] baseline_eco2 - The baseline value of CO2eq, ppm. max 60000
  * \param[in] baseline_tvoc - The baseline value of TVOC, ppb. max 60000
- * \return SGP30_SUCCESS, SGP30_BAD_BASELINE
+ * \return SGP30_SUCCESS, SGP30_BAD_BASELINE, SGP30_ERR_I2C
  * \author siyuan xu, e2101066@edu.vamk.fi, Jan.2023
  * \details For better accuracy, returned data from GetBaseline should be stored and SetBaseline
  * every hour.
@@ -154,26 +201,21 @@ SGP30ERR sgp30_SetBaseline(const uint16_t baseline_eco2, const uint16_t baseline
 
     uint8_t binary_data[6];
     binary_data[0] = baseline_eco2 >> 8;
-    binary_data[1] = baseline_eco2 & 0x0f;
+    binary_data[1] = baseline_eco2 & 0xff;
     binary_data[2] = CRC8(binary_data, 2, SGP30_CRC8_POLY, SGP30_CRC8_INIT, SGP30_CRC8_XOR);
     binary_data[3] = baseline_tvoc >> 8;
-    binary_data[4] = baseline_tvoc & 0x0f;
+    binary_data[4] = baseline_tvoc & 0xff;
     binary_data[5] = CRC8(binary_data + 3, 2, SGP30_CRC8_POLY, SGP30_CRC8_INIT, SGP30_CRC8_XOR);
 
-    I2C_StartTransmission(SGP30_ADDR);
-    I2C_WriteCommand(2, Set_baseline);
-    I2C_WriteData(6, binary_data);
-    delay_ms(10);
-    I2C_Stop();
-
-    return SGP30_SUCCESS;
+    return s_Command(Set_baseline, binary_data, 6, NULL, 0, 10);
 }
 
 /**
  * \brief Set humidity compensation for the air quality signals (CO2eq and TVOC) and sensor raw
  * signals (H2-signal and Ethanol_signal).
- * \param[in] humidity - The absolute humidity of the environment.
- * \return SGP30_SUCCESS, SGP30_BAD_HUMIDITY
+ * \param[in] humidity - The absolute humidity of the environment, g/m3 in 8.8 fixed point, see
+ * humidity_ToSgp30.
+ * \return SGP30_SUCCESS, SGP30_ERR_I2C
  * \author siyuan xu, e2101066@edu.vamk.fi, Jan.2023
  * \details The 2 data bytes represent humidity values as a fixed-point 8.8bit number with a minimum
  * value of 0x0001 (=1/256 g/m3) and a maximum value of 0xFFFF (255 g/m3 + 255/256 g/m3). For
@@ -185,30 +227,19 @@ SGP30ERR sgp30_SetBaseline(const uint16_t baseline_eco2, const uint16_t baseline
  * humidity value is sent. Sending a humidity value of 0x0000 can therefore be used to turn off the
  * humidity compensation.
  */
-SGP30ERR  spg30_SetAbsoluteHumidity(const double humidity) {
-    // validate input
-    if(humidity > (255 + 255.0/256)){
-        return SGP30_BAD_HUMIDITY;
-    }
-    uint8_t  binary_data[3];
-    uint16_t m_humidity = humidity * 100;  // maximum humidity value is 255+255/256. In this case
-                                           // uint16_t can contain the converion.
-    binary_data[0] = m_humidity >> 8;
-    binary_data[1] = (uint8_t)((m_humidity & 0x0f) * 256 / 100);  // ex.
+SGP30ERR sgp30_SetAbsoluteHumidity(const uint16_t humidity) {
+    uint8_t binary_data[3];
+    binary_data[0] = (uint8_t)(humidity >> 8);
+    binary_data[1] = (uint8_t)(humidity & 0xff);
     binary_data[2] = CRC8(binary_data, 2, SGP30_CRC8_POLY, SGP30_CRC8_INIT, SGP30_CRC8_XOR);
 
-    I2C_StartTransmission(SGP30_ADDR);
-    I2C_WriteCommand(2, Set_baseline);
-    I2C_WriteData(3, binary_data);
-    delay_ms(10);
-    I2C_Stop();
-    return SGP30_SUCCESS;
+    return s_Command(Set_humidity, binary_data, 3, NULL, 0, 10);
 }
 
 /**
  * \brief The command Measure_test which is included for integration and production line testing
  * runs an on-chip self-test.
- * \return SGP30_SUCCESS, SGP30_ERR_BAD_CRC
+ * \return SGP30_SUCCESS, SGP30_ERR_BAD_CRC, SGP30_ERR_I2C
  * \author siyuan xu, e2101066@edu.vamk.fi, Jan.2023
  * \details In case of a successful self-test the sensor returns the
  * fixed binary_data pattern 0xD400 (with correct CRC).
@@ -217,10 +248,9 @@ SGP30ERR sgp30_MeasureTest() {
     uint8_t crc = 0;
     uint8_t binary_data[3];
 
-    I2C_StartTransmission(SGP30_ADDR);
-    I2C_WriteCommand(2, Measure_test);
-    delay_ms(220);
-    I2C_Read(SGP30_ADDR, 3, binary_data);
+    if (SGP30_SUCCESS != s_Command(Measure_test, NULL, 0, binary_data, 3, 220)) {
+        return SGP30_ERR_I2C;
+    }
 
     // CRC check
     crc = CRC8(binary_data, 2, SGP30_CRC8_POLY, SGP30_CRC8_INIT, SGP30_CRC8_XOR);
@@ -235,7 +265,7 @@ SGP30ERR sgp30_MeasureTest() {
  * \brief The SGP30 features a versioning system for the available set of measurement commands and
  * on-chip algorithms.
  * \param[out] sgp_data - The memory address where the date would be stored, 3 bytes.
- * \return SGP30_SUCCESS, SGP30_ERR_BAD_CRC
+ * \return SGP30_SUCCESS, SGP30_ERR_BAD_CRC, SGP30_ERR_I2C
  * \author siyuan xu, e2101066@edu.vamk.fi, Jan.2023
  * \details The sensor responds with 2 data bytes (MSB first) and 1 CRC byte.
  */
@@ -243,10 +273,9 @@ SGP30ERR sgp30_GetFeatureSetVersion(sgp30_t *const sgp_data) {
     uint8_t crc = 0;
     uint8_t binary_data[3];
 
-    I2C_StartTransmission(SGP30_ADDR);
-    I2C_WriteCommand(2, Get_feature_set_version);
-    delay_ms(2);
-    I2C_Read(SGP30_ADDR, 3, binary_data);
+    if (SGP30_SUCCESS != s_Command(Get_feature_set_version, NULL, 0, binary_data, 3, 2)) {
+        return SGP30_ERR_I2C;
+    }
 
     // CRC check
     crc = CRC8(binary_data, 2, SGP30_CRC8_POLY, SGP30_CRC8_INIT, SGP30_CRC8_XOR);
@@ -263,7 +292,7 @@ SGP30ERR sgp30_GetFeatureSetVersion(sgp30_t *const sgp_data) {
  * \brief Returns the sensor raw signals which are used as inputs for the on-chip calibration and
  * baseline compensation algorithms.
  * \param[out] sgp_data - The memory address where the date would be stored, 6 bytes.
- * \return SGP30_SUCCESS, SGP30_ERR_BAD_CRC
+ * \return SGP30_SUCCESS, SGP30_ERR_BAD_CRC, SGP30_ERR_I2C
  * \author siyuan xu, e2101066@edu.vamk.fi, Jan.2023
  * \details The measurement to which the sensor responds with 2 data bytes (MSB first) and 1 CRC
  * byte. for 2 sensor raw signals in the order H2_signal (sout_H2) and Ethanol_signal (sout_EthOH).
@@ -272,10 +301,9 @@ SGP30ERR sgp30_MeasureRawSignals(sgp30_t *const sgp_data) {
     uint8_t crc_h2 = 0, crc_ethanol = 0;
     uint8_t binary_data[6];
 
-    I2C_StartTransmission(SGP30_ADDR);
-    I2C_WriteCommand(2, Measure_raw_signals);
-    delay_ms(25);
-    I2C_Read(SGP30_ADDR, 6, binary_data);
+    if (SGP30_SUCCESS != s_Command(Measure_raw_signals, NULL, 0, binary_data, 6, 25)) {
+        return SGP30_ERR_I2C;
+    }
 
     // CRC check
     crc_h2 = CRC8(binary_data, 2, SGP30_CRC8_POLY, SGP30_CRC8_INIT, SGP30_CRC8_XOR);
@@ -297,7 +325,7 @@ SGP30ERR sgp30_MeasureRawSignals(sgp30_t *const sgp_data) {
  * \brief The readout of the serial ID register can be used to identify the chip and verify the
  * presence of the sensor.
  * \param[out] sgp_data - The memory address where the date would be stored, 9 bytes.
- * \return SGP30_SUCCESS, SGP30_ERR_BAD_CRC
+ * \return SGP30_SUCCESS, SGP30_ERR_BAD_CRC, SGP30_ERR_I2C
  * \author siyuan xu, e2101066@edu.vamk.fi, Jan.2023
  * \details The get serial ID command returns 3 words, and every word is followed by an 8-bit CRC
  * checksum. Together the 3 words constitute a unique serial ID with a length of 48 bits. The ID
@@ -307,10 +335,9 @@ SGP30ERR sgp30_GetSerialId(sgp30_t *const sgp_data) {
     uint8_t crc = 0;
     uint8_t binary_data[9];
 
-    I2C_StartTransmission(SGP30_ADDR);
-    I2C_WriteCommand(2, Get_seiral_id);
-    delay_ms(5);
-    I2C_Read(SGP30_ADDR, 9, binary_data);
+    if (SGP30_SUCCESS != s_Command(Get_seiral_id, NULL, 0, binary_data, 9, 5)) {
+        return SGP30_ERR_I2C;
+    }
 
     // CRC check
     crc = CRC8(binary_data, 2, SGP30_CRC8_POLY, SGP30_CRC8_INIT, SGP30_CRC8_XOR);
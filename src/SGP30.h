@@ -2,10 +2,16 @@
 #define SGP30_H
 #include <stdint.h>
 /* SGP30 I2C addresses */
-#define SGP30_ADDR (uint8_t)0x58
+#define SGP30_ADDR              (uint8_t)0x58
+#define SGP30_GENERAL_CALL_ADDR (uint8_t)0x00
+
+/* SGP30 bus manager settings, see i2c_bus.h */
+#define SGP30_I2C_PRIORITY   1U   // I2C_BUS_PRIORITY_HIGH is left for time critical sensors
+#define SGP30_I2C_TIMEOUT_MS 20U  // margin over the command execution time
 
 /* SGP30 command addresses */
-#define I2C_RESET_COMMAND (uint8_t)0x06
+#define I2C_RESET_COMMAND        (uint8_t)0x06  // second byte of the general call reset
+#define SGP30_SOFT_RESET_TIME_MS 1U             // 0.6ms power-up time after the reset
 
 /* SGP30 default values*/
 #define MEASURE_TEST_OK (uint16_t)0xd400
@@ -24,7 +30,8 @@ typedef enum {
     SGP30_ERR_BAD_CRC,
     SGP30_SELF_TEST_FAIL,
     SGP30_BAD_HUMIDITY,
-    SGP30_BAD_BASELINE
+    SGP30_BAD_BASELINE,
+    SGP30_ERR_I2C  // NACK, bus error or timeout, see I2C_BUS_STATUS
 } SGP30ERR;
 
 typedef struct sgp30_type sgp30_t;
@@ -43,10 +50,11 @@ struct sgp30_type {
 /* SGP30 function prototypes */
 sgp30_t  sgp30_create(void);
 SGP30ERR sgp30_InitAirQuality(void);
+SGP30ERR sgp30_SoftReset(void);
 SGP30ERR sgp30_MeasureAirQuality(sgp30_t *const sgp_data);
 SGP30ERR spg30_GetBaseLine(sgp30_t *const sgp_data);
 SGP30ERR sgp30_SetBaseline(const uint16_t baseline_eco2, const uint16_t baseline_tvoc);
-SGP30ERR spg30_SetAbsoluteHumidity(const double humidity);
+SGP30ERR sgp30_SetAbsoluteHumidity(const uint16_t humidity);
 SGP30ERR sgp30_MeasureTest(void);
 SGP30ERR sgp30_GetFeatureSetVersion(sgp30_t *const sgp_data);
 SGP30ERR sgp30_MeasureRawSignals(sgp30_t *const sgp_data);
@@ -0,0 +1,94 @@
+/*
+ * alarm.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+#include "alarm.h"
+
+#if defined(STM32L152xE)
+#include "stm32l1xx.h"
+#endif
+
+alarm_t alarm_data;
+
+/**
+ * \brief Threshold with hysteresis
+ * \param[in] state - The alarm state before the measurement
+ * \param[in] value - The measurement
+ * \param[in] high - The threshold, 0 disables the alarm
+ * \param[in] hyst - The hysteresis below the threshold
+ * \return The new alarm state, 0 or 1
+ * \author agent, agent@local, Oct.2026
+ */
+static uint8_t s_Threshold(const uint8_t state, const uint16_t value, const uint16_t high,
+                           const uint16_t hyst) {
+    if (high == 0) {
+        return 0;
+    } else if (value >= high) {
+        return 1;
+    } else if ((uint32_t)value + hyst < high) {
+        return 0;
+    }
+    return state;
+}
+
+/**
+ * \brief Set the default thresholds and configure the relay output, PA8/D7
+ * \author agent, agent@local, Oct.2026
+ */
+void alarm_Init(void) {
+    alarm_data.co2High   = ALARM_CO2_HIGH;
+    alarm_data.co2Hyst   = ALARM_CO2_HYST;
+    alarm_data.tvocHigh  = ALARM_TVOC_HIGH;
+    alarm_data.tvocHyst  = ALARM_TVOC_HYST;
+    alarm_data.co2       = 0;
+    alarm_data.tvoc      = 0;
+    alarm_data.relay     = 0;
+    alarm_data.relayAuto = 0;
+    alarm_data.ledAlarm  = 0;
+    alarm_data.relayOut  = 0;
+#if defined(STM32L152xE)
+    RCC->AHBENR  |= RCC_AHBENR_GPIOAEN;
+    GPIOA->ODR   &= ~GPIO_ODR_ODR_8;  // relay off
+    GPIOA->MODER = (GPIOA->MODER & ~GPIO_MODER_MODER8) | (0x01 << GPIO_MODER_MODER8_Pos);
+#endif
+}
+
+/**
+ * \brief Evaluate the alarms after a measurement and update the relay
+ * \param[in] valid - 0 when the measurement failed, the alarm states are then kept
+ * \param[in] co2 - CO2eq in ppm
+ * \param[in] tvoc - TVOC in ppb
+ * \author agent, agent@local, Oct.2026
+ */
+void alarm_Update(const int32_t valid, const uint16_t co2, const uint16_t tvoc) {
+    if (valid) {
+        alarm_data.co2 = s_Threshold(alarm_data.co2, co2, alarm_data.co2High, alarm_data.co2Hyst);
+        alarm_data.tvoc =
+            s_Threshold(alarm_data.tvoc, tvoc, alarm_data.tvocHigh, alarm_data.tvocHyst);
+    }
+    alarm_Output();
+}
+
+/**
+ * \brief Drive the relay from the coils and the alarm states, also called after a coil write
+ * \author agent, agent@local, Oct.2026
+ */
+void alarm_Output(void) {
+    alarm_data.relayOut = alarm_data.relayAuto ? (uint8_t)alarm_Active() : (alarm_data.relay != 0);
+#if defined(STM32L152xE)
+    if (alarm_data.relayOut) {
+        GPIOA->BSRR = GPIO_BSRR_BS_8;
+    } else {
+        GPIOA->BSRR = GPIO_BSRR_BR_8;
+    }
+#endif
+}
+
+/**
+ * \brief Any alarm raised
+ * \return 1 when the CO2eq or TVOC alarm is raised, 0 when not
+ * \author agent, agent@local, Oct.2026
+ */
+int32_t alarm_Active(void) { return (alarm_data.co2 || alarm_data.tvoc) ? 1 : 0; }
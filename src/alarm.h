@@ -0,0 +1,46 @@
+/*
+ * alarm.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef ALARM_H_
+#define ALARM_H_
+
+#include <stdint.h>
+
+/*
+ * CO2eq/TVOC alarms evaluated after each measurement. An alarm is raised when the value reaches
+ * its threshold and cleared when it falls below threshold - hysteresis, a threshold of 0 disables
+ * the alarm. The alarm states are kept while the measurement is invalid.
+ *
+ * The relay on PA8/D7 follows the RELAY coil, or any alarm when the RELAY_AUTO coil is set. With
+ * the LED_ALARM coil set the user LED is on during an alarm instead of blinking.
+ */
+#define ALARM_CO2_HIGH  1500U  // ppm, default CO2eq threshold
+#define ALARM_CO2_HYST  100U   // ppm
+#define ALARM_TVOC_HIGH 660U   // ppb, default TVOC threshold
+#define ALARM_TVOC_HYST 60U    // ppb
+
+typedef struct alarm_type {
+    uint16_t co2High;    // ppm, written by the Modbus master
+    uint16_t co2Hyst;    // ppm, written by the Modbus master
+    uint16_t tvocHigh;   // ppb, written by the Modbus master
+    uint16_t tvocHyst;   // ppb, written by the Modbus master
+    uint8_t  co2;        // CO2eq alarm state, discrete input
+    uint8_t  tvoc;       // TVOC alarm state, discrete input
+    uint8_t  relay;      // coil, relay state when not in auto mode
+    uint8_t  relayAuto;  // coil, the relay follows the alarms
+    uint8_t  ledAlarm;   // coil, the LED shows the alarms
+    uint8_t  relayOut;   // relay output, discrete input
+} alarm_t;
+
+extern alarm_t alarm_data;
+
+void    alarm_Init(void);
+void    alarm_Update(const int32_t valid, const uint16_t co2, const uint16_t tvoc);
+void    alarm_Output(void);
+int32_t alarm_Active(void);
+
+#endif /* ALARM_H_ */
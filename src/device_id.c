@@ -0,0 +1,207 @@
+/*
+ * device_id.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+#include "device_id.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include "modbus_map.h"
+#include "modbus_rtu.h"
+#include "sgp30.h"
+#include "version.h"
+
+#define DEVICE_ID_VALUE_MAX 32U  // longest object value
+#define DEVICE_ID_HEADER    6U   // MEI type, code, conformity, more follows, next ID, count
+
+static const uint8_t s_objects[] = {
+    DEVICE_ID_OBJ_VENDOR_NAME, DEVICE_ID_OBJ_PRODUCT_CODE, DEVICE_ID_OBJ_REVISION,
+    DEVICE_ID_OBJ_VENDOR_URL,  DEVICE_ID_OBJ_PRODUCT_NAME, DEVICE_ID_OBJ_MODEL_NAME,
+    DEVICE_ID_OBJ_BUILD_HASH,  DEVICE_ID_OBJ_SERIAL_ID,    DEVICE_ID_OBJ_FEATURE_SET};
+
+/**
+ * \brief Write the lowest digits of a value as upper case ASCII hex, MSB first
+ * \param[in] value - The value
+ * \param[in] digits - The number of hex digits
+ * \param[out] text - digits characters, not terminated
+ * \return digits
+ * \author agent, agent@local, Oct.2026
+ */
+static uint8_t s_Hex(const uint64_t value, const uint8_t digits, char *const text) {
+    static const char hex[] = "0123456789ABCDEF";
+    for (uint8_t n = 0; n < digits; n++) {
+        text[n] = hex[(value >> (4 * (digits - 1 - n))) & 0x0f];
+    }
+    return digits;
+}
+
+/**
+ * \brief Copy a string constant without its terminator
+ * \param[in] string - The string
+ * \param[out] text - The characters
+ * \return The number of characters
+ * \author agent, agent@local, Oct.2026
+ */
+static uint8_t s_Text(const char *const string, char *const text) {
+    size_t len = strlen(string);
+    memcpy(text, string, len);
+    return (uint8_t)len;
+}
+
+/**
+ * \brief The value of a device identification object
+ * \param[in] id - DEVICE_ID_OBJ
+ * \param[in] sgp - SGP30 data with the serial ID and feature set
+ * \param[out] value - DEVICE_ID_VALUE_MAX bytes, not terminated
+ * \return The number of bytes, -1 when the object does not exist
+ * \author agent, agent@local, Oct.2026
+ */
+static int32_t s_Object(const uint8_t id, const sgp30_t *const sgp, char *const value) {
+    switch (id) {
+        case DEVICE_ID_OBJ_VENDOR_NAME:
+            return s_Text(FW_VENDOR_NAME, value);
+        case DEVICE_ID_OBJ_PRODUCT_CODE:
+            return s_Text(FW_PRODUCT_CODE, value);
+        case DEVICE_ID_OBJ_REVISION:
+            return s_Text(FW_VERSION_STRING, value);
+        case DEVICE_ID_OBJ_VENDOR_URL:
+            return s_Text(FW_VENDOR_URL, value);
+        case DEVICE_ID_OBJ_PRODUCT_NAME:
+            return s_Text(FW_PRODUCT_NAME, value);
+        case DEVICE_ID_OBJ_MODEL_NAME:
+            return s_Text(FW_MODEL_NAME, value);
+        case DEVICE_ID_OBJ_BUILD_HASH:
+            return s_Hex(FW_BUILD_HASH, 8, value);
+        case DEVICE_ID_OBJ_SERIAL_ID:
+            return s_Hex(sgp->serialID, 12, value);
+        case DEVICE_ID_OBJ_FEATURE_SET:
+            return s_Hex(sgp->featureSetVersion, 4, value);
+        default:
+            return -1;
+    }
+}
+
+/**
+ * \brief Local implementation of Report Slave ID (FC 0x11), see device_id.h for the data
+ * \param[in] modbus_rtu_frame - Address + Function code + CRC
+ * \param[in] data - sgp30_t with the serial ID and feature set
+ * \param[out] reply_data - The data following the byte count
+ * \param[out] reply_data_len - The number of bytes in reply_data
+ * \return MODBUS_RTU_SUCCESS
+ * \author agent, agent@local, Oct.2026
+ */
+MODBUS_RTU_ERR modbusRtu_TryReportSlaveId(const uint8_t *const modbus_rtu_frame, void *data,
+                                          uint8_t *reply_data, uint8_t *reply_data_len) {
+    (void)modbus_rtu_frame;
+    const sgp30_t *sgp    = (const sgp30_t *)data;
+    uint8_t        index  = 0;
+    uint32_t       hash   = (uint32_t)FW_BUILD_HASH;
+    uint64_t       serial = (rFlag & RFLAG_SERIAL_ID) ? sgp->serialID : 0;
+    uint16_t       fs     = (rFlag & RFLAG_FEATURE_SET) ? sgp->featureSetVersion : 0;
+
+    reply_data[index++] = DEVICE_ID_SLAVE_ID;
+    reply_data[index++] = (rFlag & RFLAG_SERIAL_ID) ? DEVICE_ID_RUN_ON : DEVICE_ID_RUN_OFF;
+    reply_data[index++] = FW_VERSION_MAJOR;
+    reply_data[index++] = FW_VERSION_MINOR;
+    reply_data[index++] = FW_VERSION_PATCH;
+    for (int8_t shift = 24; shift >= 0; shift -= 8) {
+        reply_data[index++] = (uint8_t)(hash >> shift);
+    }
+    for (int8_t shift = 40; shift >= 0; shift -= 8) {
+        reply_data[index++] = (uint8_t)(serial >> shift);
+    }
+    reply_data[index++] = (uint8_t)(fs >> 8);
+    reply_data[index++] = (uint8_t)(fs & 0xff);
+    index += s_Text(FW_VENDOR_NAME, (char *)&reply_data[index]);
+    *reply_data_len = index;
+    return MODBUS_RTU_SUCCESS;
+}
+
+/**
+ * \brief Local implementation of Read Device Identification (FC 0x2B, MEI type 0x0E)
+ * \details Stream access returns the objects of the category from the requested object ID on,
+ * an unknown start ID restarts at object 0. Objects that do not fit the reply are left for the
+ * next request, announced by DEVICE_ID_MORE and the next object ID.
+ * \param[in] modbus_rtu_frame - Address + Function code + MEI type + Code + Object ID + CRC
+ * \param[in] data - sgp30_t with the serial ID and feature set
+ * \param[out] reply_data - The PDU data following the function code
+ * \param[out] reply_data_len - The number of bytes in reply_data
+ * \return MODBUS_RTU_SUCCESS, MODBUS_RTU_ERR_BAD_FUNCTION_CODE for another MEI type,
+ * MODBUS_RTU_ERR_BAD_QUANTITY for a bad code, MODBUS_RTU_ERR_BAD_REGISTER_ADDR for an unknown
+ * object in individual access
+ * \author agent, agent@local, Oct.2026
+ */
+MODBUS_RTU_ERR modbusRtu_TryReadDeviceId(const uint8_t *const modbus_rtu_frame, void *data,
+                                         uint8_t *reply_data, uint8_t *reply_data_len) {
+    const sgp30_t *sgp  = (const sgp30_t *)data;
+    uint8_t        code = modbus_rtu_frame[MEI_READ_DEVICE_ID_CODE];
+    uint8_t        id   = modbus_rtu_frame[MEI_OBJECT_ID];
+    uint8_t        last;
+    uint8_t        first = 0;
+    uint8_t        index = DEVICE_ID_HEADER;
+    char           value[DEVICE_ID_VALUE_MAX];
+    int32_t        len;
+
+    if (modbus_rtu_frame[MEI_TYPE] != DEVICE_ID_MEI_TYPE) {
+        return MODBUS_RTU_ERR_BAD_FUNCTION_CODE;
+    }
+    switch (code) {
+        case DEVICE_ID_CODE_BASIC:
+            last = DEVICE_ID_OBJ_REVISION;
+            break;
+        case DEVICE_ID_CODE_REGULAR:
+            last = 0x7F;
+            break;
+        case DEVICE_ID_CODE_EXTENDED:
+        case DEVICE_ID_CODE_SPECIFIC:
+            last = 0xFF;
+            break;
+        default:
+            return MODBUS_RTU_ERR_BAD_QUANTITY;
+    }
+
+    reply_data[0] = DEVICE_ID_MEI_TYPE;
+    reply_data[1] = code;
+    reply_data[2] = DEVICE_ID_CONFORMITY;
+    reply_data[3] = 0;  // more follows
+    reply_data[4] = 0;  // next object ID
+    reply_data[5] = 0;  // number of objects
+
+    if (code == DEVICE_ID_CODE_SPECIFIC) {
+        len = s_Object(id, sgp, value);
+        if (len < 0) {
+            return MODBUS_RTU_ERR_BAD_REGISTER_ADDR;
+        }
+        reply_data[index++] = id;
+        reply_data[index++] = (uint8_t)len;
+        memcpy(&reply_data[index], value, (size_t)len);
+        index          += (uint8_t)len;
+        reply_data[5]   = 1;
+        *reply_data_len = index;
+        return MODBUS_RTU_SUCCESS;
+    }
+
+    for (uint8_t n = 0; n < sizeof(s_objects); n++) {
+        if ((s_objects[n] == id) && (id <= last)) {
+            first = n;
+        }
+    }
+    for (uint8_t n = first; (n < sizeof(s_objects)) && (s_objects[n] <= last); n++) {
+        len = s_Object(s_objects[n], sgp, value);
+        if ((size_t)index + 2 + (size_t)len > MODBUS_REPLY_DATA_MAX) {
+            reply_data[3] = DEVICE_ID_MORE;
+            reply_data[4] = s_objects[n];
+            break;
+        }
+        reply_data[index++] = s_objects[n];
+        reply_data[index++] = (uint8_t)len;
+        memcpy(&reply_data[index], value, (size_t)len);
+        index += (uint8_t)len;
+        reply_data[5]++;
+    }
+    *reply_data_len = index;
+    return MODBUS_RTU_SUCCESS;
+}
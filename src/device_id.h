@@ -0,0 +1,51 @@
+/*
+ * device_id.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef DEVICE_ID_H_
+#define DEVICE_ID_H_
+
+#include <stdint.h>
+
+/*
+ * Node identification for asset scans, one transaction per node.
+ *
+ * FC 0x11 Report Slave ID, data after the byte count:
+ *   slave ID (1), run indicator (1), firmware major, minor, patch (3), build hash (4),
+ *   SGP30 serial ID (6), SGP30 feature set (2), vendor name (ASCII, rest of the frame)
+ *   Multi-byte fields are MSB first. The run indicator is DEVICE_ID_RUN_ON once the SGP30 serial
+ *   ID has been read, the sensor fields are 0 until then.
+ *
+ * FC 0x2B/0x0E Read Device Identification, objects DEVICE_ID_OBJ_*. The extended objects are
+ * ASCII hex, so a generic scanner can show them without knowing this device.
+ */
+#define DEVICE_ID_SLAVE_ID   (uint8_t)0x30  // SGP30 air quality node
+#define DEVICE_ID_RUN_ON     (uint8_t)0xFF
+#define DEVICE_ID_RUN_OFF    (uint8_t)0x00
+#define DEVICE_ID_MEI_TYPE   (uint8_t)0x0E
+#define DEVICE_ID_CONFORMITY (uint8_t)0x83  // extended, stream and individual access
+#define DEVICE_ID_MORE       (uint8_t)0xFF  // more follows, read again from the next object ID
+
+typedef enum {
+    DEVICE_ID_CODE_BASIC = 1,  // stream access, objects 0x00...0x02
+    DEVICE_ID_CODE_REGULAR,    // stream access, objects 0x00...0x7F
+    DEVICE_ID_CODE_EXTENDED,   // stream access, objects 0x00...0xFF
+    DEVICE_ID_CODE_SPECIFIC    // individual access, one object
+} DEVICE_ID_CODE;
+
+typedef enum {
+    DEVICE_ID_OBJ_VENDOR_NAME = 0x00,
+    DEVICE_ID_OBJ_PRODUCT_CODE,
+    DEVICE_ID_OBJ_REVISION,
+    DEVICE_ID_OBJ_VENDOR_URL,
+    DEVICE_ID_OBJ_PRODUCT_NAME,
+    DEVICE_ID_OBJ_MODEL_NAME,
+    DEVICE_ID_OBJ_BUILD_HASH = 0x80,  // 8 hex digits
+    DEVICE_ID_OBJ_SERIAL_ID,          // 12 hex digits, SGP30 serial ID
+    DEVICE_ID_OBJ_FEATURE_SET         // 4 hex digits, SGP30 feature set version
+} DEVICE_ID_OBJ;
+
+#endif /* DEVICE_ID_H_ */
@@ -0,0 +1,174 @@
+/*
+ * dht22.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+#include "dht22.h"
+
+#if defined(STM32L152xE)
+#include "stm32l1xx.h"
+#include "usart_config.h"
+#include "utils.h"
+#endif
+
+#define DHT22_BITS      40U
+#define DHT22_TEMP_MIN  (-400)  // 0.1 degC
+#define DHT22_TEMP_MAX  800
+#define DHT22_RH_MAX    1000U  // 0.1 %RH
+#define DHT22_SIGN_MASK 0x8000U
+
+dht22_t dht_data = {0, 0, 0, DHT22_ERR_NO_RESPONSE};
+
+#if defined(STM32L152xE)
+static uint16_t s_edges[DHT22_EDGES_MAX];  // TIM4 capture values of the falling edges, us
+static uint8_t  s_armed = 0;                // a capture was started by dht22_Start
+
+/* Private functions */
+static inline void s_PinOutputLow(void) {
+    GPIOB->ODR   &= ~GPIO_ODR_ODR_6;
+    GPIOB->MODER = (GPIOB->MODER & ~GPIO_MODER_MODER6) | (0x01 << GPIO_MODER_MODER6_Pos);
+}
+
+static inline void s_PinCapture(void) {
+    GPIOB->MODER = (GPIOB->MODER & ~GPIO_MODER_MODER6) | (0x02 << GPIO_MODER_MODER6_Pos);
+}
+
+static inline void s_CaptureStop(void) {
+    TIM4->CR1          &= ~TIM_CR1_CEN;
+    DMA1_Channel1->CCR &= ~DMA_CCR_EN;
+}
+#endif
+
+/* Public functions */
+/**
+ * \brief Decode one DHT22 transfer from the time stamps of its falling edges. Leading glitches
+ * are skipped until the 160us response is found.
+ * \param[in] edges - Falling edge time stamps in us, 16-bit timer values (wrap-around allowed)
+ * \param[in] n - Number of time stamps
+ * \param[out] out - temperature and rh, only written when success
+ * \return DHT22_SUCCESS, DHT22_ERR_NO_RESPONSE, DHT22_ERR_TIMING, DHT22_ERR_CHECKSUM,
+ * DHT22_ERR_RANGE
+ * \author agent, agent@local, Oct.2026
+ */
+DHT22ERR dht22_Decode(const uint16_t *const edges, const size_t n, dht22_t *const out) {
+    uint8_t  data[DHT22_BITS / 8] = {0};
+    size_t   start                = 0;
+    uint16_t period;
+
+    // The response is the first period of 140...200us
+    while (start + 1 < n) {
+        period = (uint16_t)(edges[start + 1] - edges[start]);
+        if ((period >= DHT22_RESPONSE_MIN) && (period <= DHT22_RESPONSE_MAX)) {
+            break;
+        }
+        start++;
+    }
+    if (start + 1 >= n) {
+        return DHT22_ERR_NO_RESPONSE;
+    }
+    if (start + 1 + DHT22_BITS >= n) {
+        return DHT22_ERR_TIMING;  // transfer cut short
+    }
+
+    for (size_t bit = 0; bit < DHT22_BITS; bit++) {
+        period = (uint16_t)(edges[start + 2 + bit] - edges[start + 1 + bit]);
+        if ((period < DHT22_BIT_PERIOD_MIN) || (period > DHT22_BIT_PERIOD_MAX)) {
+            return DHT22_ERR_TIMING;
+        }
+        data[bit / 8] <<= 1;
+        if (period > DHT22_BIT_THRESHOLD) {
+            data[bit / 8] |= 0x01;
+        }
+    }
+
+    if ((uint8_t)(data[0] + data[1] + data[2] + data[3]) != data[4]) {
+        return DHT22_ERR_CHECKSUM;
+    }
+
+    uint16_t rh          = ((uint16_t)data[0] << 8) | data[1];
+    uint16_t raw         = ((uint16_t)data[2] << 8) | data[3];
+    int16_t  temperature = (int16_t)(raw & ~DHT22_SIGN_MASK);
+    if (raw & DHT22_SIGN_MASK) {
+        temperature = -temperature;
+    }
+    if ((rh > DHT22_RH_MAX) || (temperature < DHT22_TEMP_MIN) || (temperature > DHT22_TEMP_MAX)) {
+        return DHT22_ERR_RANGE;
+    }
+    out->rh          = rh;
+    out->temperature = temperature;
+    return DHT22_SUCCESS;
+}
+
+#if defined(STM32L152xE)
+/**
+ * \brief Initialize PB6 (open-drain, pull-up), TIM4_CH1 input capture at 1MHz on falling edges
+ * and DMA1_Channel1 for the capture values. The line is left released (high).
+ * \author agent, agent@local, Oct.2026
+ */
+void dht22_Init(void) {
+    RCC->AHBENR  |= RCC_AHBENR_GPIOBEN | RCC_AHBENR_DMA1EN;
+    RCC->APB1ENR |= RCC_APB1ENR_TIM4EN;
+
+    GPIOB->AFR[0] = (GPIOB->AFR[0] & ~GPIO_AFRL_AFRL6) | (0x02 << GPIO_AFRL_AFRL6_Pos);  // AF2
+    GPIOB->OTYPER |= GPIO_OTYPER_OT_6;  // open-drain, the sensor drives the line low
+    GPIOB->PUPDR  = (GPIOB->PUPDR & ~GPIO_PUPDR_PUPDR6) | (0x01 << GPIO_PUPDR_PUPDR6_Pos);
+    GPIOB->ODR    |= GPIO_ODR_ODR_6;
+    s_PinCapture();
+
+    TIM4->PSC   = (F_CPU / 1000000U) - 1U;  // 1MHz, 1 tick = 1us
+    TIM4->ARR   = 0xFFFF;
+    TIM4->CCMR1 = (0x01 << TIM_CCMR1_CC1S_Pos) |  // CC1 input, IC1 mapped on TI1
+                  (0x03 << TIM_CCMR1_IC1F_Pos);   // filter fCK_INT N=8, 0.25us
+    TIM4->CCER  = TIM_CCER_CC1P | TIM_CCER_CC1E;  // capture falling edges
+    TIM4->DIER  = TIM_DIER_CC1DE;                 // DMA request on capture
+
+    DMA1_Channel1->CCR  = DMA_CCR_PSIZE_0 |  // 16-bit peripheral, TIM4_CCR1
+                          DMA_CCR_MSIZE_0 |  // 16-bit memory
+                          DMA_CCR_MINC;      // peripheral to memory, normal mode
+    DMA1_Channel1->CPAR = (uint32_t) & (TIM4->CCR1);
+    DMA1_Channel1->CMAR = (uint32_t)s_edges;
+}
+
+/**
+ * \brief Send the start signal and arm the capture. Blocks for the DHT22_START_US start signal
+ * only, the transfer itself is captured in the background. Read the result with dht22_Read after
+ * at least 5ms.
+ * \author agent, agent@local, Oct.2026
+ */
+void dht22_Start(void) {
+    s_CaptureStop();
+    DMA1->IFCR           = DMA_IFCR_CGIF1;
+    DMA1_Channel1->CNDTR = DHT22_EDGES_MAX;
+    DMA1_Channel1->CCR   |= DMA_CCR_EN;
+    TIM4->SR             = 0;  // drop a stale capture
+
+    s_PinOutputLow();
+    delay_us(DHT22_START_US);
+    TIM4->CNT = 0;
+    TIM4->CR1 |= TIM_CR1_CEN;
+    s_PinCapture();  // release the line, the pull-up takes it high
+    s_armed = 1;
+}
+
+/**
+ * \brief Stop the capture started by dht22_Start and decode it
+ * \param[out] out - The reading, the error counters are updated on failure
+ * \return See dht22_Decode
+ * \author agent, agent@local, Oct.2026
+ */
+DHT22ERR dht22_Read(dht22_t *const out) {
+    if (!s_armed) {
+        return DHT22_ERR_NO_RESPONSE;  // nothing started, not counted as an error
+    }
+    s_CaptureStop();
+    s_armed = 0;
+    size_t   n   = DHT22_EDGES_MAX - DMA1_Channel1->CNDTR;
+    DHT22ERR err = dht22_Decode(s_edges, n, out);
+    out->lastError = (uint16_t)err;
+    if (DHT22_SUCCESS != err) {
+        out->errors++;
+    }
+    return err;
+}
+#endif
@@ -0,0 +1,56 @@
+/*
+ * dht22.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef DHT22_H_
+#define DHT22_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * DHT22 (AM2302) single-wire temperature/humidity sensor on PB6/D10.
+ *
+ * The host pulls the line low for about 1ms, then the sensor answers with 80us low + 80us high
+ * and 40 bits, each 50us low followed by 26-28us high (0) or 70us high (1), MSB first:
+ * RH[15:0], T[15:0] (bit 15 = sign), checksum = low byte of the sum of the first 4 bytes.
+ *
+ * TIM4_CH1 captures the falling edges at 1MHz and DMA1_Channel1 stores the capture values, so the
+ * CPU is not involved in the 5ms transfer. The time between two falling edges is the response
+ * (160us) followed by one period per bit, 76-78us for 0 and about 120us for 1.
+ */
+#define DHT22_PERIOD_S       2U     // minimum sampling period of the sensor
+#define DHT22_START_US       1100U  // host start signal, 0.8...20ms
+#define DHT22_EDGES_MAX      48U    // 42 falling edges expected, with margin for glitches
+#define DHT22_RESPONSE_MIN   140U   // us, 80us low + 80us high
+#define DHT22_RESPONSE_MAX   200U
+#define DHT22_BIT_PERIOD_MIN 60U    // us, 50us low + 26us high
+#define DHT22_BIT_PERIOD_MAX 150U   // us, 50us low + 70us high
+#define DHT22_BIT_THRESHOLD  100U   // us, longer period is a 1
+
+typedef enum {
+    DHT22_SUCCESS = 0,
+    DHT22_ERR_NO_RESPONSE,
+    DHT22_ERR_TIMING,
+    DHT22_ERR_CHECKSUM,
+    DHT22_ERR_RANGE
+} DHT22ERR;
+
+typedef struct dht22_type {
+    int16_t  temperature;  // 0.1 degC
+    uint16_t rh;           // 0.1 %RH
+    uint16_t errors;       // failed readings since power-on
+    uint16_t lastError;    // DHT22ERR of the last reading
+} dht22_t;
+
+extern dht22_t dht_data;
+
+DHT22ERR dht22_Decode(const uint16_t *const edges, const size_t n, dht22_t *const out);
+void     dht22_Init(void);
+void     dht22_Start(void);
+DHT22ERR dht22_Read(dht22_t *const out);
+
+#endif /* DHT22_H_ */
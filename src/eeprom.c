@@ -0,0 +1,78 @@
+/*
+ * eeprom.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+#include "eeprom.h"
+
+#include "stm32l1xx.h"
+
+#define EEPROM_PEKEY1 0x89ABCDEFU
+#define EEPROM_PEKEY2 0x02030405U
+#define EEPROM_SR_ERRORS \
+    (FLASH_SR_WRPERR | FLASH_SR_PGAERR | FLASH_SR_SIZERR | FLASH_SR_OPTVERR)
+
+/* Private functions */
+static inline void s_Unlock(void) {
+    if (FLASH->PECR & FLASH_PECR_PELOCK) {
+        FLASH->PEKEYR = EEPROM_PEKEY1;
+        FLASH->PEKEYR = EEPROM_PEKEY2;
+    }
+}
+
+static inline void s_Lock(void) { FLASH->PECR |= FLASH_PECR_PELOCK; }
+
+/* Public functions */
+/**
+ * \brief Clear stale error flags of the data EEPROM. The EEPROM is kept locked between writes.
+ * \author agent, agent@local, Oct.2026
+ */
+void eeprom_Init(void) {
+    FLASH->SR = EEPROM_SR_ERRORS;  // rc_w1
+    s_Lock();
+}
+
+/**
+ * \brief Read one word of the data EEPROM
+ * \param[in] offset - Byte offset from FLASH_EEPROM_BASE, word aligned
+ * \return The word, 0 when the offset is out of range
+ * \author agent, agent@local, Oct.2026
+ */
+uint32_t eeprom_ReadWord(const uint32_t offset) {
+    if ((offset >= EEPROM_SIZE) || (offset & 0x03U)) {
+        return 0;
+    }
+    return *(volatile const uint32_t *)(FLASH_EEPROM_BASE + offset);
+}
+
+/**
+ * \brief Write one word of the data EEPROM. Blocks for up to 2 x 3.2ms (erase + program), an
+ * unchanged word is not rewritten to save endurance.
+ * \param[in] offset - Byte offset from FLASH_EEPROM_BASE, word aligned
+ * \param[in] value - The word to write
+ * \return 0 when success, -1 when the offset is invalid or programming failed
+ * \author agent, agent@local, Oct.2026
+ */
+int32_t eeprom_WriteWord(const uint32_t offset, const uint32_t value) {
+    volatile uint32_t *const word = (volatile uint32_t *)(FLASH_EEPROM_BASE + offset);
+    int32_t                  ret  = 0;
+
+    if ((offset >= EEPROM_SIZE) || (offset & 0x03U)) {
+        return -1;
+    }
+    if (*word == value) {
+        return 0;
+    }
+
+    s_Unlock();
+    *word = value;
+    while (FLASH->SR & FLASH_SR_BSY) {
+    }
+    if (FLASH->SR & EEPROM_SR_ERRORS) {
+        FLASH->SR = EEPROM_SR_ERRORS;
+        ret       = -1;
+    }
+    s_Lock();
+    return ret;
+}
@@ -0,0 +1,24 @@
+/*
+ * eeprom.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef EEPROM_H_
+#define EEPROM_H_
+
+#include <stdint.h>
+
+/* Data EEPROM layout, offsets from FLASH_EEPROM_BASE in bytes, word aligned */
+#define EEPROM_SIZE           0x4000U  // 16KB data EEPROM of STM32L152RE
+#define EEPROM_HISTORY_OFFSET 0x0000U  // history spill ring, see history.h
+#define EEPROM_HISTORY_SIZE   0x2000U
+#define EEPROM_SGP30_OFFSET   0x2000U  // SGP30 baseline record, see supervisor.h
+#define EEPROM_SGP30_SIZE     0x0010U
+
+void     eeprom_Init(void);
+uint32_t eeprom_ReadWord(const uint32_t offset);
+int32_t  eeprom_WriteWord(const uint32_t offset, const uint32_t value);
+
+#endif /* EEPROM_H_ */
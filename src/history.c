@@ -0,0 +1,230 @@
+/*
+ * history.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+#include "history.h"
+
+#if defined(STM32L152xE)
+#include "stm32l1xx.h"
+#define HISTORY_CRITICAL_BEGIN() __disable_irq()
+#define HISTORY_CRITICAL_END()   __enable_irq()
+#else
+#define HISTORY_CRITICAL_BEGIN()
+#define HISTORY_CRITICAL_END()
+#endif
+
+#if (HISTORY_EEPROM_EN > 0u)
+#define HISTORY_READABLE_MAX (HISTORY_EEPROM_DEPTH - 1U)
+#else
+#define HISTORY_READABLE_MAX (HISTORY_DEPTH - 1U)
+#endif
+
+// The sequence numbers wrap at 65536, the ring slots must wrap at the same time
+_Static_assert((65536U % HISTORY_DEPTH) == 0, "HISTORY_DEPTH must divide 65536");
+_Static_assert((65536U % HISTORY_EEPROM_DEPTH) == 0, "HISTORY_EEPROM_DEPTH must divide 65536");
+_Static_assert((65536U % HISTORY_STORE_BLOCKS) == 0, "HISTORY_STORE_BLOCKS must divide 65536");
+// A block is encoded straight from the ring, it must not wrap around the ring end
+_Static_assert((HISTORY_DEPTH % HISTORY_BLOCK_RECORDS) == 0, "block must not wrap the ring");
+_Static_assert(HISTORY_BLOCK_RECORDS <= HISTORY_CODEC_RECORDS_MAX, "block too long");
+_Static_assert(HISTORY_STORE_SIZE <= 0x10000U, "store offsets are 16-bit");
+
+typedef struct history_block_entry_type {
+    uint16_t offset;  // first byte in s_store
+    uint16_t length;  // bytes, 0 when empty
+} history_block_entry_t;
+
+history_t hist_data;
+
+static uint8_t               s_store[HISTORY_STORE_SIZE];  // compressed blocks, byte ring
+static history_block_entry_t s_blockIndex[HISTORY_STORE_BLOCKS];
+static uint8_t               s_blockBuf[HISTORY_BLOCK_SIZE];
+static uint16_t              s_storeHead;  // next free byte in s_store
+static uint32_t              s_storeUsed;  // bytes of the readable blocks
+
+/* Private functions */
+static void s_StoreBlock(const uint8_t *const block, const uint16_t length) {
+    history_block_entry_t *entry = &s_blockIndex[hist_data.blockHead % HISTORY_STORE_BLOCKS];
+
+    // Drop the oldest blocks until the new block fits, the entry of the new block is never readable
+    HISTORY_CRITICAL_BEGIN();
+    while ((hist_data.blockCount > 0) && ((s_storeUsed + length > HISTORY_STORE_SIZE) ||
+                                          (hist_data.blockCount >= HISTORY_STORE_BLOCKS - 1U))) {
+        uint16_t oldest = (uint16_t)(hist_data.blockHead - hist_data.blockCount);
+        s_storeUsed     -= s_blockIndex[oldest % HISTORY_STORE_BLOCKS].length;
+        hist_data.blockCount--;
+    }
+    HISTORY_CRITICAL_END();
+
+    entry->offset = s_storeHead;
+    entry->length = length;
+    for (uint16_t i = 0; i < length; i++) {
+        s_store[s_storeHead] = block[i];
+        s_storeHead          = (uint16_t)((s_storeHead + 1U) % HISTORY_STORE_SIZE);
+    }
+
+    HISTORY_CRITICAL_BEGIN();
+    s_storeUsed += length;
+    hist_data.blockHead++;
+    hist_data.blockCount++;
+    HISTORY_CRITICAL_END();
+}
+
+static void s_CloseBlock(void) {
+    uint16_t first  = (uint16_t)(hist_data.head - HISTORY_BLOCK_RECORDS);
+    int32_t  length = historyCodec_Encode(first, hist_data.blockTime,
+                                          &hist_data.ring[first % HISTORY_DEPTH],
+                                          HISTORY_BLOCK_RECORDS, s_blockBuf, sizeof(s_blockBuf));
+    if (length > 0) {
+        s_StoreBlock(s_blockBuf, (uint16_t)length);
+    }
+}
+
+/* Public functions */
+/**
+ * \brief Clear the history, the first record and the first block get sequence number 0
+ * \author agent, agent@local, Oct.2026
+ */
+void history_Init(void) {
+    for (uint32_t i = 0; i < HISTORY_DEPTH; i++) {
+        for (uint32_t ch = 0; ch < HISTORY_CHANNEL_COUNT; ch++) {
+            hist_data.ring[i].value[ch] = HISTORY_INVALID;
+        }
+    }
+    for (uint32_t i = 0; i < HISTORY_STORE_BLOCKS; i++) {
+        s_blockIndex[i].offset = 0;
+        s_blockIndex[i].length = 0;
+    }
+    hist_data.headTime    = 0;
+    hist_data.blockTime   = 0;
+    hist_data.head        = 0;
+    hist_data.count       = 0;
+    hist_data.cursor      = 0;
+    hist_data.blockHead   = 0;
+    hist_data.blockCount  = 0;
+    hist_data.blockCursor = 0;
+    s_storeHead           = 0;
+    s_storeUsed           = 0;
+}
+
+/**
+ * \brief Append one record. Every HISTORY_BLOCK_RECORDS records the block is compressed into the
+ * block store. With HISTORY_EEPROM_EN CO2eq/TVOC are also written to the data EEPROM, which blocks
+ * for a few milliseconds.
+ * \param[in] record - The record, HISTORY_INVALID for the channels that were not measured
+ * \param[in] time_s - Uptime in seconds
+ * \author agent, agent@local, Oct.2026
+ */
+void history_Push(const history_record_t *const record, const uint32_t time_s) {
+    uint16_t seq = hist_data.head;
+
+    if ((seq % HISTORY_BLOCK_RECORDS) == 0) {
+        hist_data.blockTime = time_s;
+    }
+
+    // The oldest record is not readable, its slot can be overwritten while the master reads
+    hist_data.ring[seq % HISTORY_DEPTH] = *record;
+#if (HISTORY_EEPROM_EN > 0u)
+    eeprom_WriteWord(EEPROM_HISTORY_OFFSET + (seq % HISTORY_EEPROM_DEPTH) * sizeof(uint32_t),
+                     ((uint32_t)record->value[HISTORY_CH_TVOC] << 16) |
+                         record->value[HISTORY_CH_CO2]);
+#endif
+
+    HISTORY_CRITICAL_BEGIN();
+    hist_data.head     = seq + 1;
+    hist_data.headTime = time_s;
+    if (hist_data.count < HISTORY_READABLE_MAX) {
+        hist_data.count++;
+    }
+    HISTORY_CRITICAL_END();
+
+    if ((hist_data.head % HISTORY_BLOCK_RECORDS) == 0) {
+        s_CloseBlock();
+    }
+}
+
+/**
+ * \brief Get one record by sequence number
+ * \param[in] seq - Sequence number of the record
+ * \param[out] record - The record
+ * \return 0 when success, -1 when the record is not stored
+ * \author agent, agent@local, Oct.2026
+ */
+int32_t history_GetRecord(const uint16_t seq, history_record_t *const record) {
+    uint16_t age = (uint16_t)(hist_data.head - 1U - seq);  // 0 = newest
+
+    if (age >= hist_data.count) {
+        return -1;
+    }
+    if (age < HISTORY_DEPTH - 1U) {
+        *record = hist_data.ring[seq % HISTORY_DEPTH];
+        return 0;
+    }
+#if (HISTORY_EEPROM_EN > 0u)
+    uint32_t word = eeprom_ReadWord(EEPROM_HISTORY_OFFSET +
+                                    (seq % HISTORY_EEPROM_DEPTH) * sizeof(uint32_t));
+    record->value[HISTORY_CH_CO2]     = (uint16_t)word;
+    record->value[HISTORY_CH_TVOC]    = (uint16_t)(word >> 16);
+    record->value[HISTORY_CH_H2]      = HISTORY_INVALID;
+    record->value[HISTORY_CH_ETHANOL] = HISTORY_INVALID;
+    return 0;
+#else
+    return -1;
+#endif
+}
+
+/**
+ * \brief Read one register of the history window, record HIST_CURSOR + offset / 2
+ * \param[in] reg_addr - Register address
+ * \param[out] value - CO2eq (even offset) or TVOC (odd offset) of the record
+ * \return 0 when success, -1 when the address is not a window register or the record is not stored
+ * \author agent, agent@local, Oct.2026
+ */
+int32_t history_ReadRegister(const uint16_t reg_addr, uint16_t *const value) {
+    history_record_t record;
+    uint16_t         offset = reg_addr - HISTORY_REG_WINDOW;
+
+    if ((reg_addr < HISTORY_REG_WINDOW) || (offset >= HISTORY_REG_WINDOW_SIZE)) {
+        return -1;
+    }
+    if (0 != history_GetRecord(hist_data.cursor + offset / 2U, &record)) {
+        return -1;
+    }
+    *value = record.value[(offset & 0x01U) ? HISTORY_CH_TVOC : HISTORY_CH_CO2];
+    return 0;
+}
+
+/**
+ * \brief Read one register of the compressed block window, block HIST_BLK_CUR
+ * \param[in] reg_addr - Register address
+ * \param[out] value - Offset 0: block length in bytes, then two block bytes, 0 after the block end
+ * \return 0 when success, -1 when the address is not a window register or the block is not stored
+ * \author agent, agent@local, Oct.2026
+ */
+int32_t history_ReadBlockRegister(const uint16_t reg_addr, uint16_t *const value) {
+    uint16_t                     block  = hist_data.blockCursor;
+    uint16_t                     offset = reg_addr - HISTORY_REG_BLOCK_WINDOW;
+    uint16_t                     age    = (uint16_t)(hist_data.blockHead - 1U - block);
+    const history_block_entry_t *entry  = &s_blockIndex[block % HISTORY_STORE_BLOCKS];
+    uint16_t                     byte;
+
+    if ((reg_addr < HISTORY_REG_BLOCK_WINDOW) || (offset >= HISTORY_REG_BLOCK_WINDOW_MIN) ||
+        (age >= hist_data.blockCount)) {
+        return -1;
+    }
+    if (offset == 0) {
+        *value = entry->length;
+        return 0;
+    }
+
+    *value = 0;
+    byte   = 2U * (offset - 1U);
+    for (uint16_t i = 0; i < 2; i++, byte++) {
+        *value <<= 8;
+        if (byte < entry->length) {
+            *value |= s_store[(entry->offset + byte) % HISTORY_STORE_SIZE];
+        }
+    }
+    return 0;
+}
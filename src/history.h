@@ -0,0 +1,66 @@
+/*
+ * history.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef HISTORY_H_
+#define HISTORY_H_
+
+#include <stdint.h>
+
+#include "eeprom.h"
+#include "history_codec.h"
+
+/*
+ * CO2eq/TVOC/raw signal history, one record per main loop (1Hz). Every loop pushes a record, a
+ * failed measurement is stored as HISTORY_INVALID, so record n is HIST_HEAD - 1 - n seconds older
+ * than the newest record at uptime HIST_TIME. Records are addressed by a 16-bit sequence number.
+ *
+ * Record readout: write the sequence number of the first wanted record to HIST_CURSOR (FC 0x06),
+ * then read up to HISTORY_WINDOW_RECORDS records from the window block (FC 0x04), CO2 and TVOC
+ * per record. Reading a record that is not stored (yet) returns MODBUS_RTU_ERR_DATA_UNAVAILABLE.
+ *
+ * Every HISTORY_BLOCK_RECORDS records are also compressed into a block (history_codec.h) and kept
+ * in a RAM store that holds hours of history. Block readout: write the block sequence number to
+ * HIST_BLK_CUR, then read the block window. Register 0 of the window is the block length in
+ * bytes, the next registers hold the block bytes, two per register, first byte in the high half.
+ */
+#define HISTORY_EEPROM_EN      0      // spill records to the data EEPROM, extends the depth
+#define HISTORY_DEPTH          1024U  // records in RAM, 17 minutes
+#define HISTORY_EEPROM_DEPTH   (EEPROM_HISTORY_SIZE / sizeof(uint32_t))  // 2048 records, 34 min
+#define HISTORY_INVALID        HISTORY_CODEC_INVALID
+#define HISTORY_WINDOW_RECORDS 62U    // 124 registers, fits one FC 0x04 reply
+
+#define HISTORY_BLOCK_RECORDS 64U      // records per compressed block, about 1 minute
+#define HISTORY_STORE_SIZE    0x8000U  // 32KB of compressed blocks
+#define HISTORY_STORE_BLOCKS  256U     // block index entries
+#define HISTORY_BLOCK_SIZE    HISTORY_CODEC_BLOCK_SIZE(HISTORY_BLOCK_RECORDS)
+
+#define HISTORY_REG_WINDOW           0x0400U
+#define HISTORY_REG_WINDOW_SIZE      (2U * HISTORY_WINDOW_RECORDS)
+#define HISTORY_REG_BLOCK_WINDOW     0x0480U
+#define HISTORY_REG_BLOCK_WINDOW_MIN (1U + (HISTORY_BLOCK_SIZE + 1U) / 2U)
+
+typedef struct history_type {
+    history_record_t ring[HISTORY_DEPTH];
+    uint32_t         headTime;     // uptime in s of the newest record
+    uint32_t         blockTime;    // uptime in s of the first record of the open block
+    uint16_t         head;         // sequence number of the next record, wraps at 65536
+    uint16_t         count;        // number of readable records
+    uint16_t         cursor;       // first record of the readout window, written by the master
+    uint16_t         blockHead;    // sequence number of the next compressed block
+    uint16_t         blockCount;   // number of readable compressed blocks
+    uint16_t         blockCursor;  // compressed block to read, written by the master
+} history_t;
+
+extern history_t hist_data;
+
+void    history_Init(void);
+void    history_Push(const history_record_t *const record, const uint32_t time_s);
+int32_t history_GetRecord(const uint16_t seq, history_record_t *const record);
+int32_t history_ReadRegister(const uint16_t reg_addr, uint16_t *const value);
+int32_t history_ReadBlockRegister(const uint16_t reg_addr, uint16_t *const value);
+
+#endif /* HISTORY_H_ */
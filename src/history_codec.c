@@ -0,0 +1,174 @@
+/*
+ * history_codec.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+#include "history_codec.h"
+
+#include "crc.h"
+
+#define HISTORY_CODEC_MASK_ALL ((1U << HISTORY_CHANNEL_COUNT) - 1U)
+
+/* Private functions */
+static inline uint16_t s_ZigZag(const uint16_t delta) {
+    // Small negative deltas become small odd numbers: 0, -1, 1, -2, ... -> 0, 1, 2, 3, ...
+    return (uint16_t)((delta << 1) ^ ((delta & 0x8000U) ? 0xFFFFU : 0x0000U));
+}
+
+static inline uint16_t s_UnZigZag(const uint16_t zz) {
+    return (uint16_t)((zz >> 1) ^ ((zz & 0x0001U) ? 0xFFFFU : 0x0000U));
+}
+
+static size_t s_PutVarint(uint16_t value, uint8_t *const out, const size_t out_size) {
+    size_t n = 0;
+    do {
+        if (n >= out_size) {
+            return 0;
+        }
+        out[n] = (uint8_t)(value & 0x7FU);
+        value  >>= 7;
+        if (value != 0) {
+            out[n] |= 0x80U;
+        }
+        n++;
+    } while (value != 0);
+    return n;
+}
+
+static size_t s_GetVarint(const uint8_t *const in, const size_t in_len, uint16_t *const value) {
+    uint32_t result = 0;
+    for (size_t n = 0; (n < in_len) && (n < HISTORY_CODEC_VARINT_MAX); n++) {
+        result |= (uint32_t)(in[n] & 0x7FU) << (7 * n);
+        if (!(in[n] & 0x80U)) {
+            if (result > 0xFFFFU) {
+                return 0;
+            }
+            *value = (uint16_t)result;
+            return n + 1;
+        }
+    }
+    return 0;  // truncated or longer than a 16-bit value
+}
+
+/* Public functions */
+/**
+ * \brief Compress records into one history block, see history_codec.h for the format
+ * \param[in] seq - Sequence number of the first record
+ * \param[in] time_s - Uptime in s of the first record
+ * \param[in] records - The records, one per second
+ * \param[in] count - Number of records, 1...HISTORY_CODEC_RECORDS_MAX
+ * \param[out] out - The block
+ * \param[in] out_size - Size of out, HISTORY_CODEC_BLOCK_SIZE(count) always fits
+ * \return Length of the block in bytes, -1 when count is invalid or the block does not fit
+ * \author agent, agent@local, Oct.2026
+ */
+int32_t historyCodec_Encode(const uint16_t seq, const uint32_t time_s,
+                            const history_record_t *const records, const uint8_t count,
+                            uint8_t *const out, const size_t out_size) {
+    uint16_t prev[HISTORY_CHANNEL_COUNT] = {0};
+    uint8_t  mask                        = 0;
+    size_t   len                         = HISTORY_CODEC_HEADER_SIZE;
+    size_t   n;
+    uint16_t crc;
+
+    if ((count == 0) || (out_size < HISTORY_CODEC_HEADER_SIZE + HISTORY_CODEC_CRC_SIZE)) {
+        return -1;
+    }
+
+    for (uint8_t i = 0; i < count; i++) {
+        for (uint8_t ch = 0; ch < HISTORY_CHANNEL_COUNT; ch++) {
+            if (records[i].value[ch] != HISTORY_CODEC_INVALID) {
+                mask |= (uint8_t)(1U << ch);
+            }
+        }
+    }
+
+    out[0] = (uint8_t)seq;
+    out[1] = (uint8_t)(seq >> 8);
+    out[2] = (uint8_t)time_s;
+    out[3] = (uint8_t)(time_s >> 8);
+    out[4] = (uint8_t)(time_s >> 16);
+    out[5] = (uint8_t)(time_s >> 24);
+    out[6] = count;
+    out[7] = mask;
+
+    for (uint8_t i = 0; i < count; i++) {
+        for (uint8_t ch = 0; ch < HISTORY_CHANNEL_COUNT; ch++) {
+            if (!(mask & (1U << ch))) {
+                continue;
+            }
+            n = s_PutVarint(s_ZigZag((uint16_t)(records[i].value[ch] - prev[ch])), &out[len],
+                            out_size - HISTORY_CODEC_CRC_SIZE - len);
+            if (n == 0) {
+                return -1;
+            }
+            len      += n;
+            prev[ch] = records[i].value[ch];
+        }
+    }
+
+    crc        = CRC16(out, (uint16_t)len);
+    out[len++] = (uint8_t)(crc >> 8);
+    out[len++] = (uint8_t)(crc & 0xff);
+    return (int32_t)len;
+}
+
+/**
+ * \brief Check and decompress one history block
+ * \param[in] in - The block
+ * \param[in] in_len - Length of the block in bytes
+ * \param[out] info - Header of the block
+ * \param[out] records - The records, channels not in the mask are HISTORY_CODEC_INVALID
+ * \param[in] records_max - Capacity of records
+ * \return Number of records, -1 when the CRC, the header or the payload is invalid
+ * \author agent, agent@local, Oct.2026
+ */
+int32_t historyCodec_Decode(const uint8_t *const in, const size_t in_len,
+                            history_block_info_t *const info, history_record_t *const records,
+                            const uint8_t records_max) {
+    uint16_t prev[HISTORY_CHANNEL_COUNT] = {0};
+    size_t   pos                         = HISTORY_CODEC_HEADER_SIZE;
+    size_t   end;
+    size_t   n;
+    uint16_t crc, zz;
+
+    if ((in_len < HISTORY_CODEC_HEADER_SIZE + HISTORY_CODEC_CRC_SIZE) || (in_len > UINT16_MAX)) {
+        return -1;
+    }
+    end = in_len - HISTORY_CODEC_CRC_SIZE;
+    crc = CRC16(in, (uint16_t)end);
+    if ((in[end] != (uint8_t)(crc >> 8)) || (in[end + 1] != (uint8_t)(crc & 0xff))) {
+        return -1;
+    }
+
+    info->seq    = (uint16_t)(in[0] | (in[1] << 8));
+    info->time_s = (uint32_t)in[2] | ((uint32_t)in[3] << 8) | ((uint32_t)in[4] << 16) |
+                   ((uint32_t)in[5] << 24);
+    info->count  = in[6];
+    info->mask   = in[7];
+    if ((info->count == 0) || (info->count > records_max) ||
+        (info->mask & ~HISTORY_CODEC_MASK_ALL)) {
+        return -1;
+    }
+
+    for (uint8_t i = 0; i < info->count; i++) {
+        for (uint8_t ch = 0; ch < HISTORY_CHANNEL_COUNT; ch++) {
+            if (!(info->mask & (1U << ch))) {
+                records[i].value[ch] = HISTORY_CODEC_INVALID;
+                continue;
+            }
+            n = s_GetVarint(&in[pos], end - pos, &zz);
+            if (n == 0) {
+                return -1;
+            }
+            pos                  += n;
+            prev[ch]             = (uint16_t)(prev[ch] + s_UnZigZag(zz));
+            records[i].value[ch] = prev[ch];
+        }
+    }
+    if (pos != end) {
+        return -1;  // trailing bytes
+    }
+    return info->count;
+}
@@ -0,0 +1,63 @@
+/*
+ * history_codec.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef HISTORY_CODEC_H_
+#define HISTORY_CODEC_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Compressed history block, all multi-byte header fields little endian
+ *
+ *   0  u16 sequence number of the first record
+ *   2  u32 uptime in s of the first record, record i is i seconds later
+ *   6  u8  number of records
+ *   7  u8  channel mask, bit n set when channel n is stored
+ *   8  payload, per record and per stored channel the zig-zag varint of the 16-bit delta to the
+ *      same channel of the previous record (0 before the first record)
+ *   n  u16 CRC16 of bytes 0...n-1, high byte first like the Modbus frames of this project
+ *
+ * The deltas are taken modulo 2^16, so every 16-bit value (also HISTORY_INVALID) round-trips.
+ * A channel that is HISTORY_INVALID for the whole block is left out of the mask.
+ */
+#define HISTORY_CODEC_HEADER_SIZE  8U
+#define HISTORY_CODEC_CRC_SIZE     2U
+#define HISTORY_CODEC_VARINT_MAX   3U  // 16-bit value, 7 bits per byte
+#define HISTORY_CODEC_RECORDS_MAX  255U
+#define HISTORY_CODEC_INVALID      0xFFFFU
+#define HISTORY_CODEC_BLOCK_SIZE(records)                    \
+    (HISTORY_CODEC_HEADER_SIZE + HISTORY_CODEC_CRC_SIZE + \
+     (records) * HISTORY_CHANNEL_COUNT * HISTORY_CODEC_VARINT_MAX)  // worst case size
+
+typedef enum {
+    HISTORY_CH_CO2 = 0,
+    HISTORY_CH_TVOC,
+    HISTORY_CH_H2,
+    HISTORY_CH_ETHANOL,
+    HISTORY_CHANNEL_COUNT
+} HISTORY_CHANNEL;
+
+typedef struct history_record_type {
+    uint16_t value[HISTORY_CHANNEL_COUNT];  // HISTORY_CODEC_INVALID when not measured
+} history_record_t;
+
+typedef struct history_block_info_type {
+    uint16_t seq;     // sequence number of the first record
+    uint32_t time_s;  // uptime in s of the first record
+    uint8_t  count;   // number of records
+    uint8_t  mask;    // stored channels
+} history_block_info_t;
+
+int32_t historyCodec_Encode(const uint16_t seq, const uint32_t time_s,
+                            const history_record_t *const records, const uint8_t count,
+                            uint8_t *const out, const size_t out_size);
+int32_t historyCodec_Decode(const uint8_t *const in, const size_t in_len,
+                            history_block_info_t *const info, history_record_t *const records,
+                            const uint8_t records_max);
+
+#endif /* HISTORY_CODEC_H_ */
@@ -0,0 +1,120 @@
+/*
+ * humidity.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+#include "humidity.h"
+
+#define HUMIDITY_TABLE_LEN ((HUMIDITY_TEMP_MAX - HUMIDITY_TEMP_MIN) / HUMIDITY_TABLE_STEP + 1)
+
+/*
+ * Saturation vapour pressure over water in Pa, Q16.16, from -40 degC to +80 degC in 0.5 degC steps.
+ * Magnus formula with the Sonntag 1990 coefficients: Es = 611.2 * exp(17.62 * T / (243.12 + T)).
+ * Linear interpolation between the entries stays within 0.05 % of the formula.
+ */
+static const uint32_t s_saturationTable[HUMIDITY_TABLE_LEN] = {
+       1246573U,    1312831U,    1382260U,    1454993U,    1531171U,    1610938U,
+       1694442U,    1781840U,    1873290U,    1968959U,    2069018U,    2173646U,
+       2283026U,    2397349U,    2516811U,    2641616U,    2771975U,    2908104U,
+       3050229U,    3198582U,    3353403U,    3514941U,    3683450U,    3859195U,
+       4042450U,    4233496U,    4432623U,    4640132U,    4856331U,    5081541U,
+       5316090U,    5560317U,    5814572U,    6079215U,    6354619U,    6641165U,
+       6939247U,    7249273U,    7571660U,    7906838U,    8255251U,    8617354U,
+       8993618U,    9384525U,    9790573U,   10212271U,   10650147U,   11104741U,
+      11576607U,   12066318U,   12574461U,   13101638U,   13648471U,   14215596U,
+      14803666U,   15413355U,   16045351U,   16700363U,   17379119U,   18082365U,
+      18810866U,   19565408U,   20346799U,   21155865U,   21993455U,   22860439U,
+      23757709U,   24686179U,   25646789U,   26640498U,   27668292U,   28731179U,
+      29830196U,   30966400U,   32140877U,   33354738U,   34609122U,   35905193U,
+      37244144U,   38627198U,   40055603U,   41530639U,   43053614U,   44625868U,
+      46248771U,   47923723U,   49652158U,   51435541U,   53275371U,   55173179U,
+      57130533U,   59149032U,   61230312U,   63376046U,   65587942U,   67867745U,
+      70217238U,   72638241U,   75132616U,   77702261U,   80349116U,   83075160U,
+      85882416U,   88772946U,   91748856U,   94812297U,   97965460U,  101210584U,
+     104549951U,  107985891U,  111520778U,  115157035U,  118897133U,  122743591U,
+     126698977U,  130765909U,  134947058U,  139245144U,  143662938U,  148203268U,
+     152869013U,  157663105U,  162588534U,  167648345U,  172845637U,  178183570U,
+     183665360U,  189294282U,  195073670U,  201006921U,  207097490U,  213348895U,
+     219764718U,  226348602U,  233104256U,  240035454U,  247146035U,  254439906U,
+     261921039U,  269593477U,  277461331U,  285528781U,  293800079U,  302279549U,
+     310971586U,  319880658U,  329011309U,  338368156U,  347955893U,  357779290U,
+     367843195U,  378152533U,  388712310U,  399527610U,  410603600U,  421945527U,
+     433558723U,  445448600U,  457620657U,  470080478U,  482833732U,  495886177U,
+     509243658U,  522912106U,  536897547U,  551206094U,  565843953U,  580817420U,
+     596132888U,  611796842U,  627815863U,  644196626U,  660945906U,  678070574U,
+     695577600U,  713474054U,  731767107U,  750464030U,  769572199U,  789099090U,
+     809052287U,  829439477U,  850268453U,  871547116U,  893283475U,  915485647U,
+     938161860U,  961320453U,  984969875U, 1009118689U, 1033775572U, 1058949315U,
+    1084648823U, 1110883121U, 1137661347U, 1164992761U, 1192886740U, 1221352783U,
+    1250400507U, 1280039654U, 1310280089U, 1341131798U, 1372604895U, 1404709617U,
+    1437456331U, 1470855529U, 1504917831U, 1539653990U, 1575074887U, 1611191533U,
+    1648015075U, 1685556790U, 1723828090U, 1762840523U, 1802605772U, 1843135658U,
+    1884442138U, 1926537311U, 1969433411U, 2013142817U, 2057678046U, 2103051761U,
+    2149276766U, 2196366009U, 2244332584U, 2293189731U, 2342950838U, 2393629438U,
+    2445239216U, 2497794004U, 2551307786U, 2605794698U, 2661269027U, 2717745213U,
+    2775237853U, 2833761694U, 2893331644U, 2953962764U, 3015670275U, 3078469555U,
+    3142376142U};
+
+humidity_t hum_data = {250, HUMIDITY_RH_UNKNOWN, 0};
+
+/* Public functions */
+/**
+ * \brief Saturation vapour pressure over water
+ * \param[in] temperature - 0.1 degC, HUMIDITY_TEMP_MIN...HUMIDITY_TEMP_MAX
+ * \return Pa in Q16.16, 0 when the temperature is out of range
+ * \author agent, agent@local, Oct.2026
+ */
+uint32_t humidity_SaturationPressure(const int16_t temperature) {
+    if ((temperature < HUMIDITY_TEMP_MIN) || (temperature > HUMIDITY_TEMP_MAX)) {
+        return 0;
+    }
+    uint32_t index = (uint32_t)(temperature - HUMIDITY_TEMP_MIN) / HUMIDITY_TABLE_STEP;
+    uint32_t frac  = (uint32_t)(temperature - HUMIDITY_TEMP_MIN) % HUMIDITY_TABLE_STEP;
+    if (frac == 0) {
+        return s_saturationTable[index];
+    }
+    uint32_t lo = s_saturationTable[index];
+    uint32_t hi = s_saturationTable[index + 1];
+    return lo + (uint32_t)(((uint64_t)(hi - lo) * frac + HUMIDITY_TABLE_STEP / 2) /
+                           HUMIDITY_TABLE_STEP);
+}
+
+/**
+ * \brief Absolute humidity from temperature and relative humidity,
+ * AH = 2.16679 g*K/J * RH * Es(T) / (273.15 K + T)
+ * \param[in] temperature - 0.1 degC, HUMIDITY_TEMP_MIN...HUMIDITY_TEMP_MAX
+ * \param[in] rh - 0.1 %RH, 0...HUMIDITY_RH_MAX
+ * \param[out] ah_q16 - g/m3 in Q16.16
+ * \return 0 when success, -1 when an input is out of range
+ * \author agent, agent@local, Oct.2026
+ */
+int32_t humidity_Absolute(const int16_t temperature, const uint16_t rh, uint32_t *const ah_q16) {
+    if ((temperature < HUMIDITY_TEMP_MIN) || (temperature > HUMIDITY_TEMP_MAX) ||
+        (rh > HUMIDITY_RH_MAX)) {
+        return -1;
+    }
+    // Es[Pa, Q16] * RH[0.1%] / 1000 * 216679 / 1000 / T[0.01 K], max 3.1e9 * 1000 * 216679 < 2^64
+    uint64_t num = (uint64_t)humidity_SaturationPressure(temperature) * rh * 216679U;
+    uint64_t den = (uint64_t)(27315 + 10 * (int32_t)temperature) * 1000000U;
+    *ah_q16      = (uint32_t)((num + den / 2) / den);
+    return 0;
+}
+
+/**
+ * \brief Convert absolute humidity to the 8.8 fixed point format of the SGP30 Set_humidity command
+ * \param[in] ah_q16 - g/m3 in Q16.16
+ * \return g/m3 in 8.8, rounded and saturated to 0x0001...0xFFFF. 0x0000 is never returned because
+ * it turns the compensation off.
+ * \author agent, agent@local, Oct.2026
+ */
+uint16_t humidity_ToSgp30(const uint32_t ah_q16) {
+    uint32_t value = (ah_q16 >> 8) + ((ah_q16 >> 7) & 0x01U);  // round half up, no overflow
+    if (value > 0xFFFFU) {
+        return 0xFFFF;
+    }
+    if (value == 0) {
+        return 0x0001;
+    }
+    return (uint16_t)value;
+}
@@ -0,0 +1,36 @@
+/*
+ * humidity.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef HUMIDITY_H_
+#define HUMIDITY_H_
+
+#include <stdint.h>
+
+/*
+ * Absolute humidity for the SGP30 humidity compensation, integer only. Inputs use the units of the
+ * DHT22: temperature in 0.1 degC and relative humidity in 0.1 %RH.
+ */
+#define HUMIDITY_TEMP_MIN   (-400)  // 0.1 degC, lower end of the saturation table
+#define HUMIDITY_TEMP_MAX   800     // 0.1 degC, upper end of the saturation table
+#define HUMIDITY_RH_MAX     1000U   // 0.1 %RH
+#define HUMIDITY_TABLE_STEP 5       // 0.1 degC between table entries
+#define HUMIDITY_RH_UNKNOWN 0U      // no relative humidity input yet, compensation stays off
+
+/* Compensation inputs, written by the Modbus master or by the DHT22 when it is connected */
+typedef struct humidity_type {
+    int16_t  temperature;  // 0.1 degC
+    uint16_t rh;           // 0.1 %RH, HUMIDITY_RH_UNKNOWN until the first input
+    uint16_t absolute;     // g/m3 in 8.8 fixed point, the value sent to the SGP30
+} humidity_t;
+
+extern humidity_t hum_data;
+
+uint32_t humidity_SaturationPressure(const int16_t temperature);
+int32_t  humidity_Absolute(const int16_t temperature, const uint16_t rh, uint32_t *const ah_q16);
+uint16_t humidity_ToSgp30(const uint32_t ah_q16);
+
+#endif /* HUMIDITY_H_ */
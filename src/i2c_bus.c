@@ -0,0 +1,359 @@
+/*
+ * i2c_bus.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+#include "i2c_bus.h"
+
+#include "i2c.h"
+#include "irq_stats.h"
+#include "profiler.h"
+#include "stm32l1xx.h"
+#include "usart_config.h"
+#include "utils.h"
+
+typedef enum { PHASE_IDLE = 0, PHASE_WRITE, PHASE_WAIT, PHASE_READ } I2C_BUS_PHASE;
+
+static i2c_transaction_t          *s_queue[I2C_BUS_QUEUE_LEN];  // pending, highest priority first
+static uint32_t                    s_queued        = 0;         // number of entries in s_queue
+static i2c_transaction_t *volatile s_active        = NULL;      // transaction on the bus
+static volatile uint8_t            s_phase         = PHASE_IDLE;
+static uint8_t                     s_index         = 0;  // next byte of the current phase
+static uint8_t                     s_startDeferred = 0;  // START waits for the previous STOP
+static uint8_t                     s_stopPolls     = 0;  // TIM6 checks of the STOP bit so far
+
+/* Private functions */
+static inline void s_Reset(void) {
+    I2C1_init();  // SWRST, releases the bus
+    I2C1->CR2 |= I2C_CR2_ITEVTEN | I2C_CR2_ITERREN;
+}
+
+/* One pulse of TIM6, the update interrupt comes after ticks of prescaler + 1 CPU cycles */
+static inline void s_TimerStart(const uint16_t prescaler, const uint16_t ticks) {
+    TIM6->PSC = prescaler;
+    TIM6->ARR = ticks;
+    TIM6->EGR = TIM_EGR_UG;  // load the prescaler and clear the counter, no interrupt with URS
+    TIM6->SR  = 0;
+    TIM6->CR1 |= TIM_CR1_CEN;  // stops itself at the update event
+}
+
+static inline void s_WaitStart(const uint16_t wait_ms) {
+    s_TimerStart((F_CPU / 1000U) - 1U, wait_ms);
+}
+
+/*
+ * Generate the START of the current phase. The STOP of the previous transfer takes a few us and a
+ * START requested before it ends is lost. The I2C v1 peripheral has no STOP-complete interrupt in
+ * master mode, so the START is deferred to TIM6 and the STOP bit checked again there.
+ */
+static void s_Start(void) {
+    if (I2C1->CR1 & I2C_CR1_STOP) {
+        if (s_stopPolls++ < (I2C_BUS_STOP_WAIT_US / I2C_BUS_STOP_POLL_US)) {
+            s_startDeferred = 1;
+            s_TimerStart((F_CPU / 1000000U) - 1U, I2C_BUS_STOP_POLL_US);
+            return;
+        }
+        s_Reset();  // the STOP never ended, the bus is stuck
+    }
+    s_startDeferred = 0;
+    s_stopPolls     = 0;
+    I2C1->CR1 |= I2C_CR1_START;
+}
+
+static void s_StartPhase(void) {
+    s_index = 0;
+    if (s_active->txLen > 0) {
+        s_phase = PHASE_WRITE;
+    } else if (s_active->rxLen > 0) {
+        s_phase = PHASE_READ;
+    } else {
+        s_phase = PHASE_WAIT;  // wait only
+        s_WaitStart(s_active->waitMs);
+        return;
+    }
+    s_Start();
+}
+
+/* Start the first queued transaction when the bus is idle, interrupts disabled by the caller */
+static void s_StartNext(void) {
+    if ((NULL != s_active) || (s_queued == 0)) {
+        return;
+    }
+    s_active = s_queue[0];
+    for (uint32_t i = 1; i < s_queued; i++) {
+        s_queue[i - 1] = s_queue[i];
+    }
+    s_queued--;
+    s_active->status = I2C_BUS_BUSY;
+    s_StartPhase();
+}
+
+/* Finish the active transaction and start the next one, called from the handlers */
+static void s_Complete(const I2C_BUS_STATUS status) {
+    i2c_transaction_t *tr = s_active;
+
+    I2C1->CR2 &= ~I2C_CR2_ITBUFEN;
+    s_active        = NULL;
+    s_phase         = PHASE_IDLE;
+    s_startDeferred = 0;
+    s_stopPolls     = 0;
+    if (I2C_BUS_DONE != status) {
+        tr->device->errors++;
+    }
+    tr->status = status;
+    if (NULL != tr->done) {
+        tr->done(tr);
+    }
+    s_StartNext();
+}
+
+/* End of the write phase, the bytes are on the bus */
+static void s_WriteDone(void) {
+    if ((s_active->rxLen > 0) && (s_active->waitMs == 0)) {
+        s_phase = PHASE_READ;  // repeated START
+        s_index = 0;
+        I2C1->CR1 |= I2C_CR1_START;
+        return;
+    }
+    I2C1->CR1 |= I2C_CR1_STOP;
+    if (s_active->waitMs > 0) {
+        s_phase = PHASE_WAIT;
+        s_WaitStart(s_active->waitMs);
+    } else {
+        s_Complete(I2C_BUS_DONE);
+    }
+}
+
+static void s_QueueRemove(const i2c_transaction_t *const tr) {
+    for (uint32_t i = 0; i < s_queued; i++) {
+        if (s_queue[i] == tr) {
+            for (uint32_t j = i + 1; j < s_queued; j++) {
+                s_queue[j - 1] = s_queue[j];
+            }
+            s_queued--;
+            return;
+        }
+    }
+}
+
+/* Public functions */
+/**
+ * \brief Initialize I2C1 with its event/error interrupts and TIM6 for the wait phases
+ * \author agent, agent@local, Oct.2026
+ */
+void i2cBus_Init(void) {
+    s_Reset();
+
+    RCC->APB1ENR |= RCC_APB1ENR_TIM6EN;
+    TIM6->CR1    = TIM_CR1_OPM | TIM_CR1_URS;  // one pulse, update interrupt on overflow only
+    TIM6->SR     = 0;  // the prescaler is set per pulse, 1ms for the wait phase, 1us for STOP
+    TIM6->DIER   = TIM_DIER_UIE;
+
+    NVIC_SetPriority(I2C1_EV_IRQn,
+                     NVIC_EncodePriority(NVIC_GetPriorityGrouping(), IRQ_PRIORITY_I2C, 0));
+    NVIC_SetPriority(I2C1_ER_IRQn,
+                     NVIC_EncodePriority(NVIC_GetPriorityGrouping(), IRQ_PRIORITY_I2C, 0));
+    NVIC_SetPriority(TIM6_IRQn,
+                     NVIC_EncodePriority(NVIC_GetPriorityGrouping(), IRQ_PRIORITY_I2C, 0));
+    NVIC_EnableIRQ(I2C1_EV_IRQn);
+    NVIC_EnableIRQ(I2C1_ER_IRQn);
+    NVIC_EnableIRQ(TIM6_IRQn);
+}
+
+/**
+ * \brief Initialize a device handle
+ * \param[out] dev - The handle, owned by the sensor driver
+ * \param[in] address - 7-bit I2C address, 0x00 for the general call
+ * \param[in] priority - Queue priority of the transactions, I2C_BUS_PRIORITY_HIGH...LOW
+ * \author agent, agent@local, Oct.2026
+ */
+void i2cBus_DeviceInit(i2c_device_t *const dev, const uint8_t address, const uint8_t priority) {
+    dev->address  = address;
+    dev->priority = priority;
+    dev->errors   = 0;
+}
+
+/**
+ * \brief Queue a transaction. Transactions of higher priority devices run first, transactions of
+ * the same priority run in submission order. The bus starts at once when it is idle.
+ * \param[in,out] tr - The transaction, must stay valid until its status is no longer
+ * I2C_BUS_PENDING or I2C_BUS_BUSY
+ * \return 0 when queued, -1 when the queue is full
+ * \author agent, agent@local, Oct.2026
+ */
+int32_t i2cBus_Submit(i2c_transaction_t *const tr) {
+    uint32_t primask = __get_PRIMASK();
+    uint32_t pos;
+
+    __disable_irq();
+    if (s_queued >= I2C_BUS_QUEUE_LEN) {
+        __set_PRIMASK(primask);
+        return -1;
+    }
+    for (pos = s_queued; pos > 0; pos--) {
+        if (s_queue[pos - 1]->device->priority <= tr->device->priority) {
+            break;
+        }
+        s_queue[pos] = s_queue[pos - 1];
+    }
+    s_queue[pos] = tr;
+    s_queued++;
+    tr->status   = I2C_BUS_PENDING;
+    s_StartNext();
+    __set_PRIMASK(primask);
+    return 0;
+}
+
+/**
+ * \brief Wait for a submitted transaction, the CPU sleeps until the next interrupt in between
+ * \param[in,out] tr - The transaction
+ * \param[in] timeout_ms - Time limit from now, including the time spent in the queue
+ * \return The final status. On timeout the transaction is removed from the queue, or aborted and
+ * the peripheral reset when it is on the bus.
+ * \author agent, agent@local, Oct.2026
+ */
+I2C_BUS_STATUS i2cBus_Wait(i2c_transaction_t *const tr, const uint32_t timeout_ms) {
+    uint32_t start = tick_ms();
+    uint32_t primask;
+
+    while ((tr->status == I2C_BUS_PENDING) || (tr->status == I2C_BUS_BUSY)) {
+        if ((tick_ms() - start) >= timeout_ms) {
+            primask = __get_PRIMASK();
+            __disable_irq();
+            if (tr == s_active) {
+                TIM6->CR1 &= ~TIM_CR1_CEN;
+                TIM6->SR  = 0;
+                s_Reset();
+                s_active        = NULL;
+                s_phase         = PHASE_IDLE;
+                s_startDeferred = 0;
+                s_stopPolls     = 0;
+                tr->device->errors++;
+                tr->status = I2C_BUS_ERR_TIMEOUT;
+                s_StartNext();
+            } else if (tr->status == I2C_BUS_PENDING) {
+                s_QueueRemove(tr);
+                tr->device->errors++;
+                tr->status = I2C_BUS_ERR_TIMEOUT;
+            }
+            __set_PRIMASK(primask);
+            break;
+        }
+        __WFI();  // SysTick wakes up at least every 1ms
+    }
+    return (I2C_BUS_STATUS)tr->status;
+}
+
+/**
+ * \brief Submit a transaction and wait for it, see i2cBus_Submit and i2cBus_Wait
+ * \param[in,out] tr - The transaction
+ * \param[in] timeout_ms - Time limit, should cover tr->waitMs and the queued transactions
+ * \return I2C_BUS_DONE or the error status, I2C_BUS_ERR_BUS when the queue is full
+ * \author agent, agent@local, Oct.2026
+ */
+I2C_BUS_STATUS i2cBus_Transfer(i2c_transaction_t *const tr, const uint32_t timeout_ms) {
+    if (0 != i2cBus_Submit(tr)) {
+        return I2C_BUS_ERR_BUS;
+    }
+    return i2cBus_Wait(tr, timeout_ms);
+}
+
+/* Interrupt handlers */
+
+/**
+ * \brief I2C1 event interrupt handler, runs the write and read phases of the active transaction
+ * \author agent, agent@local, Oct.2026
+ * \details Reception of 2 bytes or more NACKs the last byte by clearing ACK and requesting the STOP
+ * while the second to last byte is read, when the last byte is already in the shift register.
+ * This relies on the handler latency staying below one byte time, 90us at 100kHz.
+ */
+void I2C1_EV_IRQHandler(void) {
+    IRQ_STATS_ENTER(IRQ_STAT_I2C1_EV);
+    PROFILER_BEGIN(PROF_ZONE_ISR_I2C1_EV);
+    uint32_t           sr1 = I2C1->SR1;
+    i2c_transaction_t *tr  = s_active;
+
+    if (NULL == tr) {
+        (void)I2C1->SR2;  // stray event, clear ADDR
+        I2C1->CR2 &= ~I2C_CR2_ITBUFEN;
+    } else if (sr1 & I2C_SR1_SB) {
+        I2C1->DR = (uint8_t)(tr->device->address << 1) | ((s_phase == PHASE_READ) ? 1U : 0U);
+    } else if (sr1 & I2C_SR1_ADDR) {
+        if ((s_phase == PHASE_READ) && (tr->rxLen == 1)) {
+            I2C1->CR1 &= ~I2C_CR1_ACK;  // NACK the only byte
+            (void)I2C1->SR2;
+            I2C1->CR1 |= I2C_CR1_STOP;
+        } else {
+            if (s_phase == PHASE_READ) {
+                I2C1->CR1 |= I2C_CR1_ACK;
+            }
+            (void)I2C1->SR2;
+        }
+        I2C1->CR2 |= I2C_CR2_ITBUFEN;
+    } else if (s_phase == PHASE_WRITE) {
+        if ((sr1 & I2C_SR1_TXE) && (s_index < tr->txLen)) {
+            I2C1->DR = tr->tx[s_index++];
+        } else if (sr1 & I2C_SR1_BTF) {
+            s_WriteDone();
+        } else {
+            I2C1->CR2 &= ~I2C_CR2_ITBUFEN;  // last byte loaded, wait for BTF
+        }
+    } else if ((s_phase == PHASE_READ) && (sr1 & I2C_SR1_RXNE)) {
+        if (tr->rxLen - s_index == 2) {
+            I2C1->CR1 &= ~I2C_CR1_ACK;
+            I2C1->CR1 |= I2C_CR1_STOP;
+        }
+        tr->rx[s_index++] = (uint8_t)I2C1->DR;
+        if (s_index >= tr->rxLen) {
+            s_Complete(I2C_BUS_DONE);
+        }
+    }
+    PROFILER_END(PROF_ZONE_ISR_I2C1_EV);
+    IRQ_STATS_EXIT(IRQ_STAT_I2C1_EV);
+}
+
+/**
+ * \brief I2C1 error interrupt handler, completes the active transaction with the error
+ * \author agent, agent@local, Oct.2026
+ */
+void I2C1_ER_IRQHandler(void) {
+    uint32_t sr1 = I2C1->SR1;
+
+    I2C1->SR1 = ~(sr1 & (I2C_SR1_AF | I2C_SR1_BERR | I2C_SR1_ARLO | I2C_SR1_OVR));
+    if (sr1 & I2C_SR1_AF) {
+        I2C1->CR1 |= I2C_CR1_STOP;  // release the bus after the NACK
+    } else {
+        s_Reset();  // bus error or arbitration lost, the peripheral may be stuck
+    }
+    if (NULL == s_active) {
+        return;
+    }
+    TIM6->CR1 &= ~TIM_CR1_CEN;
+    s_Complete((sr1 & I2C_SR1_AF) ? I2C_BUS_ERR_NACK : I2C_BUS_ERR_BUS);
+}
+
+/**
+ * \brief TIM6 interrupt handler, end of the wait phase or of a STOP check before a START
+ * \author agent, agent@local, Oct.2026
+ */
+void TIM6_IRQHandler(void) {
+    TIM6->SR = 0;
+    if (NULL == s_active) {
+        return;
+    }
+    if (s_startDeferred) {
+        s_Start();
+        return;
+    }
+    if (s_phase != PHASE_WAIT) {
+        return;
+    }
+    if (s_active->rxLen > 0) {
+        s_phase = PHASE_READ;
+        s_index = 0;
+        s_Start();
+    } else {
+        s_Complete(I2C_BUS_DONE);
+    }
+}
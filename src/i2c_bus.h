@@ -0,0 +1,70 @@
+/*
+ * i2c_bus.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef I2C_BUS_H_
+#define I2C_BUS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Interrupt driven I2C1 bus manager.
+ *
+ * Every sensor driver owns an i2c_device_t handle for its address and submits i2c_transaction_t
+ * objects to one queue, ordered by device priority and then by submission order. A transaction
+ * is an optional write phase, an optional wait for the execution time of the command and an
+ * optional read phase. The phases run in the I2C1 event/error handlers and the wait phase on
+ * TIM6, so queued transactions of all devices run back to back without CPU polling.
+ *
+ * The write phase ends with a STOP when a wait follows, or with a repeated START when the read
+ * phase follows immediately. A START right after a STOP is deferred to TIM6 until the STOP has
+ * ended. A NACK, bus error or arbitration loss completes the transaction with an error instead of
+ * stalling the bus.
+ */
+#define I2C_BUS_QUEUE_LEN     8U    // pending transactions of all devices
+#define I2C_BUS_TX_MAX        12U   // command + data bytes of the write phase
+#define I2C_BUS_STOP_WAIT_US  100U  // bound of the STOP generation before the next START
+#define I2C_BUS_STOP_POLL_US  10U   // TIM6 interval of the STOP checks, no busy wait in handlers
+#define I2C_BUS_PRIORITY_HIGH 0U    // lower value runs first
+#define I2C_BUS_PRIORITY_LOW  3U
+
+typedef enum {
+    I2C_BUS_DONE = 0,    // completed successfully
+    I2C_BUS_PENDING,     // queued, not started
+    I2C_BUS_BUSY,        // on the bus or in its wait phase
+    I2C_BUS_ERR_NACK,    // address or data byte not acknowledged
+    I2C_BUS_ERR_BUS,     // bus error, arbitration lost or overrun
+    I2C_BUS_ERR_TIMEOUT  // aborted by i2cBus_Wait
+} I2C_BUS_STATUS;
+
+typedef struct i2c_device_type {
+    uint8_t  address;   // 7-bit address, 0x00 is the general call
+    uint8_t  priority;  // I2C_BUS_PRIORITY_HIGH...I2C_BUS_PRIORITY_LOW
+    uint16_t errors;    // failed transactions since power-on
+} i2c_device_t;
+
+typedef struct i2c_transaction_type i2c_transaction_t;
+
+struct i2c_transaction_type {
+    i2c_device_t    *device;
+    uint8_t          tx[I2C_BUS_TX_MAX];  // write phase bytes
+    uint8_t          txLen;               // 0 = no write phase
+    uint8_t          rxLen;               // 0 = no read phase
+    uint8_t         *rx;                  // read phase buffer, rxLen bytes
+    uint16_t         waitMs;              // command execution time after the write phase
+    volatile uint8_t status;              // I2C_BUS_STATUS
+    void (*done)(i2c_transaction_t *const tr);  // called from the handler, may be NULL
+};
+
+void           i2cBus_Init(void);
+void           i2cBus_DeviceInit(i2c_device_t *const dev, const uint8_t address,
+                                 const uint8_t priority);
+int32_t        i2cBus_Submit(i2c_transaction_t *const tr);
+I2C_BUS_STATUS i2cBus_Wait(i2c_transaction_t *const tr, const uint32_t timeout_ms);
+I2C_BUS_STATUS i2cBus_Transfer(i2c_transaction_t *const tr, const uint32_t timeout_ms);
+
+#endif /* I2C_BUS_H_ */
@@ -0,0 +1,176 @@
+/*
+ * irq_stats.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+#include "irq_stats.h"
+
+#include "profiler.h"
+
+#define IRQ_STATS_NOT_PENDING 0U
+
+static irq_stats_t s_stats[IRQ_STAT_COUNT];
+static uint32_t    s_entry[IRQ_STAT_COUNT];        // entry timestamp of the running handler
+static uint32_t    s_pendingSince[IRQ_STAT_COUNT];  // upper bound of the time the IRQ got pending
+static uint32_t    s_active = 0;                    // number of tracked handlers currently running
+
+#if defined(STM32L152xE)
+static const IRQn_Type s_irqn[IRQ_STAT_COUNT] = {DMA1_Channel5_IRQn, USART1_IRQn,
+                                                 DMA1_Channel6_IRQn, USART2_IRQn, I2C1_EV_IRQn};
+#endif
+
+/* Private functions */
+static inline uint32_t s_Bucket(const uint32_t cycles) {
+    uint32_t us     = cycles / PROFILER_TICKS_PER_US;
+    uint32_t bucket = 0;
+    for (us >>= 2; (us != 0) && (bucket < IRQ_STATS_BUCKETS - 1); us >>= 2) {
+        bucket++;
+    }
+    return bucket;
+}
+
+static inline void s_HistAdd(uint16_t *const hist, const uint32_t cycles) {
+    uint32_t bucket = s_Bucket(cycles);
+    if (hist[bucket] != UINT16_MAX) {
+        hist[bucket]++;
+    }
+}
+
+static inline uint16_t s_CyclesToUs(const uint64_t cycles) {
+    uint64_t us = cycles / PROFILER_TICKS_PER_US;
+    return (us > UINT16_MAX) ? UINT16_MAX : (uint16_t)us;
+}
+
+/* Public functions */
+/**
+ * \brief Clear all interrupt statistics. Requires profiler_Init() for the time base.
+ * \author agent, agent@local, Oct.2026
+ */
+void irqStats_Init(void) {
+    for (uint32_t i = 0; i < IRQ_STAT_COUNT; i++) {
+        irq_stats_t *s   = &s_stats[i];
+        s->count         = 0;
+        s->nested        = 0;
+        s->latencyMax    = 0;
+        s->durationMax   = 0;
+        s->durationTotal = 0;
+        for (uint32_t b = 0; b < IRQ_STATS_BUCKETS; b++) {
+            s->latencyHist[b]  = 0;
+            s->durationHist[b] = 0;
+        }
+        s_pendingSince[i] = IRQ_STATS_NOT_PENDING;
+    }
+    s_active = 0;
+}
+
+/**
+ * \brief Timestamp the entry of an interrupt handler, call first thing in the handler
+ * \param[in] id - The tracked interrupt
+ * \author agent, agent@local, Oct.2026
+ * \details The latency is the time the IRQ stayed pending behind another tracked handler. It is
+ * an upper bound: the pending state is sampled when the blocking handler exits and dated back to
+ * the entry of that handler. An IRQ that was served without being blocked counts as zero latency.
+ */
+void irqStats_Enter(const IRQ_STAT_ID id) {
+    uint32_t     now     = profiler_Now();
+    uint32_t     latency = 0;
+    irq_stats_t *s       = &s_stats[id];
+
+    if (s_pendingSince[id] != IRQ_STATS_NOT_PENDING) {
+        latency            = now - s_pendingSince[id];
+        s_pendingSince[id] = IRQ_STATS_NOT_PENDING;
+    }
+    if (latency > s->latencyMax) {
+        s->latencyMax = latency;
+    }
+    s_HistAdd(s->latencyHist, latency);
+
+    if (s_active > 0) {
+        s->nested++;
+    }
+    s_active++;
+    s->count++;
+    s_entry[id] = now;
+}
+
+/**
+ * \brief Timestamp the exit of an interrupt handler, call last thing in the handler
+ * \param[in] id - The tracked interrupt
+ * \author agent, agent@local, Oct.2026
+ */
+void irqStats_Exit(const IRQ_STAT_ID id) {
+    uint32_t     duration = profiler_Now() - s_entry[id];
+    irq_stats_t *s        = &s_stats[id];
+
+    if (duration > s->durationMax) {
+        s->durationMax = duration;
+    }
+    s->durationTotal += duration;
+    s_HistAdd(s->durationHist, duration);
+
+#if defined(STM32L152xE)
+    // Everything that got pending meanwhile was blocked by this handler
+    for (uint32_t i = 0; i < IRQ_STAT_COUNT; i++) {
+        if ((i != id) && (s_pendingSince[i] == IRQ_STATS_NOT_PENDING) &&
+            NVIC_GetPendingIRQ(s_irqn[i])) {
+            // 0 is reserved for "not pending", a timestamp of 0 is moved by one cycle
+            s_pendingSince[i] = (s_entry[id] != IRQ_STATS_NOT_PENDING) ? s_entry[id] : 1U;
+        }
+    }
+#endif
+    s_active--;
+}
+
+/**
+ * \brief Get a copy of the statistics of an interrupt
+ * \param[in] id - The tracked interrupt
+ * \return The statistics of the interrupt
+ */
+irq_stats_t irqStats_Get(const IRQ_STAT_ID id) { return s_stats[id]; }
+
+/**
+ * \brief Read one diagnostic register
+ * \param[in] reg_addr - Register address, IRQ_STATS_REG_ADDR_MIN...IRQ_STATS_REG_ADDR_MAX
+ * \param[out] value - The register value
+ * \return 0 when success, -1 when the address is not a diagnostic register
+ * \author agent, agent@local, Oct.2026
+ */
+int32_t irqStats_ReadRegister(const uint16_t reg_addr, uint16_t *const value) {
+    if ((reg_addr < IRQ_STATS_REG_ADDR_MIN) || (reg_addr > IRQ_STATS_REG_ADDR_MAX)) {
+        return -1;
+    }
+    uint16_t           index  = reg_addr - IRQ_STATS_REG_ADDR_MIN;
+    uint16_t           offset = index % IRQ_STATS_REG_BLOCK_SIZE;
+    const irq_stats_t *s      = &s_stats[index / IRQ_STATS_REG_BLOCK_SIZE];
+
+    if ((offset >= IRQ_STATS_REG_LATENCY_HIST) &&
+        (offset < IRQ_STATS_REG_LATENCY_HIST + IRQ_STATS_BUCKETS)) {
+        *value = s->latencyHist[offset - IRQ_STATS_REG_LATENCY_HIST];
+    } else if ((offset >= IRQ_STATS_REG_DURATION_HIST) &&
+               (offset < IRQ_STATS_REG_DURATION_HIST + IRQ_STATS_BUCKETS)) {
+        *value = s->durationHist[offset - IRQ_STATS_REG_DURATION_HIST];
+    } else {
+        switch (offset) {
+            case IRQ_STATS_REG_COUNT:
+                *value = (uint16_t)(s->count & 0xffff);
+                break;
+            case IRQ_STATS_REG_LATENCY_MAX:
+                *value = s_CyclesToUs(s->latencyMax);
+                break;
+            case IRQ_STATS_REG_DURATION_MAX:
+                *value = s_CyclesToUs(s->durationMax);
+                break;
+            case IRQ_STATS_REG_DURATION_AVG:
+                *value = (s->count == 0) ? 0 : s_CyclesToUs(s->durationTotal / s->count);
+                break;
+            case IRQ_STATS_REG_NESTED:
+                *value = (uint16_t)(s->nested & 0xffff);
+                break;
+            default:
+                *value = 0;  // reserved
+                break;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,79 @@
+/*
+ * irq_stats.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef IRQ_STATS_H_
+#define IRQ_STATS_H_
+
+#include <stdint.h>
+
+#define IRQ_STATS_EN 1
+
+/*
+ * NVIC priority scheme. All 4 implemented priority bits are used for preemption, lower value
+ * preempts higher value. RS-485 RX (Modbus slave) must be able to preempt the I2C and debug
+ * console handlers so that the reply to the master is never delayed by them.
+ */
+#define IRQ_PRIORITY_GROUPING     3U  // PRIGROUP=3, 4 bits preemption priority, 0 bits subpriority
+#define IRQ_PRIORITY_RS485_RX     0U  // USART1, DMA1_Channel5
+#define IRQ_PRIORITY_I2C          1U  // I2C1 event/error, TIM6 (I2C bus manager wait phase)
+#define IRQ_PRIORITY_CONSOLE      2U  // USART2, DMA1_Channel6
+#define IRQ_PRIORITY_RS485_MASTER 3U  // USART3, TIM7 (Modbus master on the sub-bus)
+
+/* Histogram buckets, x4 per bucket: <4us, <16us, <64us, <256us, <1ms, <4ms, <16ms, >=16ms */
+#define IRQ_STATS_BUCKETS 8U
+
+/* Tracked interrupt handlers */
+typedef enum {
+    IRQ_STAT_DMA1_CH5 = 0,
+    IRQ_STAT_USART1,
+    IRQ_STAT_DMA1_CH6,
+    IRQ_STAT_USART2,
+    IRQ_STAT_I2C1_EV,
+    IRQ_STAT_COUNT
+} IRQ_STAT_ID;
+
+/*
+ * Diagnostic register layout, one block of IRQ_STATS_REG_BLOCK_SIZE registers per IRQ_STAT_ID,
+ * starting from IRQ_STATS_REG_ADDR_MIN. Times are in microseconds, saturated to 0xffff.
+ */
+#define IRQ_STATS_REG_ADDR_MIN      0x0100U
+#define IRQ_STATS_REG_BLOCK_SIZE    0x20U
+#define IRQ_STATS_REG_ADDR_MAX \
+    (IRQ_STATS_REG_ADDR_MIN + IRQ_STAT_COUNT * IRQ_STATS_REG_BLOCK_SIZE - 1)
+#define IRQ_STATS_REG_COUNT         0x00U  // number of entries, low 16 bits
+#define IRQ_STATS_REG_LATENCY_MAX   0x01U
+#define IRQ_STATS_REG_DURATION_MAX  0x02U
+#define IRQ_STATS_REG_DURATION_AVG  0x03U
+#define IRQ_STATS_REG_NESTED        0x04U  // number of entries that preempted another handler
+#define IRQ_STATS_REG_LATENCY_HIST  0x08U  // IRQ_STATS_BUCKETS registers
+#define IRQ_STATS_REG_DURATION_HIST 0x10U  // IRQ_STATS_BUCKETS registers
+
+typedef struct irq_stats_type {
+    uint32_t count;
+    uint32_t nested;
+    uint32_t latencyMax;     // cycles
+    uint32_t durationMax;    // cycles
+    uint64_t durationTotal;  // cycles
+    uint16_t latencyHist[IRQ_STATS_BUCKETS];
+    uint16_t durationHist[IRQ_STATS_BUCKETS];
+} irq_stats_t;
+
+void        irqStats_Init(void);
+void        irqStats_Enter(const IRQ_STAT_ID id);
+void        irqStats_Exit(const IRQ_STAT_ID id);
+irq_stats_t irqStats_Get(const IRQ_STAT_ID id);
+int32_t     irqStats_ReadRegister(const uint16_t reg_addr, uint16_t *const value);
+
+#if (IRQ_STATS_EN > 0u)
+#define IRQ_STATS_ENTER(id) irqStats_Enter(id)
+#define IRQ_STATS_EXIT(id)  irqStats_Exit(id)
+#else
+#define IRQ_STATS_ENTER(id)
+#define IRQ_STATS_EXIT(id)
+#endif
+
+#endif /* IRQ_STATS_H_ */
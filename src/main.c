@@ -9,10 +9,23 @@ Info:     Generated by Atollic TrueSTUDIO(R) 9.3.0   2023-02-24
 #include <stddef.h>
 #include <stdio.h>
 
-#include "i2c.h"
+#include "alarm.h"
+#include "crc.h"
+#include "dht22.h"
+#include "eeprom.h"
+#include "history.h"
+#include "humidity.h"
+#include "i2c_bus.h"
+#include "irq_stats.h"
 #include "iwdg.h"
+#include "modbus_map.h"
+#include "modbus_master.h"
 #include "modbus_rtu.h"
+#include "profiler.h"
+#include "raw_signal.h"
+#include "report.h"
 #include "sgp30.h"
+#include "supervisor.h"
 #include "sysclock_config.h"
 #include "usart_config.h"
 #include "utils.h"
@@ -23,17 +36,8 @@ Info:     Generated by Atollic TrueSTUDIO(R) 9.3.0   2023-02-24
 
 #define DBUG_MSG_LEN     100
 
-uint16_t rFlag = 0;  // Modbus RTU register flag
-#define RFLAG_CO2         (uint16_t)0x01
-#define RFLAG_TVOC        (uint16_t)0x02
-#define RFLAG_BASE_CO2    (uint16_t)0x04
-#define RFLAG_BASE_TVOC   (uint16_t)0x08
-#define RFLAG_RAW_H2      (uint16_t)0x10
-#define RFLAG_RAW_ETHANOL (uint16_t)0x20
-#define RFLAG_FEATURE_SET (uint16_t)0x40
-#define RFLAG_SERIAL_ID   (uint16_t)0x80
-
-int32_t u1tcFlag = 0;  // USART1 Transmite complete flag
+uint16_t rFlag = 0;  // Modbus RTU register flag, RFLAG_* in modbus_map.h
+
 #define TRUE  (int32_t)1
 #define FALSE (int32_t)0
 
@@ -47,8 +51,6 @@ sgp30_t sgp_data;
 
 /* Private function prototypes */
 void               modbusRtu_SendData(const uint8_t *const data, const size_t data_length);
-MODBUS_RTU_ERR     modbusRtu_TryReadInputRegister(const uint8_t *const modbus_rtu_frame, void *data,
-                                               uint8_t *reply_data, uint8_t *reply_data_len);
 static inline void LED2_init(void);
 /**
 **===========================================================================
@@ -63,64 +65,85 @@ int main(void) {
     /* Configure the system clock to 32 MHz and update SystemCoreClock */
     SetSysClock();
     SystemCoreClockUpdate();
+    tick_init();
+    profiler_Init();
+    irqStats_Init();
+    crc_Init();
+    NVIC_SetPriorityGrouping(IRQ_PRIORITY_GROUPING);
 
     /* TODO - Add your application code here */
     USART1_dma_init();
     USART2_dma_init();
-    I2C1_init();
+#if (MODBUS_MASTER_EN > 0u)
+    modbusMaster_Init();
+#endif
+    i2cBus_Init();
+    dht22_Init();
     IWDG_init();
+    eeprom_Init();
     LED2_init();
     sgp_data = sgp30_create();
+    rawSignal_Init();
+    history_Init();
+    report_Init();
+    alarm_Init();
+    supervisor_Init();
+    __enable_irq();  // the I2C transfers below run in the I2C1/TIM6 handlers
 
-    int32_t  sgp30IsOnline      = FALSE;
-    uint32_t setBaselineCounter = 0u;
-
-#if (DEBUG_CONSOLE_EN > 0u)
-    char debug_msg[DBUG_MSG_LEN];
-    debug_console("App started...\n\r");
-#endif
-    if (SGP30_SUCCESS != sgp30_GetSerialId(&sgp_data)) {
-        rFlag &= ~RFLAG_SERIAL_ID;
-#if (DEBUG_CONSOLE_EN > 0u)
-        debug_console("Error! sgp30_GetSerialId failed!\n\r");
-#endif
-    } else {
-        sgp30IsOnline = TRUE;
-        rFlag         |= RFLAG_SERIAL_ID;
-#if (DEBUG_CONSOLE_EN > 0u)
-        debug_console("sgp30_GetSerialId success!\n\r");
-        snprintf(debug_msg, DBUG_MSG_LEN, "Serial ID:%#llx\n\r", sgp_data.serialID);
-        debug_console(debug_msg);
+    int32_t          sgp30IsOnline      = FALSE;
+    SGP30ERR         sgp30Err           = SGP30_SUCCESS;
+    uint32_t         setBaselineCounter = 0u;
+    uint32_t         loopStart          = 0u;
+    uint32_t         absHumidity        = 0u;
+    uint32_t         dht22Counter       = 0u;
+    history_record_t record;
+#if (PROFILER_EN > 0u)
+    uint32_t profilerReportCounter = 0u;
 #endif
-    }
 
-    if (sgp30IsOnline) {
-        if (SGP30_SUCCESS != sgp30_GetFeatureSetVersion(&sgp_data)) {
-            rFlag &= RFLAG_FEATURE_SET;
 #if (DEBUG_CONSOLE_EN > 0u)
-            debug_console("Error! spg30_GetFeatureSetVersion failed!\n\r");
-#endif
-        } else {
-            rFlag |= RFLAG_FEATURE_SET;
-#if (DEBUG_CONSOLE_EN > 0u)
-            debug_console("spg30_GetFeatureSetVersion success!\n\r");
-            snprintf(debug_msg, DBUG_MSG_LEN, "Feature set:%#x\n\r", sgp_data.featureSetVersion);
-            debug_console(debug_msg);
+    char     debug_msg[DBUG_MSG_LEN];
+    uint16_t reportedFaults = 0u;  // supervisor faults already reported on the console
+    debug_console("App started...\n\r");
 #endif
-        }
-    }
-
-    sgp30_InitAirQuality();
-    __enable_irq();
     /* Infinite loop */
     while (1) {
+        loopStart = tick_ms();
         IWDG_feed();  // Feed watchdog
+#if (MODBUS_MASTER_EN > 0u)
+        modbusMaster_StartCycle();  // the sub-bus is polled in the background
+#endif
 
-        rFlag &= ~(RFLAG_CO2 | RFLAG_TVOC | RFLAG_BASE_CO2 | RFLAG_BASE_TVOC | RFLAG_RAW_H2 |
-                   RFLAG_RAW_ETHANOL);  // clear bits
+        // Baseline flags are kept, the baseline is refreshed only every hour. Raw flags are kept
+        // for the window published in the previous loop.
+        rFlag &= ~(RFLAG_CO2 | RFLAG_TVOC);  // clear bits
 
         setBaselineCounter++;
 
+        // SGP30 detection, re-initialization after a fault and the baseline restore
+        sgp30IsOnline = supervisor_Run(&sgp_data);
+#if (DEBUG_CONSOLE_EN > 0u)
+        if (sgp30IsOnline && (sup_data.uptime == 0)) {
+            snprintf(debug_msg, DBUG_MSG_LEN, "SGP30 online, serial ID:%#llx, feature set:%#x\n\r",
+                     sgp_data.serialID, sgp_data.featureSetVersion);
+            debug_console(debug_msg);
+        }
+#endif
+
+        // DHT22: decode the transfer started DHT22_PERIOD_S ago and start the next one. A valid
+        // reading replaces the compensation inputs written by the Modbus master.
+        if (++dht22Counter >= DHT22_PERIOD_S) {
+            if (DHT22_SUCCESS == dht22_Read(&dht_data)) {
+                hum_data.temperature = dht_data.temperature;
+                hum_data.rh          = dht_data.rh;
+                rFlag                |= RFLAG_DHT22;
+            } else {
+                rFlag &= ~RFLAG_DHT22;
+            }
+            dht22_Start();
+            dht22Counter = 0;
+        }
+
         if (sgp30IsOnline) {
             // According to datasheet, SGP30 baseline values need to be set at about 1 hour interval
             if (setBaselineCounter >= 3600U) {
@@ -128,7 +151,7 @@ int main(void) {
 #if (DEBUG_CONSOLE_EN > 0u)
                     debug_console("Error! spg30_GetBaseline failed!\n\r");
 #endif
-                    rFlag &= (RFLAG_BASE_CO2 | RFLAG_BASE_TVOC);
+                    rFlag &= ~(RFLAG_BASE_CO2 | RFLAG_BASE_TVOC);
                 } else {
 #if (DEBUG_CONSOLE_EN > 0u)
                     debug_console("spg30_GetBaseline success!\n\r");
@@ -138,13 +161,31 @@ int main(void) {
 #endif
                     rFlag |= (RFLAG_BASE_CO2 | RFLAG_BASE_TVOC);
                     sgp30_SetBaseline(sgp_data.baselineCO2, sgp_data.baselineTVOC);
+                    supervisor_SaveBaseline(sgp_data.baselineCO2, sgp_data.baselineTVOC);
                 }
                 setBaselineCounter = 0;
             }
 
+            // Humidity compensation, the SGP30 is updated only when the 8.8 value changes. Without
+            // a valid input the sensor falls back to its default humidity.
+            if ((hum_data.rh != HUMIDITY_RH_UNKNOWN) &&
+                (0 == humidity_Absolute(hum_data.temperature, hum_data.rh, &absHumidity))) {
+                if (!(rFlag & RFLAG_HUMIDITY) ||
+                    (hum_data.absolute != humidity_ToSgp30(absHumidity))) {
+                    hum_data.absolute = humidity_ToSgp30(absHumidity);
+                    sgp30_SetAbsoluteHumidity(hum_data.absolute);
+                    rFlag |= RFLAG_HUMIDITY;
+                }
+            } else if (rFlag & RFLAG_HUMIDITY) {
+                sgp30_SetAbsoluteHumidity(0x0000);
+                rFlag &= ~RFLAG_HUMIDITY;
+            }
+
             // According to datasheet, SGP30 MeasureAirQuality need to be called at about 1s
             // interval in order to work at maximum accuracy
-            if (SGP30_SUCCESS != sgp30_MeasureAirQuality(&sgp_data)) {
+            sgp30Err = sgp30_MeasureAirQuality(&sgp_data);
+            supervisor_Result(sgp30Err);
+            if (SGP30_SUCCESS != sgp30Err) {
                 rFlag &= ~(RFLAG_CO2 | RFLAG_TVOC);
 #if (DEBUG_CONSOLE_EN > 0u)
                 debug_console("Error! spg30_MeasureAirQuality failed!\n\r");
@@ -159,14 +200,64 @@ int main(void) {
                 debug_console(debug_msg);
 #endif
             }
-        } else {
+        }
 #if (DEBUG_CONSOLE_EN > 0u)
-            debug_console("Error! SGP30 is offline!\n\r");
+        // Once per fault, on the transition to BACKOFF by the probe or by the measurement
+        if (sup_data.faults != reportedFaults) {
+            reportedFaults = sup_data.faults;
+            snprintf(debug_msg, DBUG_MSG_LEN,
+                     "Error! SGP30 is offline, fault %u, next probe in %us\n\r", sup_data.faults,
+                     sup_data.wait);
+            debug_console(debug_msg);
+        }
 #endif
+
+        // Change event when CO2eq/TVOC leave their deadbands, masters skip unchanged nodes.
+        // Alarm thresholds are evaluated on the same measurement.
+        report_Update((rFlag & RFLAG_CO2) != 0, sgp_data.CO2, sgp_data.TVOC);
+        alarm_Update((rFlag & RFLAG_CO2) != 0, sgp_data.CO2, sgp_data.TVOC);
+
+        // One record per loop, also when the measurement failed, to keep the 1Hz record timing
+        // Raw signals are the window means of the previous loop
+        record.value[HISTORY_CH_CO2]     = (rFlag & RFLAG_CO2) ? sgp_data.CO2 : HISTORY_INVALID;
+        record.value[HISTORY_CH_TVOC]    = (rFlag & RFLAG_TVOC) ? sgp_data.TVOC : HISTORY_INVALID;
+        record.value[HISTORY_CH_H2]      = (rFlag & RFLAG_RAW_H2) ? raw_data.h2.mean
+                                                                  : HISTORY_INVALID;
+        record.value[HISTORY_CH_ETHANOL] = (rFlag & RFLAG_RAW_ETHANOL) ? raw_data.ethanol.mean
+                                                                       : HISTORY_INVALID;
+        history_Push(&record, loopStart / 1000U);
+
+        // Raw streaming fills the rest of the 1s MeasureAirQuality period with raw H2/Ethanol
+        // samples, they are decimated on the fly and summarized once per period
+        if (sgp30IsOnline && (raw_data.mode == RAW_MODE_STREAMING)) {
+            while ((tick_ms() - loopStart) < (1000U - RAW_SIGNAL_SAMPLE_TIME_MS)) {
+                if (SGP30_SUCCESS != sgp30_MeasureRawSignals(&sgp_data)) {
+                    break;
+                }
+                rawSignal_AddSample(sgp_data.H2, sgp_data.ethanol);
+            }
         }
+        if ((raw_data.mode == RAW_MODE_STREAMING) && (0 == rawSignal_CloseWindow())) {
+            rFlag |= (RFLAG_RAW_H2 | RFLAG_RAW_ETHANOL);
+        } else {
+            rFlag &= ~(RFLAG_RAW_H2 | RFLAG_RAW_ETHANOL);
+        }
+
+#if (PROFILER_EN > 0u) && (DEBUG_CONSOLE_EN > 0u)
+        if (++profilerReportCounter >= PROFILER_REPORT_PERIOD_S) {
+            profiler_Report(debug_console);
+            profilerReportCounter = 0;
+        }
+#endif
 
-        GPIOA->ODR ^= 0x20;  //  Blink led
-        delay_ms(1000);
+        if (alarm_data.ledAlarm && alarm_Active()) {
+            GPIOA->ODR |= 0x20;  // LED on during an alarm
+        } else {
+            GPIOA->ODR ^= 0x20;  //  Blink led
+        }
+        while ((tick_ms() - loopStart) < 1000U) {
+            // keep the 1s period regardless of the time spent in the loop body
+        }
     }
     return 0;
 }
@@ -178,6 +269,8 @@ int main(void) {
  * \author  Siyuan Xu,
  */
 void DMA1_Channel5_IRQHandler(void) {
+    IRQ_STATS_ENTER(IRQ_STAT_DMA1_CH5);
+    PROFILER_BEGIN(PROF_ZONE_ISR_DMA1_CH5);
     /* Check half-transfer complete interrupt */
     if (DMA1->ISR & DMA_ISR_HTIF5) {
 #if (DEBUG_CONSOLE_EN > 0u)
@@ -191,22 +284,13 @@ void DMA1_Channel5_IRQHandler(void) {
 #if (DEBUG_CONSOLE_EN > 0u)
         debug_console("USART1 DMA transfer-complete interrupt!\r\n");
 #endif
-        u1tcFlag   = TRUE;
         DMA1->IFCR |= DMA_IFCR_CTCIF5; /*!< Channel 5 Transfer Complete clear */
-        if (MODBUS_RTU_SUCCESS !=
-            modbusRtu_AddressValidation(usart1_rx_dma_buffer[SLAVE_ADDRESS])) {
-#if (DEBUG_CONSOLE_EN > 0u)
-            debug_console("Not my address, discard the frame!\r\n");
-#endif
-        } else {
-            modbusRtu_RunRequest(usart1_rx_dma_buffer, (void *)(&sgp_data));
-#if (DEBUG_CONSOLE_EN > 0u)
-            debug_console("My address, Run Modbus request!\r\n");
-#endif
-        }
+        // The buffer filled up before the idle line, the frame is longer than any request
         USART1_RX_Buffer_Reset();
         DMA1_Channel15_Reload();
     }
+    PROFILER_END(PROF_ZONE_ISR_DMA1_CH5);
+    IRQ_STATS_EXIT(IRQ_STAT_DMA1_CH5);
 }
 
 /**
@@ -214,28 +298,43 @@ void DMA1_Channel5_IRQHandler(void) {
  * \author  Siyuan xu, e2101066@edu.vamk.fi, Feb.2023
  */
 void USART1_IRQHandler(void) {
+    IRQ_STATS_ENTER(IRQ_STAT_USART1);
+    PROFILER_BEGIN(PROF_ZONE_ISR_USART1);
     uint32_t status = USART1->SR;
+    uint16_t received;
     uint8_t  data __attribute__((unused));
+    /* Check for transmission complete, the reply is sent */
+    if ((USART1->CR1 & USART_CR1_TCIE) && (status & USART_SR_TC)) {
+        rs485_tx_complete();
+    }
     /* Check for IDLE line interrupt */
     if (status & USART_SR_IDLE) {
 #if (DEBUG_CONSOLE_EN > 0u)
         debug_console("USART1 Idle-line interrupt!\r\n");
 #endif
-        data = USART1->DR; /* Clear IDLE line flag */
-        if (u1tcFlag == TRUE) {
-            u1tcFlag = FALSE;
-        } else {
-            // Error condition when USART1 DMA transmit complete flag is false and IDLE line
-            // interrupt fires, reset DMA1 and buffer
+        data     = USART1->DR; /* Clear IDLE line flag */
+        received = USART1_RX_DMA_BUFFER_SIZE - DMA1_Channel5->CNDTR;
+        // Nothing received when the line goes idle after our own reply
+        if (received > 0) {
+            if (MODBUS_RTU_SUCCESS !=
+                modbusRtu_AddressValidation(usart1_rx_dma_buffer[SLAVE_ADDRESS])) {
 #if (DEBUG_CONSOLE_EN > 0u)
-            debug_console(
-                "Tranmition error!"
-                "IDLE line detected, but transmition complete flag is FALSE!\n\r");
+                debug_console("Not my address, discard the frame!\r\n");
 #endif
+            } else {
+                PROFILER_BEGIN(PROF_ZONE_MODBUS_RUN_REQUEST);
+                modbusRtu_RunRequest(usart1_rx_dma_buffer, received, (void *)(&sgp_data));
+                PROFILER_END(PROF_ZONE_MODBUS_RUN_REQUEST);
+#if (DEBUG_CONSOLE_EN > 0u)
+                debug_console("My address, Run Modbus request!\r\n");
+#endif
+            }
             USART1_RX_Buffer_Reset();
             DMA1_Channel15_Reload();
         }
     }
+    PROFILER_END(PROF_ZONE_ISR_USART1);
+    IRQ_STATS_EXIT(IRQ_STAT_USART1);
 }
 
 /**
@@ -243,6 +342,8 @@ void USART1_IRQHandler(void) {
  * \author  Siyuan xu, e2101066@edu.vamk.fi, Feb.2023
  */
 void DMA1_Channel6_IRQHandler(void) {
+    IRQ_STATS_ENTER(IRQ_STAT_DMA1_CH6);
+    PROFILER_BEGIN(PROF_ZONE_ISR_DMA1_CH6);
     /* Check half-transfer complete interrupt */
     if (DMA1->ISR & DMA_ISR_HTIF6) {
 #if (DEBUG_CONSOLE_EN > 0u)
@@ -261,6 +362,8 @@ void DMA1_Channel6_IRQHandler(void) {
         DMA1->IFCR |= DMA_IFCR_CTCIF6; /*!< Channel 6 Transfer Complete clear */
         USART2_send_data(usart2_rx_dma_buffer, USART2_RX_DMA_BUFFER_SIZE);
     }
+    PROFILER_END(PROF_ZONE_ISR_DMA1_CH6);
+    IRQ_STATS_EXIT(IRQ_STAT_DMA1_CH6);
 }
 
 /**
@@ -268,6 +371,8 @@ void DMA1_Channel6_IRQHandler(void) {
  * \author  Siyuan xu, e2101066@edu.vamk.fi, Feb.2023
  */
 void USART2_IRQHandler(void) {
+    IRQ_STATS_ENTER(IRQ_STAT_USART2);
+    PROFILER_BEGIN(PROF_ZONE_ISR_USART2);
     uint32_t status = USART2->SR;
     uint8_t  data __attribute__((unused));
     /* Check for IDLE line interrupt */
@@ -279,6 +384,8 @@ void USART2_IRQHandler(void) {
         USART2_send_data(usart2_rx_dma_buffer, USART2_RX_DMA_BUFFER_SIZE);
         DMA1_Channel16_Reload();
     }
+    PROFILER_END(PROF_ZONE_ISR_USART2);
+    IRQ_STATS_EXIT(IRQ_STAT_USART2);
 }
 
 /* Private functions */
@@ -298,119 +405,7 @@ static inline void LED2_init(void) {
  * \param[in] data_length - The number of bytes
  * \author siyuan xu, e2101066@edu.vamk.fi, Mar.2023
  */
+_Static_assert(MODBUS_FRAME_MAX_LENGTH <= USART1_TX_DMA_BUFFER_SIZE, "RS-485 TX buffer too small");
 void modbusRtu_SendData(const uint8_t *const data, const size_t data_length) {
     rs485_send_data(data, data_length);
 }
-
-/**
- * \brief Local implementation for reading input register for Modbus RTU
- * \param[in] modbus_rtu_frame - Address + PDU + CRC, PDU = Function code + Data
- * \param[in] data - The address of the data to be sent, sgp30_t
- * \author siyuan xu, e2101066@edu.vamk.fi, Mar.2023
- */
-MODBUS_RTU_ERR modbusRtu_TryReadInputRegister(const uint8_t *const modbus_rtu_frame, void *data,
-                                           uint8_t *reply_data, uint8_t *reply_data_len) {
-    sgp30_t *sgp30_data    = (sgp30_t *)data;
-    uint16_t register_addr = ((uint16_t)modbus_rtu_frame[START_ADDRESS_HI] << 8) |
-                             (uint16_t)modbus_rtu_frame[START_ADDRESS_LOW];
-    MODBUS_RTU_ERR err;
-#if (DEBUG_CONSOLE_EN > 0u)
-    char debug_msg[100];
-#endif
-    err = modbusRtu_RegisterAddressValidation(register_addr);
-    if (err != MODBUS_RTU_SUCCESS) {
-#if (DEBUG_CONSOLE_EN > 0u)
-        debug_console("BAD REGISTER ADDR:");
-#endif
-    } else {
-        switch (register_addr) {
-            case REG_ADDR_CO2:
-                if (rFlag & RFLAG_CO2) {
-                    reply_data[SGP30_MSB] = (uint8_t)(sgp30_data->CO2 >> 8);
-                    reply_data[SGP30_LSB] = (uint8_t)(sgp30_data->CO2 & 0xff);
-                    *reply_data_len       = 2;
-#if (DEBUG_CONSOLE_EN > 0u)
-                    sprintf(debug_msg, "CO2eq:%u\n\r", sgp30_data->CO2);
-                    debug_console(debug_msg);
-#endif
-                    err = MODBUS_RTU_SUCCESS;
-                } else {
-                    err = MODBUS_RTU_ERR_DATA_UNAVAILABLE;
-                }
-                break;
-            case REG_ADDR_TVOC:
-                if (rFlag & RFLAG_TVOC) {
-                    reply_data[SGP30_MSB] = (uint8_t)(sgp30_data->TVOC >> 8);
-                    reply_data[SGP30_LSB] = (uint8_t)(sgp30_data->TVOC & 0xff);
-                    *reply_data_len       = 2;
-                    err                   = MODBUS_RTU_SUCCESS;
-                } else {
-                    err = MODBUS_RTU_ERR_DATA_UNAVAILABLE;
-                }
-                break;
-            case REG_ADDR_BASE_CO2:
-                if (rFlag & RFLAG_BASE_TVOC) {
-                    reply_data[SGP30_MSB] = (uint8_t)(sgp30_data->baselineCO2 >> 8);
-                    reply_data[SGP30_LSB] = (uint8_t)(sgp30_data->baselineCO2 & 0xff);
-                    *reply_data_len       = 2;
-                    err                   = MODBUS_RTU_SUCCESS;
-                } else {
-                    if (SGP30_SUCCESS != spg30_GetBaseLine(sgp30_data)) {
-                        rFlag &= ~(RFLAG_BASE_CO2 | RFLAG_BASE_TVOC);
-#if (DEBUG_CONSOLE_EN > 0u)
-                        debug_console("Error! spg30_GetBaseline failed!\n\r");
-#endif
-                        err = MODBUS_RTU_ERR_DATA_UNAVAILABLE;
-                    } else {
-                        reply_data[SGP30_MSB] = (uint8_t)(sgp30_data->baselineCO2 >> 8);
-                        reply_data[SGP30_LSB] = (uint8_t)(sgp30_data->baselineCO2 & 0xff);
-                        *reply_data_len       = 2;
-                        rFlag                 |= (RFLAG_BASE_CO2 | RFLAG_BASE_TVOC);
-#if (DEBUG_CONSOLE_EN > 0u)
-                        debug_console("spg30_GetBaseline success!\n\r");
-#endif
-                        err = MODBUS_RTU_SUCCESS;
-                    }
-                }
-                break;
-            case REG_ADDR_BASE_TVOC:
-                if (rFlag & RFLAG_BASE_TVOC) {
-                    reply_data[SGP30_MSB] = (uint8_t)(sgp30_data->baselineTVOC >> 8);
-                    reply_data[SGP30_LSB] = (uint8_t)(sgp30_data->baselineTVOC & 0xff);
-                    *reply_data_len       = 2;
-                    err                   = MODBUS_RTU_SUCCESS;
-                } else {
-                    if (SGP30_SUCCESS != spg30_GetBaseLine(sgp30_data)) {
-                        rFlag &= ~(RFLAG_BASE_CO2 | RFLAG_BASE_TVOC);
-#if (DEBUG_CONSOLE_EN > 0u)
-                        debug_console("Error! spg30_GetBaseline failed!\n\r");
-#endif
-                        err = MODBUS_RTU_ERR_DATA_UNAVAILABLE;
-                    } else {
-                        reply_data[SGP30_MSB] = (uint8_t)(sgp30_data->baselineTVOC >> 8);
-                        reply_data[SGP30_LSB] = (uint8_t)(sgp30_data->baselineTVOC & 0xff);
-                        *reply_data_len       = 2;
-                        rFlag                 |= (RFLAG_BASE_CO2 | RFLAG_BASE_TVOC);
-#if (DEBUG_CONSOLE_EN > 0u)
-                        debug_console("spg30_GetBaseline success!\n\r");
-#endif
-                        err = MODBUS_RTU_SUCCESS;
-                    }
-                }
-                break;
-            case REG_ADDR_FEATURE_SET:
-                err = MODBUS_RTU_SUCCESS;
-                break;
-            case REG_ADDR_RAW_H2:
-                err = MODBUS_RTU_SUCCESS;
-                break;
-            case REG_ADDR_RAW_ETHANOL:
-                err = MODBUS_RTU_SUCCESS;
-                break;
-            case REG_ADDR_SERIAL_ID:
-                err = MODBUS_RTU_SUCCESS;
-                break;
-        }
-    }
-    return err;
-}
@@ -0,0 +1,371 @@
+/*
+ * modbus_map.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+#include "modbus_map.h"
+
+#include <stddef.h>
+
+#include "alarm.h"
+#include "dht22.h"
+#include "history.h"
+#include "humidity.h"
+#include "irq_stats.h"
+#include "modbus_master.h"
+#include "raw_signal.h"
+#include "report.h"
+#include "sgp30.h"
+#include "supervisor.h"
+
+#define MODBUS_ACCESS_R  (uint8_t)0x01
+#define MODBUS_ACCESS_RW (uint8_t)0x03
+
+typedef struct modbus_register_type {
+    uint16_t (*read)(void);
+    void (*write)(const uint16_t value);  // NULL when read only
+    uint16_t flag;
+    uint8_t  access;
+} modbus_register_t;
+
+typedef struct modbus_block_type {
+    uint16_t base;
+    uint16_t count;
+    int32_t (*read)(const uint16_t reg_addr, uint16_t *const value);
+    uint8_t access;
+} modbus_block_t;
+
+extern sgp30_t sgp_data;
+
+/* One reader per register, returns the source expression of the map */
+#define MODBUS_MAP_READER(name, address, source, type, scale, unit, access, flag) \
+    static uint16_t s_Read_##name(void) { return (uint16_t)(source); }
+MODBUS_REGISTER_MAP(MODBUS_MAP_READER)
+#undef MODBUS_MAP_READER
+
+/* One writer per RW register, assigns the source expression of the map */
+#define MODBUS_MAP_WRITER_R(name, source)
+#define MODBUS_MAP_WRITER_RW(name, source) \
+    static void s_Write_##name(const uint16_t value) { (source) = value; }
+#define MODBUS_MAP_WRITER(name, address, source, type, scale, unit, access, flag) \
+    MODBUS_MAP_WRITER_##access(name, source)
+MODBUS_REGISTER_MAP(MODBUS_MAP_WRITER)
+#undef MODBUS_MAP_WRITER
+#define MODBUS_MAP_WRITE_FN_R(name)  NULL
+#define MODBUS_MAP_WRITE_FN_RW(name) s_Write_##name
+
+/* Compile-time check of the addresses */
+#define MODBUS_MAP_ASSERT(name, address, source, type, scale, unit, access, flag)                \
+    _Static_assert(((address) >= MODBUS_REGISTER_ADDR_MIN) &&                                  \
+                       ((address) <= MODBUS_REGISTER_ADDR_MAX),                                \
+                   "REG_ADDR_" #name " is outside MODBUS_REGISTER_ADDR_MIN/MAX");
+MODBUS_REGISTER_MAP(MODBUS_MAP_ASSERT)
+#undef MODBUS_MAP_ASSERT
+_Static_assert(IRQ_STATS_REG_ADDR_MIN == 0x0100, "IRQ_STATS block base mismatch");
+_Static_assert(IRQ_STAT_COUNT * IRQ_STATS_REG_BLOCK_SIZE <= 0x00A0, "IRQ_STATS block too small");
+_Static_assert(RAW_SIGNAL_REG_H2_SERIES == 0x0200, "RAW_SERIES block base mismatch");
+_Static_assert(2 * RAW_SIGNAL_SERIES_LEN == 0x0040, "RAW_SERIES block size mismatch");
+_Static_assert(HISTORY_REG_WINDOW == 0x0400, "HISTORY block base mismatch");
+_Static_assert(HISTORY_REG_WINDOW_SIZE == 0x007C, "HISTORY block size mismatch");
+_Static_assert(HISTORY_REG_BLOCK_WINDOW == 0x0480, "HIST_BLOCK block base mismatch");
+_Static_assert(HISTORY_REG_BLOCK_WINDOW_MIN == 0x0186, "HIST_BLOCK block size mismatch");
+_Static_assert(MODBUS_MASTER_REG_STATUS == 0x0700, "REMOTE_STAT block base mismatch");
+_Static_assert(MODBUS_POLL_COUNT * MODBUS_MASTER_STATUS_REGS <= 0x0080, "REMOTE_STAT too small");
+_Static_assert(MODBUS_MASTER_REG_CACHE == 0x0780, "REMOTE block base mismatch");
+_Static_assert(MODBUS_MASTER_CACHE_SIZE <= 0x0080, "REMOTE block too small");
+
+/* Compile-time check that the blocks follow the registers in address order without overlap, the
+ * lookup takes the first block that holds an address. Expands to
+ * (ADDR_MAX < base0) && (base0 + count0 <= base1) && ... && (baseN + countN <= 0x10000) */
+#define MODBUS_MAP_BLOCK_ORDER(name, base, count, reader, access) (base)) && ((base) + (count) <=
+_Static_assert((MODBUS_REGISTER_ADDR_MAX < MODBUS_REGISTER_BLOCKS(MODBUS_MAP_BLOCK_ORDER) 0x10000),
+               "register blocks overlap or are not in address order");
+#undef MODBUS_MAP_BLOCK_ORDER
+
+/* Register descriptors in map order */
+#define MODBUS_MAP_INDEX(name, address, source, type, scale, unit, access, flag) \
+    MODBUS_IDX_##name,
+enum { MODBUS_REGISTER_MAP(MODBUS_MAP_INDEX) MODBUS_REGISTER_COUNT };
+#undef MODBUS_MAP_INDEX
+
+#define MODBUS_MAP_DESCRIPTOR(name, address, source, type, scale, unit, access, flag) \
+    {s_Read_##name, MODBUS_MAP_WRITE_FN_##access(name), (flag), MODBUS_ACCESS_##access},
+static const modbus_register_t s_registers[MODBUS_REGISTER_COUNT] = {
+    MODBUS_REGISTER_MAP(MODBUS_MAP_DESCRIPTOR)};
+#undef MODBUS_MAP_DESCRIPTOR
+
+/* Constant-time lookup: register address -> descriptor index + 1, 0 when not mapped */
+#define MODBUS_MAP_ADDRESS_INDEX(name, address, source, type, scale, unit, access, flag) \
+    [(address)] = MODBUS_IDX_##name + 1,
+static const uint8_t s_addressIndex[MODBUS_REGISTER_ADDR_MAX + 1] = {
+    MODBUS_REGISTER_MAP(MODBUS_MAP_ADDRESS_INDEX)};
+#undef MODBUS_MAP_ADDRESS_INDEX
+
+#define MODBUS_MAP_BLOCK(name, base, count, reader, access) \
+    {(base), (count), reader, MODBUS_ACCESS_##access},
+static const modbus_block_t s_blocks[] = {MODBUS_REGISTER_BLOCKS(MODBUS_MAP_BLOCK)};
+#undef MODBUS_MAP_BLOCK
+
+/* One reader per discrete input and coil, one writer per coil */
+#define MODBUS_MAP_DI_READER(name, address, source) \
+    static uint8_t s_ReadDi_##name(void) { return (source) ? 1 : 0; }
+MODBUS_DISCRETE_INPUTS(MODBUS_MAP_DI_READER)
+#undef MODBUS_MAP_DI_READER
+#define MODBUS_MAP_COIL_READER(name, address, source) \
+    static uint8_t s_ReadCoil_##name(void) { return (source) ? 1 : 0; }
+MODBUS_COILS(MODBUS_MAP_COIL_READER)
+#undef MODBUS_MAP_COIL_READER
+#define MODBUS_MAP_COIL_WRITER(name, address, source) \
+    static void s_WriteCoil_##name(const uint8_t value) { (source) = value; }
+MODBUS_COILS(MODBUS_MAP_COIL_WRITER)
+#undef MODBUS_MAP_COIL_WRITER
+
+/* The bit addresses are the table indices */
+#define MODBUS_MAP_DI_INDEX(name, address, source) MODBUS_DI_IDX_##name,
+enum { MODBUS_DISCRETE_INPUTS(MODBUS_MAP_DI_INDEX) };
+#undef MODBUS_MAP_DI_INDEX
+#define MODBUS_MAP_COIL_INDEX(name, address, source) MODBUS_COIL_IDX_##name,
+enum { MODBUS_COILS(MODBUS_MAP_COIL_INDEX) };
+#undef MODBUS_MAP_COIL_INDEX
+#define MODBUS_MAP_DI_ASSERT(name, address, source) \
+    _Static_assert((address) == MODBUS_DI_IDX_##name, "DI_ADDR_" #name " is not contiguous");
+MODBUS_DISCRETE_INPUTS(MODBUS_MAP_DI_ASSERT)
+#undef MODBUS_MAP_DI_ASSERT
+#define MODBUS_MAP_COIL_ASSERT(name, address, source) \
+    _Static_assert((address) == MODBUS_COIL_IDX_##name, "COIL_ADDR_" #name " is not contiguous");
+MODBUS_COILS(MODBUS_MAP_COIL_ASSERT)
+#undef MODBUS_MAP_COIL_ASSERT
+
+#define MODBUS_MAP_DI_FN(name, address, source) s_ReadDi_##name,
+static uint8_t (*const s_diReaders[MODBUS_DI_COUNT])(void) = {
+    MODBUS_DISCRETE_INPUTS(MODBUS_MAP_DI_FN)};
+#undef MODBUS_MAP_DI_FN
+#define MODBUS_MAP_COIL_FN(name, address, source) s_ReadCoil_##name,
+static uint8_t (*const s_coilReaders[MODBUS_COIL_COUNT])(void) = {
+    MODBUS_COILS(MODBUS_MAP_COIL_FN)};
+#undef MODBUS_MAP_COIL_FN
+#define MODBUS_MAP_COIL_FN(name, address, source) s_WriteCoil_##name,
+static void (*const s_coilWriters[MODBUS_COIL_COUNT])(const uint8_t value) = {
+    MODBUS_COILS(MODBUS_MAP_COIL_FN)};
+#undef MODBUS_MAP_COIL_FN
+
+/* Private functions */
+static inline const modbus_register_t *s_FindRegister(const uint16_t reg_addr) {
+    if ((reg_addr < MODBUS_REGISTER_ADDR_MIN) || (reg_addr > MODBUS_REGISTER_ADDR_MAX) ||
+        (s_addressIndex[reg_addr] == 0)) {
+        return NULL;
+    }
+    return &s_registers[s_addressIndex[reg_addr] - 1];
+}
+
+static inline const modbus_block_t *s_FindBlock(const uint16_t reg_addr) {
+    for (size_t i = 0; i < sizeof(s_blocks) / sizeof(s_blocks[0]); i++) {
+        if ((reg_addr >= s_blocks[i].base) && (reg_addr - s_blocks[i].base < s_blocks[i].count)) {
+            return &s_blocks[i];
+        }
+    }
+    return NULL;
+}
+
+/* Public functions */
+/**
+ * \brief Validate a register address against the register map
+ * \param[in] reg_addr - The register address
+ * \return MODBUS_RTU_SUCCESS when mapped, MODBUS_RTU_ERR_BAD_REGISTER_ADDR when not
+ * \author agent, agent@local, Oct.2026
+ */
+MODBUS_RTU_ERR modbusMap_ValidateAddress(const uint16_t reg_addr) {
+    if ((NULL == s_FindRegister(reg_addr)) && (NULL == s_FindBlock(reg_addr))) {
+        return MODBUS_RTU_ERR_BAD_REGISTER_ADDR;
+    }
+    return MODBUS_RTU_SUCCESS;
+}
+
+/**
+ * \brief Read one register of the register map
+ * \param[in] reg_addr - The register address
+ * \param[out] value - The register value
+ * \return MODBUS_RTU_SUCCESS, MODBUS_RTU_ERR_BAD_REGISTER_ADDR, MODBUS_RTU_ERR_DATA_UNAVAILABLE
+ * \author agent, agent@local, Oct.2026
+ */
+MODBUS_RTU_ERR modbusMap_ReadRegister(const uint16_t reg_addr, uint16_t *const value) {
+    const modbus_register_t *reg = s_FindRegister(reg_addr);
+    if (NULL != reg) {
+        if ((reg->flag != RFLAG_ALWAYS) && !(rFlag & reg->flag)) {
+            return MODBUS_RTU_ERR_DATA_UNAVAILABLE;
+        }
+        *value = reg->read();
+        return MODBUS_RTU_SUCCESS;
+    }
+
+    const modbus_block_t *block = s_FindBlock(reg_addr);
+    if (NULL != block) {
+        if (0 != block->read(reg_addr, value)) {
+            return MODBUS_RTU_ERR_DATA_UNAVAILABLE;
+        }
+        return MODBUS_RTU_SUCCESS;
+    }
+    return MODBUS_RTU_ERR_BAD_REGISTER_ADDR;
+}
+
+/**
+ * \brief Write one RW register of the register map
+ * \param[in] reg_addr - The register address
+ * \param[in] value - The new register value
+ * \return MODBUS_RTU_SUCCESS, MODBUS_RTU_ERR_BAD_REGISTER_ADDR when not mapped or read only
+ * \author agent, agent@local, Oct.2026
+ */
+MODBUS_RTU_ERR modbusMap_WriteRegister(const uint16_t reg_addr, const uint16_t value) {
+    const modbus_register_t *reg = s_FindRegister(reg_addr);
+    if ((NULL == reg) || (NULL == reg->write)) {
+        return MODBUS_RTU_ERR_BAD_REGISTER_ADDR;
+    }
+    reg->write(value);
+    return MODBUS_RTU_SUCCESS;
+}
+
+/**
+ * \brief Local implementation for reading input registers for Modbus RTU
+ * \param[in] modbus_rtu_frame - Address + PDU + CRC, PDU = Function code + Data
+ * \param[in] data - Unused, the register sources are declared in MODBUS_REGISTER_MAP
+ * \param[out] reply_data - Register values, MSB first
+ * \param[out] reply_data_len - The number of bytes in reply_data
+ * \return MODBUS_RTU_SUCCESS, MODBUS_RTU_ERR_BAD_QUANTITY, MODBUS_RTU_ERR_BAD_REGISTER_ADDR,
+ * MODBUS_RTU_ERR_DATA_UNAVAILABLE
+ * \author agent, agent@local, Oct.2026
+ */
+MODBUS_RTU_ERR modbusRtu_TryReadInputRegister(const uint8_t *const modbus_rtu_frame, void *data,
+                                              uint8_t *reply_data, uint8_t *reply_data_len) {
+    (void)data;
+    uint16_t register_addr = ((uint16_t)modbus_rtu_frame[START_ADDRESS_HI] << 8) |
+                             (uint16_t)modbus_rtu_frame[START_ADDRESS_LOW];
+    uint16_t quantity = ((uint16_t)modbus_rtu_frame[QUANTITY_HI] << 8) |
+                        (uint16_t)modbus_rtu_frame[QUANTITY_LOW];
+    uint16_t       value;
+    MODBUS_RTU_ERR err;
+
+    if ((quantity == 0) || (quantity > MODBUS_READ_QUANTITY_MAX)) {
+        return MODBUS_RTU_ERR_BAD_QUANTITY;
+    }
+
+    for (uint16_t n = 0; n < quantity; n++) {
+        err = modbusMap_ReadRegister(register_addr + n, &value);
+        if (MODBUS_RTU_SUCCESS != err) {
+            return err;
+        }
+        reply_data[2 * n]     = (uint8_t)(value >> 8);
+        reply_data[2 * n + 1] = (uint8_t)(value & 0xff);
+    }
+    *reply_data_len = (uint8_t)(2 * quantity);
+    return MODBUS_RTU_SUCCESS;
+}
+
+/**
+ * \brief Local implementation for writing a single register for Modbus RTU
+ * \param[in] modbus_rtu_frame - Address + PDU + CRC, PDU = Function code + Address + Value
+ * \param[in] data - Unused, the register sources are declared in MODBUS_REGISTER_MAP
+ * \return MODBUS_RTU_SUCCESS, MODBUS_RTU_ERR_BAD_REGISTER_ADDR
+ * \author agent, agent@local, Oct.2026
+ */
+MODBUS_RTU_ERR modbusRtu_TryWriteSingleRegister(const uint8_t *const modbus_rtu_frame, void *data) {
+    (void)data;
+    uint16_t register_addr = ((uint16_t)modbus_rtu_frame[START_ADDRESS_HI] << 8) |
+                             (uint16_t)modbus_rtu_frame[START_ADDRESS_LOW];
+    uint16_t value = ((uint16_t)modbus_rtu_frame[WRITE_VALUE_HI] << 8) |
+                     (uint16_t)modbus_rtu_frame[WRITE_VALUE_LOW];
+    return modbusMap_WriteRegister(register_addr, value);
+}
+
+/**
+ * \brief Pack bits of a bit table into a read reply, LSB of the first byte is the start address
+ * \param[in] modbus_rtu_frame - Address + PDU + CRC, PDU = Function code + Start + Quantity
+ * \param[in] readers - The bit readers in address order
+ * \param[in] count - The number of bits in the table
+ * \param[out] reply_data - Packed bits, unused high bits of the last byte are 0
+ * \param[out] reply_data_len - The number of bytes in reply_data
+ * \return MODBUS_RTU_SUCCESS, MODBUS_RTU_ERR_BAD_QUANTITY, MODBUS_RTU_ERR_BAD_REGISTER_ADDR
+ * \author agent, agent@local, Oct.2026
+ */
+static MODBUS_RTU_ERR s_ReadBits(const uint8_t *const modbus_rtu_frame,
+                                 uint8_t (*const readers[])(void), const uint16_t count,
+                                 uint8_t *reply_data, uint8_t *reply_data_len) {
+    uint16_t start = ((uint16_t)modbus_rtu_frame[START_ADDRESS_HI] << 8) |
+                     (uint16_t)modbus_rtu_frame[START_ADDRESS_LOW];
+    uint16_t quantity = ((uint16_t)modbus_rtu_frame[QUANTITY_HI] << 8) |
+                        (uint16_t)modbus_rtu_frame[QUANTITY_LOW];
+
+    if (quantity == 0) {
+        return MODBUS_RTU_ERR_BAD_QUANTITY;
+    }
+    if ((start >= count) || (quantity > count - start)) {
+        return MODBUS_RTU_ERR_BAD_REGISTER_ADDR;
+    }
+
+    *reply_data_len = (uint8_t)((quantity + 7) / 8);
+    for (uint8_t n = 0; n < *reply_data_len; n++) {
+        reply_data[n] = 0;
+    }
+    for (uint16_t n = 0; n < quantity; n++) {
+        reply_data[n / 8] |= (uint8_t)(readers[start + n]() << (n % 8));
+    }
+    return MODBUS_RTU_SUCCESS;
+}
+
+/**
+ * \brief Local implementation for reading coils (FC 0x01) for Modbus RTU
+ * \param[in] modbus_rtu_frame - Address + PDU + CRC, PDU = Function code + Start + Quantity
+ * \param[in] data - Unused, the coil sources are declared in MODBUS_COILS
+ * \param[out] reply_data - Packed coil states
+ * \param[out] reply_data_len - The number of bytes in reply_data
+ * \return MODBUS_RTU_SUCCESS, MODBUS_RTU_ERR_BAD_QUANTITY, MODBUS_RTU_ERR_BAD_REGISTER_ADDR
+ * \author agent, agent@local, Oct.2026
+ */
+MODBUS_RTU_ERR modbusRtu_TryReadCoils(const uint8_t *const modbus_rtu_frame, void *data,
+                                      uint8_t *reply_data, uint8_t *reply_data_len) {
+    (void)data;
+    return s_ReadBits(modbus_rtu_frame, s_coilReaders, MODBUS_COIL_COUNT, reply_data,
+                      reply_data_len);
+}
+
+/**
+ * \brief Local implementation for reading discrete inputs (FC 0x02) for Modbus RTU
+ * \param[in] modbus_rtu_frame - Address + PDU + CRC, PDU = Function code + Start + Quantity
+ * \param[in] data - Unused, the input sources are declared in MODBUS_DISCRETE_INPUTS
+ * \param[out] reply_data - Packed input states
+ * \param[out] reply_data_len - The number of bytes in reply_data
+ * \return MODBUS_RTU_SUCCESS, MODBUS_RTU_ERR_BAD_QUANTITY, MODBUS_RTU_ERR_BAD_REGISTER_ADDR
+ * \author agent, agent@local, Oct.2026
+ */
+MODBUS_RTU_ERR modbusRtu_TryReadDiscreteInputs(const uint8_t *const modbus_rtu_frame, void *data,
+                                               uint8_t *reply_data, uint8_t *reply_data_len) {
+    (void)data;
+    return s_ReadBits(modbus_rtu_frame, s_diReaders, MODBUS_DI_COUNT, reply_data,
+                      reply_data_len);
+}
+
+/**
+ * \brief Local implementation for writing a single coil (FC 0x05) for Modbus RTU
+ * \param[in] modbus_rtu_frame - Address + PDU + CRC, PDU = Function code + Address + Value
+ * \param[in] data - Unused, the coil sources are declared in MODBUS_COILS
+ * \return MODBUS_RTU_SUCCESS, MODBUS_RTU_ERR_BAD_REGISTER_ADDR, MODBUS_RTU_ERR_BAD_QUANTITY when
+ * the value is neither MODBUS_COIL_ON nor MODBUS_COIL_OFF
+ * \author agent, agent@local, Oct.2026
+ */
+MODBUS_RTU_ERR modbusRtu_TryWriteSingleCoil(const uint8_t *const modbus_rtu_frame, void *data) {
+    (void)data;
+    uint16_t coil_addr = ((uint16_t)modbus_rtu_frame[START_ADDRESS_HI] << 8) |
+                         (uint16_t)modbus_rtu_frame[START_ADDRESS_LOW];
+    uint16_t value = ((uint16_t)modbus_rtu_frame[WRITE_VALUE_HI] << 8) |
+                     (uint16_t)modbus_rtu_frame[WRITE_VALUE_LOW];
+
+    if (coil_addr >= MODBUS_COIL_COUNT) {
+        return MODBUS_RTU_ERR_BAD_REGISTER_ADDR;
+    }
+    if ((value != MODBUS_COIL_ON) && (value != MODBUS_COIL_OFF)) {
+        return MODBUS_RTU_ERR_BAD_QUANTITY;
+    }
+    s_coilWriters[coil_addr](value == MODBUS_COIL_ON);
+    alarm_Output();  // the relay follows the coils without waiting for the next measurement
+    return MODBUS_RTU_SUCCESS;
+}
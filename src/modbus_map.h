@@ -0,0 +1,161 @@
+/*
+ * modbus_map.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef MODBUS_MAP_H_
+#define MODBUS_MAP_H_
+
+#include <stdint.h>
+
+#include "modbus_rtu.h"
+
+/* Register validity flags, a register is readable only when its flag is set in rFlag */
+extern uint16_t rFlag;  // Modbus RTU register flag
+#define RFLAG_ALWAYS      (uint16_t)0x00  // register is always valid
+#define RFLAG_CO2         (uint16_t)0x01
+#define RFLAG_TVOC        (uint16_t)0x02
+#define RFLAG_BASE_CO2    (uint16_t)0x04
+#define RFLAG_BASE_TVOC   (uint16_t)0x08
+#define RFLAG_RAW_H2      (uint16_t)0x10
+#define RFLAG_RAW_ETHANOL (uint16_t)0x20
+#define RFLAG_FEATURE_SET (uint16_t)0x40
+#define RFLAG_SERIAL_ID   (uint16_t)0x80
+#define RFLAG_HUMIDITY    (uint16_t)0x100
+#define RFLAG_DHT22       (uint16_t)0x200
+
+/*
+ * Register map. Single source of truth for the firmware lookup tables, the REG_ADDR_* enum and
+ * the gateway decoder iot-ticket/modbus_map.py (regenerate with iot-ticket/gen_modbus_map.py).
+ *
+ * X(name, address, source, type, scale, unit, access, flag)
+ *   name    - REG_ADDR_<name> is the register address
+ *   address - 16-bit register address, MODBUS_REGISTER_ADDR_MIN...MODBUS_REGISTER_ADDR_MAX
+ *   source  - C expression of the register value
+ *   type    - U16 or S16, how the gateway interprets the register
+ *   scale   - physical value = register value / scale
+ *   unit    - physical unit, for the gateway
+ *   access  - R (read only) or RW (also writable with FC 0x06, source must be an lvalue)
+ *   flag    - RFLAG_* validity flag
+ */
+#define MODBUS_REGISTER_MAP(X)                                                                     \
+    X(CO2,            0x0001, sgp_data.CO2,               U16, 1,   "ppm",  R,  RFLAG_CO2)         \
+    X(TVOC,           0x0002, sgp_data.TVOC,              U16, 1,   "ppb",  R,  RFLAG_TVOC)        \
+    X(BASE_CO2,       0x0003, sgp_data.baselineCO2,       U16, 1,   "ppm",  R,  RFLAG_BASE_CO2)    \
+    X(BASE_TVOC,      0x0004, sgp_data.baselineTVOC,      U16, 1,   "ppb",  R,  RFLAG_BASE_TVOC)   \
+    X(FEATURE_SET,    0x0005, sgp_data.featureSetVersion, U16, 1,   "",     R,  RFLAG_FEATURE_SET) \
+    X(RAW_H2,         0x0006, sgp_data.H2,                U16, 1,   "",     R,  RFLAG_RAW_H2)      \
+    X(RAW_ETHANOL,    0x0007, sgp_data.ethanol,           U16, 1,   "",     R,  RFLAG_RAW_ETHANOL) \
+    X(SERIAL_ID,      0x0008, sgp_data.serialID >> 32,    U16, 1,   "",     R,  RFLAG_SERIAL_ID)   \
+    X(SERIAL_ID_1,    0x0009, sgp_data.serialID >> 16,    U16, 1,   "",     R,  RFLAG_SERIAL_ID)   \
+    X(SERIAL_ID_2,    0x000A, sgp_data.serialID,          U16, 1,   "",     R,  RFLAG_SERIAL_ID)   \
+    X(RAW_MODE,       0x0010, raw_data.mode,              U16, 1,   "",     RW, RFLAG_ALWAYS)      \
+    X(RAW_WIN_SEQ,    0x0011, raw_data.windowSeq,         U16, 1,   "",     R,  RFLAG_ALWAYS)      \
+    X(RAW_WIN_COUNT,  0x0012, raw_data.windowSamples,     U16, 1,   "",     R,  RFLAG_ALWAYS)      \
+    X(RAW_SERIES_SEQ, 0x0013, raw_data.seriesSeq,         U16, 1,   "",     R,  RFLAG_ALWAYS)      \
+    X(RAW_H2_MIN,     0x0014, raw_data.h2.min,            U16, 1,   "",     R,  RFLAG_RAW_H2)      \
+    X(RAW_H2_MAX,     0x0015, raw_data.h2.max,            U16, 1,   "",     R,  RFLAG_RAW_H2)      \
+    X(RAW_H2_MEAN,    0x0016, raw_data.h2.mean,           U16, 1,   "",     R,  RFLAG_RAW_H2)      \
+    X(RAW_ETH_MIN,    0x0017, raw_data.ethanol.min,       U16, 1,   "",     R,  RFLAG_RAW_ETHANOL) \
+    X(RAW_ETH_MAX,    0x0018, raw_data.ethanol.max,       U16, 1,   "",     R,  RFLAG_RAW_ETHANOL) \
+    X(RAW_ETH_MEAN,   0x0019, raw_data.ethanol.mean,      U16, 1,   "",     R,  RFLAG_RAW_ETHANOL) \
+    X(HIST_HEAD,      0x0020, hist_data.head,             U16, 1,   "",     R,  RFLAG_ALWAYS)      \
+    X(HIST_COUNT,     0x0021, hist_data.count,            U16, 1,   "",     R,  RFLAG_ALWAYS)      \
+    X(HIST_CURSOR,    0x0022, hist_data.cursor,           U16, 1,   "",     RW, RFLAG_ALWAYS)      \
+    X(HIST_TIME_HI,   0x0023, hist_data.headTime >> 16,   U16, 1,   "s",    R,  RFLAG_ALWAYS)      \
+    X(HIST_TIME_LO,   0x0024, hist_data.headTime,         U16, 1,   "s",    R,  RFLAG_ALWAYS)      \
+    X(HIST_BLK_HEAD,  0x0025, hist_data.blockHead,        U16, 1,   "",     R,  RFLAG_ALWAYS)      \
+    X(HIST_BLK_COUNT, 0x0026, hist_data.blockCount,       U16, 1,   "",     R,  RFLAG_ALWAYS)      \
+    X(HIST_BLK_CUR,   0x0027, hist_data.blockCursor,      U16, 1,   "",     RW, RFLAG_ALWAYS)      \
+    X(TEMPERATURE,    0x0030, hum_data.temperature,       S16, 10,  "C",    RW, RFLAG_ALWAYS)      \
+    X(REL_HUMIDITY,   0x0031, hum_data.rh,                U16, 10,  "%",    RW, RFLAG_ALWAYS)      \
+    X(ABS_HUMIDITY,   0x0032, hum_data.absolute,          U16, 256, "g/m3", R,  RFLAG_HUMIDITY)    \
+    X(DHT_TEMP,       0x0033, dht_data.temperature,       S16, 10,  "C",    R,  RFLAG_DHT22)       \
+    X(DHT_RH,         0x0034, dht_data.rh,                U16, 10,  "%",    R,  RFLAG_DHT22)       \
+    X(DHT_ERRORS,     0x0035, dht_data.errors,            U16, 1,   "",     R,  RFLAG_ALWAYS)      \
+    X(DHT_STATUS,     0x0036, dht_data.lastError,         U16, 1,   "",     R,  RFLAG_ALWAYS)      \
+    X(CHG_STATUS,     0x0037, report_Status(),            U16, 1,   "",     R,  RFLAG_ALWAYS)      \
+    X(CHG_SEQ,        0x0038, report_data.seq,            U16, 1,   "",     R,  RFLAG_ALWAYS)      \
+    X(CHG_ACK,        0x0039, report_data.ack,            U16, 1,   "",     RW, RFLAG_ALWAYS)      \
+    X(CHG_DB_CO2,     0x003A, report_data.deadbandCO2,    U16, 1,   "ppm",  RW, RFLAG_ALWAYS)      \
+    X(CHG_DB_TVOC,    0x003B, report_data.deadbandTVOC,   U16, 1,   "ppb",  RW, RFLAG_ALWAYS)      \
+    X(ALM_CO2_HIGH,   0x003C, alarm_data.co2High,         U16, 1,   "ppm",  RW, RFLAG_ALWAYS)      \
+    X(ALM_CO2_HYST,   0x003D, alarm_data.co2Hyst,         U16, 1,   "ppm",  RW, RFLAG_ALWAYS)      \
+    X(ALM_TVOC_HIGH,  0x003E, alarm_data.tvocHigh,        U16, 1,   "ppb",  RW, RFLAG_ALWAYS)      \
+    X(ALM_TVOC_HYST,  0x003F, alarm_data.tvocHyst,        U16, 1,   "ppb",  RW, RFLAG_ALWAYS)      \
+    X(SUP_STATE,      0x0040, sup_data.state,             U16, 1,   "",     R,  RFLAG_ALWAYS)      \
+    X(SUP_FAULTS,     0x0041, sup_data.faults,            U16, 1,   "",     R,  RFLAG_ALWAYS)      \
+    X(SUP_RESETS,     0x0042, sup_data.resets,            U16, 1,   "",     R,  RFLAG_ALWAYS)      \
+    X(SUP_RECOVERIES, 0x0043, sup_data.recoveries,        U16, 1,   "",     R,  RFLAG_ALWAYS)      \
+    X(SUP_BACKOFF,    0x0044, sup_data.backoff,           U16, 1,   "s",    R,  RFLAG_ALWAYS)      \
+    X(SUP_RESTORED,   0x0045, sup_data.restored,          U16, 1,   "",     R,  RFLAG_ALWAYS)
+
+#define MODBUS_REGISTER_ADDR_MIN 0x0001
+#define MODBUS_REGISTER_ADDR_MAX 0x0045
+
+/*
+ * Register blocks, contiguous ranges served by a reader function.
+ *
+ * X(name, base, count, reader, access)
+ *   base    - first register address of the block
+ *   count   - number of registers in the block
+ *   reader  - int32_t reader(const uint16_t reg_addr, uint16_t *const value), 0 when success
+ */
+#define MODBUS_REGISTER_BLOCKS(X)                                    \
+    X(IRQ_STATS,   0x0100, 0x00A0, irqStats_ReadRegister,     R) \
+    X(RAW_SERIES,  0x0200, 0x0040, rawSignal_ReadRegister,    R) \
+    X(HISTORY,     0x0400, 0x007C, history_ReadRegister,      R) \
+    X(HIST_BLOCK,  0x0480, 0x0186, history_ReadBlockRegister, R) \
+    X(REMOTE_STAT, 0x0700, 0x0080, modbusMaster_ReadRegister, R) \
+    X(REMOTE,      0x0780, 0x0080, modbusMaster_ReadRegister, R)
+
+#define MODBUS_READ_QUANTITY_MAX 125  // 250 data bytes per reply
+
+/*
+ * Discrete inputs (FC 0x02) and coils (FC 0x01 read, FC 0x05 write), one bit each. The addresses
+ * are contiguous from 0, so the eight bits of a node fit one reply byte.
+ *
+ * X(name, address, source)
+ *   name    - DI_ADDR_<name> or COIL_ADDR_<name> is the bit address
+ *   source  - C expression of the bit, nonzero is 1. Coil sources are uint8_t lvalues set to 0/1.
+ */
+#define MODBUS_DISCRETE_INPUTS(X)                                    \
+    X(ALM_CO2,      0x0000, alarm_data.co2)                          \
+    X(ALM_TVOC,     0x0001, alarm_data.tvoc)                         \
+    X(DATA_CHANGED, 0x0002, report_Status() & REPORT_STATUS_CHANGED) \
+    X(MEAS_VALID,   0x0003, rFlag & RFLAG_CO2)                       \
+    X(SGP30_ONLINE, 0x0004, rFlag & RFLAG_SERIAL_ID)                 \
+    X(DHT22_VALID,  0x0005, rFlag & RFLAG_DHT22)                     \
+    X(RELAY_OUT,    0x0006, alarm_data.relayOut)
+
+#define MODBUS_COILS(X)                         \
+    X(RELAY,      0x0000, alarm_data.relay)     \
+    X(RELAY_AUTO, 0x0001, alarm_data.relayAuto) \
+    X(LED_ALARM,  0x0002, alarm_data.ledAlarm)
+
+#define MODBUS_COIL_ON  0xFF00U  // FC 0x05 value of a set coil
+#define MODBUS_COIL_OFF 0x0000U
+
+/* Register addresses */
+#define MODBUS_MAP_ENUM(name, address, source, type, scale, unit, access, flag) \
+    REG_ADDR_##name = (address),
+typedef enum { MODBUS_REGISTER_MAP(MODBUS_MAP_ENUM) } MODBUS_REGISTER_ADDRESS;
+#undef MODBUS_MAP_ENUM
+
+#define MODBUS_MAP_DI_ENUM(name, address, source) DI_ADDR_##name = (address),
+typedef enum {
+    MODBUS_DISCRETE_INPUTS(MODBUS_MAP_DI_ENUM) MODBUS_DI_COUNT
+} MODBUS_DISCRETE_INPUT_ADDRESS;
+#undef MODBUS_MAP_DI_ENUM
+
+#define MODBUS_MAP_COIL_ENUM(name, address, source) COIL_ADDR_##name = (address),
+typedef enum { MODBUS_COILS(MODBUS_MAP_COIL_ENUM) MODBUS_COIL_COUNT } MODBUS_COIL_ADDRESS;
+#undef MODBUS_MAP_COIL_ENUM
+
+MODBUS_RTU_ERR modbusMap_ReadRegister(const uint16_t reg_addr, uint16_t *const value);
+MODBUS_RTU_ERR modbusMap_WriteRegister(const uint16_t reg_addr, const uint16_t value);
+MODBUS_RTU_ERR modbusMap_ValidateAddress(const uint16_t reg_addr);
+
+#endif /* MODBUS_MAP_H_ */
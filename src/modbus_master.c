@@ -0,0 +1,301 @@
+/*
+ * modbus_master.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+#include "modbus_master.h"
+
+#include "crc.h"
+#include "irq_stats.h"
+#include "stm32l1xx.h"
+#include "usart_config.h"
+
+typedef enum { MASTER_IDLE = 0, MASTER_TX, MASTER_REPLY, MASTER_GAP } MODBUS_MASTER_PHASE;
+
+typedef struct modbus_poll_type {
+    uint8_t  slave;
+    uint8_t  fc;
+    uint16_t start;
+    uint8_t  count;
+    uint8_t  retries;
+    uint16_t timeout;  // ms
+    uint8_t  crc;      // MODBUS_MASTER_CRC_STD or MODBUS_MASTER_CRC_NODE
+} modbus_poll_t;
+
+#define MODBUS_MASTER_POLL_ENTRY(name, slave, fc, start, count, timeout, retries, crc) \
+    {(slave), (fc), (start), (count), (retries), (timeout), MODBUS_MASTER_CRC_##crc},
+static const modbus_poll_t s_polls[MODBUS_POLL_COUNT] = {
+    MODBUS_MASTER_POLLS(MODBUS_MASTER_POLL_ENTRY)};
+#undef MODBUS_MASTER_POLL_ENTRY
+
+/* Compile-time check of the poll list */
+#define MODBUS_MASTER_POLL_ASSERT(name, slave, fc, start, count, timeout, retries, crc) \
+    _Static_assert(((fc) == 0x03 || (fc) == 0x04) && ((count) >= 1) &&                  \
+                       ((count) <= MODBUS_MASTER_COUNT_MAX) && ((slave) >= 1) &&        \
+                       ((slave) <= 247) && ((timeout) >= 1),                            \
+                   "MODBUS_POLL_" #name " is not a valid FC03/FC04 poll");
+MODBUS_MASTER_POLLS(MODBUS_MASTER_POLL_ASSERT)
+#undef MODBUS_MASTER_POLL_ASSERT
+
+static uint8_t              s_request[MODBUS_POLL_COUNT][MODBUS_MASTER_REQUEST_LEN];
+static uint16_t             s_offset[MODBUS_POLL_COUNT];  // first cache register of the poll
+static uint16_t             s_cache[MODBUS_MASTER_CACHE_SIZE];
+static modbus_poll_status_t s_status[MODBUS_POLL_COUNT];
+static uint8_t              s_rx[MODBUS_MASTER_RX_SIZE];
+static volatile uint8_t     s_phase   = MASTER_IDLE;
+static uint8_t              s_poll    = 0;  // poll in progress
+static uint8_t              s_attempt = 0;  // retries used by s_poll
+
+/* Private functions */
+static inline void s_TxEnable(void) { GPIOB->ODR |= GPIO_ODR_ODR_5; }
+
+static inline void s_TxDisable(void) { GPIOB->ODR &= ~GPIO_ODR_ODR_5; }
+
+static inline void s_TimerStart(const uint16_t ms) {
+    TIM7->ARR = ms;
+    TIM7->CNT = 0;
+    TIM7->CR1 |= TIM_CR1_CEN;  // one pulse
+}
+
+static inline void s_TimerStop(void) {
+    TIM7->CR1 &= ~TIM_CR1_CEN;
+    TIM7->SR  = 0;
+}
+
+/* CRC byte of a frame at position 0 (first sent) or 1, in the byte order of the poll */
+static inline uint8_t s_CrcByte(const uint16_t crc, const uint8_t order, const uint32_t position) {
+    const uint32_t high = (MODBUS_MASTER_CRC_NODE == order) ? 0U : 1U;
+
+    return (position == high) ? (uint8_t)(crc >> 8) : (uint8_t)(crc & 0xff);
+}
+
+/* Send the request of s_poll, the USART3 TC interrupt switches the bus to reception */
+static void s_Send(void) {
+    s_phase = MASTER_TX;
+    s_TxEnable();
+    DMA1_Channel2->CCR   &= ~DMA_CCR_EN;
+    DMA1->IFCR           = DMA_IFCR_CGIF2;
+    DMA1_Channel2->CMAR  = (uint32_t)s_request[s_poll];
+    DMA1_Channel2->CNDTR = MODBUS_MASTER_REQUEST_LEN;
+    USART3->SR           &= ~USART_SR_TC;
+    USART3->CR1          |= USART_CR1_TCIE;
+    DMA1_Channel2->CCR   |= DMA_CCR_EN;
+}
+
+/* Wait the inter-frame gap before the next request, or end the cycle */
+static void s_Gap(void) {
+    if (s_poll >= MODBUS_POLL_COUNT) {
+        s_phase = MASTER_IDLE;
+        return;
+    }
+    s_phase = MASTER_GAP;
+    s_TimerStart(MODBUS_MASTER_GAP_MS);
+}
+
+static void s_Done(const uint16_t status) {
+    modbus_poll_status_t *st = &s_status[s_poll];
+
+    st->status = status;
+    if (MODBUS_MASTER_OK == status) {
+        st->age = 0;
+    } else if (st->errors < UINT16_MAX) {
+        st->errors++;
+    }
+    s_poll++;
+    s_attempt = 0;
+    s_Gap();
+}
+
+/* Timeout or corrupted reply, retry the same poll when it has retries left */
+static void s_Fail(const uint16_t status) {
+    if (s_attempt < s_polls[s_poll].retries) {
+        s_attempt++;
+        if (s_status[s_poll].retries < UINT16_MAX) {
+            s_status[s_poll].retries++;
+        }
+        s_Gap();
+        return;
+    }
+    s_Done(status);
+}
+
+/* Validate the reply of s_poll and update the cache */
+static void s_Reply(const uint32_t n) {
+    const modbus_poll_t *poll = &s_polls[s_poll];
+    uint16_t             crc;
+
+    if ((n < 5) || (s_rx[0] != poll->slave)) {
+        s_Fail(MODBUS_MASTER_ERR_REPLY);
+        return;
+    }
+    crc = CRC16(s_rx, (uint16_t)(n - 2));
+    if ((s_rx[n - 2] != s_CrcByte(crc, poll->crc, 0)) ||
+        (s_rx[n - 1] != s_CrcByte(crc, poll->crc, 1))) {
+        s_Fail(MODBUS_MASTER_ERR_REPLY);
+        return;
+    }
+    if ((s_rx[1] == (poll->fc | 0x80)) && (n == 5)) {
+        s_Done(s_rx[2]);  // exception reply, a retry gets the same answer
+        return;
+    }
+    if ((s_rx[1] != poll->fc) || (s_rx[2] != 2 * poll->count) || (n != 5U + 2U * poll->count)) {
+        s_Fail(MODBUS_MASTER_ERR_REPLY);
+        return;
+    }
+    for (uint32_t i = 0; i < poll->count; i++) {
+        s_cache[s_offset[s_poll] + i] = ((uint16_t)s_rx[3 + 2 * i] << 8) | s_rx[4 + 2 * i];
+    }
+    s_Done(MODBUS_MASTER_OK);
+}
+
+/* Public functions */
+/**
+ * \brief Build the requests of the poll list, initialize USART3, its DMA channels and TIM7
+ * \author agent, agent@local, Oct.2026
+ */
+void modbusMaster_Init(void) {
+    uint16_t offset = 0;
+    uint16_t crc;
+
+    for (uint32_t i = 0; i < MODBUS_POLL_COUNT; i++) {
+        uint8_t *req = s_request[i];
+        req[0]       = s_polls[i].slave;
+        req[1]       = s_polls[i].fc;
+        req[2]       = (uint8_t)(s_polls[i].start >> 8);
+        req[3]       = (uint8_t)(s_polls[i].start & 0xff);
+        req[4]       = 0;
+        req[5]       = s_polls[i].count;
+        crc          = CRC16(req, 6);
+        req[6]       = s_CrcByte(crc, s_polls[i].crc, 0);
+        req[7]       = s_CrcByte(crc, s_polls[i].crc, 1);
+
+        s_offset[i]         = offset;
+        offset              += s_polls[i].count;
+        s_status[i].status  = MODBUS_MASTER_NOT_POLLED;
+        s_status[i].age     = MODBUS_MASTER_AGE_MAX;
+        s_status[i].errors  = 0;
+        s_status[i].retries = 0;
+    }
+
+    USART3_dma_init();
+    DMA1_Channel3->CMAR = (uint32_t)s_rx;
+
+    RCC->APB1ENR |= RCC_APB1ENR_TIM7EN;
+    TIM7->PSC    = (F_CPU / 1000U) - 1U;       // 1kHz, 1 tick = 1ms
+    TIM7->CR1    = TIM_CR1_OPM | TIM_CR1_URS;  // one pulse, update interrupt on overflow only
+    TIM7->EGR    = TIM_EGR_UG;                 // load the prescaler
+    TIM7->SR     = 0;
+    TIM7->DIER   = TIM_DIER_UIE;
+    NVIC_SetPriority(TIM7_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(),
+                                                    IRQ_PRIORITY_RS485_MASTER, 0));
+    NVIC_EnableIRQ(TIM7_IRQn);
+}
+
+/**
+ * \brief Start one cycle over the poll list, call once per main loop
+ * \author agent, agent@local, Oct.2026
+ * \details A cycle that is still running is not restarted, its remaining polls complete first.
+ * The age counters of all polls advance by one.
+ */
+void modbusMaster_StartCycle(void) {
+    for (uint32_t i = 0; i < MODBUS_POLL_COUNT; i++) {
+        if (s_status[i].age < MODBUS_MASTER_AGE_MAX) {
+            s_status[i].age++;
+        }
+    }
+    if ((s_phase != MASTER_IDLE) || (MODBUS_POLL_COUNT == 0)) {
+        return;
+    }
+    s_poll    = 0;
+    s_attempt = 0;
+    s_Send();
+}
+
+/**
+ * \brief Read one register of the REMOTE_STAT or REMOTE blocks
+ * \param[in] reg_addr - Register address
+ * \param[out] value - Poll status field, or the cached remote register (0 before the first reply)
+ * \return 0 when success, -1 when the address is past the poll list or the cache
+ * \author agent, agent@local, Oct.2026
+ */
+int32_t modbusMaster_ReadRegister(const uint16_t reg_addr, uint16_t *const value) {
+    uint32_t index;
+
+    if ((reg_addr >= MODBUS_MASTER_REG_STATUS) && (reg_addr < MODBUS_MASTER_REG_CACHE)) {
+        index = (uint32_t)(reg_addr - MODBUS_MASTER_REG_STATUS) / MODBUS_MASTER_STATUS_REGS;
+        if (index >= MODBUS_POLL_COUNT) {
+            return -1;
+        }
+        switch ((reg_addr - MODBUS_MASTER_REG_STATUS) % MODBUS_MASTER_STATUS_REGS) {
+            case MODBUS_MASTER_STAT_STATUS:
+                *value = s_status[index].status;
+                break;
+            case MODBUS_MASTER_STAT_AGE:
+                *value = s_status[index].age;
+                break;
+            case MODBUS_MASTER_STAT_ERRORS:
+                *value = s_status[index].errors;
+                break;
+            default:
+                *value = s_status[index].retries;
+                break;
+        }
+        return 0;
+    }
+    if (reg_addr >= MODBUS_MASTER_REG_CACHE) {
+        index = (uint32_t)(reg_addr - MODBUS_MASTER_REG_CACHE);
+        if (index < MODBUS_MASTER_CACHE_SIZE) {
+            *value = s_cache[index];
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/* Interrupt handlers */
+
+/**
+ * \brief USART3 interrupt handler. TC: the request is sent, receive the reply. IDLE: the reply
+ * is complete.
+ * \author agent, agent@local, Oct.2026
+ */
+void USART3_IRQHandler(void) {
+    uint32_t sr = USART3->SR;
+    uint32_t n;
+
+    if ((USART3->CR1 & USART_CR1_TCIE) && (sr & USART_SR_TC)) {
+        USART3->CR1 &= ~USART_CR1_TCIE;
+        s_TxDisable();
+        (void)USART3->DR;  // drop a stale byte and a pending IDLE
+        DMA1_Channel3->CCR   &= ~DMA_CCR_EN;
+        DMA1->IFCR           = DMA_IFCR_CGIF3;
+        DMA1_Channel3->CNDTR = MODBUS_MASTER_RX_SIZE;
+        DMA1_Channel3->CCR   |= DMA_CCR_EN;
+        s_phase              = MASTER_REPLY;
+        s_TimerStart(s_polls[s_poll].timeout);
+    }
+    if (sr & USART_SR_IDLE) {
+        (void)USART3->DR;  // SR then DR read clears IDLE
+        n = MODBUS_MASTER_RX_SIZE - DMA1_Channel3->CNDTR;
+        if ((s_phase == MASTER_REPLY) && (n > 0)) {
+            s_TimerStop();
+            DMA1_Channel3->CCR &= ~DMA_CCR_EN;
+            s_Reply(n);
+        }
+    }
+}
+
+/**
+ * \brief TIM7 interrupt handler, reply timeout or end of the inter-frame gap
+ * \author agent, agent@local, Oct.2026
+ */
+void TIM7_IRQHandler(void) {
+    TIM7->SR = 0;
+    if (s_phase == MASTER_REPLY) {
+        DMA1_Channel3->CCR &= ~DMA_CCR_EN;
+        s_Fail(MODBUS_MASTER_ERR_TIMEOUT);
+    } else if (s_phase == MASTER_GAP) {
+        s_Send();
+    }
+}
@@ -0,0 +1,101 @@
+/*
+ * modbus_master.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef MODBUS_MASTER_H_
+#define MODBUS_MASTER_H_
+
+#include <stdint.h>
+
+#define MODBUS_MASTER_EN 1
+
+/*
+ * Modbus RTU master on a secondary RS-485 segment (USART3, PB10 TX, PB11 RX, PB5 TX enable).
+ *
+ * Once per main loop modbusMaster_StartCycle starts one cycle over the poll list. The requests
+ * are built with their CRC at init and the whole cycle runs in the interrupt handlers: DMA1
+ * channel 2 sends a request, DMA1 channel 3 and the USART3 idle line interrupt receive the reply,
+ * TIM7 times the reply timeout and the inter-frame gap. The next request goes out right after the
+ * gap, without waiting for the main loop.
+ *
+ * The registers of the replies are cached in poll list order and served as the REMOTE register
+ * block, so the upstream master reads all the sub-bus nodes in one block read. The REMOTE_STAT
+ * block has MODBUS_MASTER_STATUS_REGS registers per poll, see MODBUS_MASTER_STAT_*.
+ */
+#define MODBUS_MASTER_GAP_MS      4U       // inter-frame gap, 3.5 characters at 9600 baud = 3.6ms
+#define MODBUS_MASTER_COUNT_MAX   16U      // registers per poll
+#define MODBUS_MASTER_REQUEST_LEN 8U       // address, FC, start, quantity, CRC
+#define MODBUS_MASTER_RX_SIZE     (5U + 2U * MODBUS_MASTER_COUNT_MAX)
+#define MODBUS_MASTER_AGE_MAX     0xFFFFU  // saturation of the age counters
+
+/* Register blocks */
+#define MODBUS_MASTER_REG_STATUS  0x0700U
+#define MODBUS_MASTER_STATUS_REGS 4U
+#define MODBUS_MASTER_STAT_STATUS 0U  // MODBUS_MASTER_STATUS of the last cycle
+#define MODBUS_MASTER_STAT_AGE    1U  // cycles since the cached values were updated
+#define MODBUS_MASTER_STAT_ERRORS 2U  // failed cycles since power-on
+#define MODBUS_MASTER_STAT_RETRY  3U  // retries since power-on
+#define MODBUS_MASTER_REG_CACHE   0x0780U
+
+/*
+ * Poll list, one request per cycle and entry
+ *
+ * X(name, slave, fc, start, count, timeout, retries, crc)
+ *   name    - MODBUS_POLL_<name> is the poll index
+ *   slave   - slave address on the sub-bus
+ *   fc      - 0x03 (holding) or 0x04 (input registers)
+ *   start   - first remote register
+ *   count   - number of registers, 1...MODBUS_MASTER_COUNT_MAX
+ *   timeout - reply timeout in ms, from the end of the request
+ *   retries - retries after a timeout or a corrupted reply, not after an exception reply
+ *   crc     - CRC byte order of the request and the reply, STD or NODE (MODBUS_MASTER_CRC_*)
+ *
+ * This firmware sends its CRC high byte first (modbusRtu_Reply), standard Modbus RTU sends it low
+ * byte first. A slave only answers requests in its own order, so the NODE polls reach nodes
+ * running this firmware and the STD polls reach standard third-party slaves.
+ */
+#define MODBUS_MASTER_CRC_STD  0U  // low byte first, standard Modbus RTU
+#define MODBUS_MASTER_CRC_NODE 1U  // high byte first, nodes running this firmware
+
+#define MODBUS_MASTER_POLLS(X)                     \
+    X(NODE_01, 0x01, 0x04, 0x0001, 2, 50, 1, NODE) \
+    X(NODE_02, 0x02, 0x04, 0x0001, 2, 50, 1, NODE) \
+    X(NODE_03, 0x03, 0x04, 0x0001, 2, 50, 1, NODE) \
+    X(NODE_04, 0x04, 0x04, 0x0001, 2, 50, 1, NODE) \
+    X(NODE_05, 0x05, 0x04, 0x0001, 2, 50, 1, NODE) \
+    X(NODE_06, 0x06, 0x04, 0x0001, 2, 50, 1, NODE) \
+    X(NODE_07, 0x07, 0x04, 0x0001, 2, 50, 1, NODE) \
+    X(NODE_08, 0x08, 0x04, 0x0001, 2, 50, 1, NODE) \
+    X(NODE_09, 0x09, 0x04, 0x0001, 2, 50, 1, NODE) \
+    X(NODE_10, 0x0A, 0x04, 0x0001, 2, 50, 1, NODE)
+
+#define MODBUS_MASTER_POLL_INDEX(name, slave, fc, start, count, timeout, retries, crc) \
+    MODBUS_POLL_##name,
+typedef enum { MODBUS_MASTER_POLLS(MODBUS_MASTER_POLL_INDEX) MODBUS_POLL_COUNT } MODBUS_POLL;
+#undef MODBUS_MASTER_POLL_INDEX
+
+#define MODBUS_MASTER_POLL_SIZE(name, slave, fc, start, count, timeout, retries, crc) +(count)
+#define MODBUS_MASTER_CACHE_SIZE (0 MODBUS_MASTER_POLLS(MODBUS_MASTER_POLL_SIZE))
+
+typedef enum {
+    MODBUS_MASTER_OK = 0,               // 0x01...0xFF: exception code replied by the slave
+    MODBUS_MASTER_ERR_TIMEOUT = 0x100,  // no reply
+    MODBUS_MASTER_ERR_REPLY,            // bad CRC, length, address or function code
+    MODBUS_MASTER_NOT_POLLED            // no cycle completed yet
+} MODBUS_MASTER_STATUS;
+
+typedef struct modbus_poll_status_type {
+    uint16_t status;  // MODBUS_MASTER_STATUS
+    uint16_t age;     // cycles since the last good reply
+    uint16_t errors;  // failed cycles
+    uint16_t retries;
+} modbus_poll_status_t;
+
+void    modbusMaster_Init(void);
+void    modbusMaster_StartCycle(void);
+int32_t modbusMaster_ReadRegister(const uint16_t reg_addr, uint16_t *const value);
+
+#endif /* MODBUS_MASTER_H_ */
@@ -2,6 +2,7 @@
 #include "modbus_rtu.h"
 #include "utils.h"
 #include "crc.h"
+#include "modbus_map.h"
 
 /**
  * \brief Create an modbus_rtu_t object
@@ -16,14 +17,17 @@ modbus_rtu_t modbus_rtu_create(void) {
 /**
  * \brief Run a modbus rtu request
  * \param[in] modbus_rtu_frame - Address + PDU + CRC, PDU = Function code + Data
+ * \param[in] length - The number of bytes in the frame, CRC included
+ * \param[in] data - Passed to the local implementations
  * \author siyuan xu, e2101066@edu.vamk.fi, Jan.2023
  */
-void modbusRtu_RunRequest(const uint8_t *const modbus_rtu_frame, void *data) {
+void modbusRtu_RunRequest(const uint8_t *const modbus_rtu_frame, const uint16_t length,
+                          void *data) {
     MODBUS_RTU_ERR err;
-    uint8_t        reply_data[8];
+    uint8_t        reply_data[MODBUS_REPLY_DATA_MAX];
     uint8_t        reply_data_len = 0;
 
-    err = modbusRtu_CrcCheck(modbus_rtu_frame);
+    err = modbusRtu_CrcCheck(modbus_rtu_frame, length);
     if (err == MODBUS_RTU_ERR_BAD_CRC) {
 #if (DEBUG_CONSOLE_EN > 0u)
         debug_console("BAD CRC!\n\r");
@@ -42,36 +46,54 @@ void modbusRtu_RunRequest(const uint8_t *const modbus_rtu_frame, void *data) {
 #endif
             modbusRtu_ErrorReply(modbus_rtu_frame, (uint8_t)err);
             return;
+        } else if (length != modbusRtu_RequestLength(modbus_rtu_frame[FUNCTION_CODE])) {
+#if (DEBUG_CONSOLE_EN > 0u)
+            debug_console("BAD REQUEST LENGTH!\n\r");
+#endif
+            modbusRtu_ErrorReply(modbus_rtu_frame, MODBUS_RTU_ERR_BAD_QUANTITY);
+            return;
         } else {
 #if (DEBUG_CONSOLE_EN > 0u)
             debug_console("FUNCTION CODE Accepted!\n\r");
 #endif
             switch (modbus_rtu_frame[FUNCTION_CODE]) {
                 case READ_DO:
-                    // TBD
+                    err = modbusRtu_TryReadCoils(modbus_rtu_frame, data, reply_data,
+                                                 &reply_data_len);
                     break;
                 case READ_DI:
-                    // TBD
-                    break;
-                case READ_AO:
-                    // TBD
+                    err = modbusRtu_TryReadDiscreteInputs(modbus_rtu_frame, data, reply_data,
+                                                          &reply_data_len);
                     break;
+                case READ_AO:  // holding and input registers share one register map
                 case READ_AI:
-                    // TBD
                     err = modbusRtu_TryReadInputRegister(modbus_rtu_frame, data, reply_data,
-                                                      &reply_data_len);
+                                                         &reply_data_len);
                     break;
                 case WRITE_ONE_DO:
-                    // TBD
+                    err = modbusRtu_TryWriteSingleCoil(modbus_rtu_frame, data);
                     break;
                 case WRITE_ONE_AO:
-                    // TBD
+                    err = modbusRtu_TryWriteSingleRegister(modbus_rtu_frame, data);
+                    break;
+                case REPORT_SLAVE_ID:
+                    err = modbusRtu_TryReportSlaveId(modbus_rtu_frame, data, reply_data,
+                                                     &reply_data_len);
+                    break;
+                case READ_DEVICE_ID:
+                    err = modbusRtu_TryReadDeviceId(modbus_rtu_frame, data, reply_data,
+                                                    &reply_data_len);
                     break;
                 default:
                     break;
             }
             if (MODBUS_RTU_SUCCESS != err) {
                 modbusRtu_ErrorReply(modbus_rtu_frame, (uint8_t)err);
+            } else if ((modbus_rtu_frame[FUNCTION_CODE] == WRITE_ONE_AO) ||
+                       (modbus_rtu_frame[FUNCTION_CODE] == WRITE_ONE_DO)) {
+                modbusRtu_EchoReply(modbus_rtu_frame);
+            } else if (modbus_rtu_frame[FUNCTION_CODE] == READ_DEVICE_ID) {
+                modbusRtu_PduReply(modbus_rtu_frame, reply_data, reply_data_len);
             } else {
                 modbusRtu_Reply(modbus_rtu_frame, reply_data, reply_data_len);
 #if (DEBUG_CONSOLE_EN > 0u)
@@ -115,6 +137,15 @@ void modbusRtu_ErrorReply(const uint8_t *const modbus_rtu_frame,
     modbusRtu_SendData(modbus_reply_frame, MODBUS_FRAME_ERROR_REPLY_LENGTH);
 }
 
+/**
+ * \brief Reply to a write request by echoing the request frame
+ * \param[in] modbus_rtu_frame - Address + PDU + CRC, PDU = Function code + Address + Value
+ * \author agent, agent@local, Oct.2026
+ */
+void modbusRtu_EchoReply(const uint8_t *const modbus_rtu_frame) {
+    modbusRtu_SendData(modbus_rtu_frame, CHECKSUM_LOW + 1);
+}
+
 /**
  * \brief Normal reply to Modbus RTU Master
  * \param[in] modbus_rtu_frame - Address + PDU + CRC, PDU = Function code + Data
@@ -124,8 +155,8 @@ void modbusRtu_ErrorReply(const uint8_t *const modbus_rtu_frame,
  */
 void modbusRtu_Reply(const uint8_t *const modbus_rtu_frame, const uint8_t *data,
                      const uint8_t data_len) {
-    uint8_t  index = 0;
-    uint8_t  modbus_reply_frame[MODBUS_FRAME_REPLY_LENGTH];
+    uint16_t index = 0;
+    uint8_t  modbus_reply_frame[MODBUS_FRAME_MAX_LENGTH];
     uint16_t crc                         = 0;
     modbus_reply_frame[SLAVE_ADDRESS]    = modbus_rtu_frame[SLAVE_ADDRESS];
     modbus_reply_frame[FUNCTION_CODE]    = modbus_rtu_frame[FUNCTION_CODE];
@@ -137,27 +168,71 @@ void modbusRtu_Reply(const uint8_t *const modbus_rtu_frame, const uint8_t *data,
     crc                         = CRC16(modbus_reply_frame, index + 1);
     modbus_reply_frame[++index] = (uint8_t)(crc >> 8);
     modbus_reply_frame[++index] = (uint8_t)(crc & 0xff);
-    modbusRtu_SendData(modbus_reply_frame, MODBUS_FRAME_REPLY_LENGTH);
+    modbusRtu_SendData(modbus_reply_frame, (size_t)index + 1);
+}
+
+/**
+ * \brief Reply to Modbus RTU Master with a PDU that has no byte count field
+ * \param[in] modbus_rtu_frame - Address + PDU + CRC, PDU = Function code + Data
+ * \param[in] data - The PDU data following the function code
+ * \param[in] data_len - The number of bytes of the data
+ * \author agent, agent@local, Oct.2026
+ */
+void modbusRtu_PduReply(const uint8_t *const modbus_rtu_frame, const uint8_t *data,
+                        const uint8_t data_len) {
+    uint16_t index = FUNCTION_CODE;
+    uint8_t  modbus_reply_frame[MODBUS_FRAME_MAX_LENGTH];
+    uint16_t crc                      = 0;
+    modbus_reply_frame[SLAVE_ADDRESS] = modbus_rtu_frame[SLAVE_ADDRESS];
+    modbus_reply_frame[FUNCTION_CODE] = modbus_rtu_frame[FUNCTION_CODE];
+    for (uint8_t n = 0; n < data_len; n++) {
+        modbus_reply_frame[++index] = data[n];
+    }
+    crc                         = CRC16(modbus_reply_frame, index + 1);
+    modbus_reply_frame[++index] = (uint8_t)(crc >> 8);
+    modbus_reply_frame[++index] = (uint8_t)(crc & 0xff);
+    modbusRtu_SendData(modbus_reply_frame, (size_t)index + 1);
+}
+
+/**
+ * \brief The length of a request frame, CRC included
+ * \param[in] function_code - A function code accepted by modbusRtu_FunctionCodeValidation
+ * \return The number of bytes in the request frame
+ * \author agent, agent@local, Oct.2026
+ */
+uint16_t modbusRtu_RequestLength(const uint8_t function_code) {
+    switch (function_code) {
+        case REPORT_SLAVE_ID:
+            return MODBUS_FRAME_MIN_LENGTH;
+        case READ_DEVICE_ID:
+            return MEI_OBJECT_ID + 3;
+        default:
+            return MODBUS_FRAME_REQUEST_LENGTH;
+    }
 }
 
 /**
  * \brief CRC-16 error check for the Modbus RTU reqeust frame
  * \param[in] modbus_rtu_frame - Address + PDU + CRC, PDU = Function code + Data
+ * \param[in] length - The number of bytes in the frame, CRC included
  * \return MODBUS_RTU_SUCCESS when success, MODBUS_RTU_ERR_BAD_CRC when failed
  * \author siyuan xu, e2101066@edu.vamk.fi, Jan.2023
  */
-MODBUS_RTU_ERR modbusRtu_CrcCheck(const uint8_t *const modbus_rtu_frame) {
+MODBUS_RTU_ERR modbusRtu_CrcCheck(const uint8_t *const modbus_rtu_frame, const uint16_t length) {
     uint16_t crc_checksum = 0;
     uint16_t crc_calcuate = 0;
     char     crc_str[10];
-    crc_calcuate = CRC16(modbus_rtu_frame, 6);
+    if (length < MODBUS_FRAME_MIN_LENGTH) {
+        return MODBUS_RTU_ERR_BAD_CRC;
+    }
+    crc_calcuate = CRC16(modbus_rtu_frame, length - 2);
 #if (DEBUG_CONSOLE_EN > 0u)
     debug_console("CRC_CAL=");
     debug_console(itoa(crc_calcuate, crc_str, 10));
 #endif
 
     crc_checksum =
-        ((uint16_t)modbus_rtu_frame[CHECKSUM_HI] << 8) | (uint16_t)modbus_rtu_frame[CHECKSUM_LOW];
+        ((uint16_t)modbus_rtu_frame[length - 2] << 8) | (uint16_t)modbus_rtu_frame[length - 1];
 
     if (crc_calcuate != crc_checksum) {
         return MODBUS_RTU_ERR_BAD_CRC;
@@ -173,7 +248,9 @@ MODBUS_RTU_ERR modbusRtu_CrcCheck(const uint8_t *const modbus_rtu_frame) {
  * \author siyuan xu, e2101066@edu.vamk.fi, Jan.2023
  */
 MODBUS_RTU_ERR modbusRtu_FunctionCodeValidation(const uint8_t function_code) {
-    if ((function_code < READ_DO) || (function_code > WRITE_ONE_AO)) {
+    if ((function_code == REPORT_SLAVE_ID) || (function_code == READ_DEVICE_ID)) {
+        return MODBUS_RTU_SUCCESS;
+    } else if ((function_code < READ_DO) || (function_code > WRITE_ONE_AO)) {
         return MODBUS_RTU_ERR_BAD_FUNCTION_CODE;
     } else {
         return MODBUS_RTU_SUCCESS;
@@ -187,9 +264,5 @@ MODBUS_RTU_ERR modbusRtu_FunctionCodeValidation(const uint8_t function_code) {
  * \author siyuan xu, e2101066@edu.vamk.fi, Jan.2023
  */
 MODBUS_RTU_ERR modbusRtu_RegisterAddressValidation(const uint16_t reg_addr) {
-    if ((reg_addr < REG_ADDR_CO2) || (reg_addr > REG_ADDR_SERIAL_ID)) {
-        return MODBUS_RTU_ERR_BAD_REGISTER_ADDR;
-    } else {
-        return MODBUS_RTU_SUCCESS;
-    }
+    return modbusMap_ValidateAddress(reg_addr);
 }
@@ -6,25 +6,16 @@
 /* Modbus RTU client parameters*/
 #define MODBUS_RTU_SLAVE_ADDR_THIS       (uint8_t)0x05
 #define MODBUS_REGISTER_SIZE             20
-#define MODBUS_REGISTER_ADDR_MIN         1
-#define MODBUS_REGISTER_ADDR_MAX         8
 #define MODBUS_BAUD_RATE                 9600
 #define MODBUS_FRAME_SILENT_WAIT_TIME_MS (int)(3.5 * 8 / MODBUS_BAUD_RATE)
 #define MODBUS_FRAME_REPLY_LENGTH        7
 #define MODBUS_FRAME_ERROR_REPLY_LENGTH  5
+#define MODBUS_FRAME_MAX_LENGTH          256
+#define MODBUS_FRAME_MIN_LENGTH          4    // address, function code, CRC
+#define MODBUS_FRAME_REQUEST_LENGTH      8    // FC 1...6: address, FC, 2 x 16 bit, CRC
+#define MODBUS_REPLY_DATA_MAX            250  // 125 registers
 
 /* Modbus RTU data structures */
-typedef enum {
-    REG_ADDR_CO2 = 1,
-    REG_ADDR_TVOC,
-    REG_ADDR_BASE_CO2,
-    REG_ADDR_BASE_TVOC,
-    REG_ADDR_FEATURE_SET,
-    REG_ADDR_RAW_H2,
-    REG_ADDR_RAW_ETHANOL,
-    REG_ADDR_SERIAL_ID
-} MODBUS_REGISTER_ADDRESS;
-
 typedef enum {
     SLAVE_ADDRESS = 0,
     FUNCTION_CODE,
@@ -34,6 +25,8 @@ typedef enum {
     QUANTITY_LOW,
     CHECKSUM_HI,
     CHECKSUM_LOW,
+    WRITE_VALUE_HI = 4,
+    WRITE_VALUE_LOW,
     REPLY_BYTE_COUNT = 2,
     REPLY_DATA_HI,
     REPLY_DATA_LOW,
@@ -41,7 +34,10 @@ typedef enum {
     REPLY_CHECKSUM_LOW,
     ERROR_REPLY_DATA = 2,
     ERROR_REPLY_CHECKSUM_HI,
-    ERROR_REPLY_CHECKSUM_LOW
+    ERROR_REPLY_CHECKSUM_LOW,
+    MEI_TYPE = 2,  // FC 0x2B, encapsulated interface transport
+    MEI_READ_DEVICE_ID_CODE,
+    MEI_OBJECT_ID
 } MODBUS_RTU_FRAME_BIT;
 
 typedef enum {
@@ -50,7 +46,9 @@ typedef enum {
     READ_AO,
     READ_AI,
     WRITE_ONE_DO,
-    WRITE_ONE_AO
+    WRITE_ONE_AO,
+    REPORT_SLAVE_ID = 0x11,
+    READ_DEVICE_ID  = 0x2B  // MEI type 0x0E
 } MODBUS_FUNCTION_CODE;
 
 typedef struct modbus_rtu_type {
@@ -74,18 +72,37 @@ typedef enum {
 extern int            mFlag;
 extern void           debug_console(const char *message);
 extern void           modbusRtu_SendData(const uint8_t *const data, const size_t data_length);
-extern MODBUS_RTU_ERR modbusRtu_TryReadInputRegister(const uint8_t *const modbus_rtu_frame, void *data,
-                                                  uint8_t *reply_data, uint8_t *reply_data_len);
+extern MODBUS_RTU_ERR modbusRtu_TryReadInputRegister(const uint8_t *const modbus_rtu_frame,
+                                                     void *data, uint8_t *reply_data,
+                                                     uint8_t *reply_data_len);
+extern MODBUS_RTU_ERR modbusRtu_TryWriteSingleRegister(const uint8_t *const modbus_rtu_frame,
+                                                       void *data);
+extern MODBUS_RTU_ERR modbusRtu_TryReadCoils(const uint8_t *const modbus_rtu_frame, void *data,
+                                             uint8_t *reply_data, uint8_t *reply_data_len);
+extern MODBUS_RTU_ERR modbusRtu_TryReadDiscreteInputs(const uint8_t *const modbus_rtu_frame,
+                                                      void *data, uint8_t *reply_data,
+                                                      uint8_t *reply_data_len);
+extern MODBUS_RTU_ERR modbusRtu_TryWriteSingleCoil(const uint8_t *const modbus_rtu_frame,
+                                                   void *data);
+extern MODBUS_RTU_ERR modbusRtu_TryReportSlaveId(const uint8_t *const modbus_rtu_frame, void *data,
+                                                 uint8_t *reply_data, uint8_t *reply_data_len);
+extern MODBUS_RTU_ERR modbusRtu_TryReadDeviceId(const uint8_t *const modbus_rtu_frame, void *data,
+                                                uint8_t *reply_data, uint8_t *reply_data_len);
 
-void           modbusRtu_RunRequest(const uint8_t *const modbus_rtu_frame, void *data);
+void           modbusRtu_RunRequest(const uint8_t *const modbus_rtu_frame, const uint16_t length,
+                                    void *data);
 void           modbusRtu_ErrorReply(const uint8_t *const modbus_rtu_frame,
                                     const MODBUS_RTU_ERR modbus_exception_code);
+void           modbusRtu_EchoReply(const uint8_t *const modbus_rtu_frame);
 void           modbusRtu_Reply(const uint8_t *const modbus_rtu_frame, const uint8_t *data,
                                const uint8_t data_len);
+void           modbusRtu_PduReply(const uint8_t *const modbus_rtu_frame, const uint8_t *data,
+                                  const uint8_t data_len);
 modbus_rtu_t   modbus_rtu_create(void);
 MODBUS_RTU_ERR modbusRtu_AddressValidation(const uint8_t address);
 MODBUS_RTU_ERR modbusRtu_FunctionCodeValidation(const uint8_t function_code);
 MODBUS_RTU_ERR modbusRtu_RegisterAddressValidation(const uint16_t reg_addr);
-MODBUS_RTU_ERR modbusRtu_CrcCheck(const uint8_t *const modbus_rtu_frame);
+uint16_t       modbusRtu_RequestLength(const uint8_t function_code);
+MODBUS_RTU_ERR modbusRtu_CrcCheck(const uint8_t *const modbus_rtu_frame, const uint16_t length);
 
 #endif
@@ -0,0 +1,134 @@
+/*
+ * profiler.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+#include "profiler.h"
+
+#include <stdio.h>
+
+#if !defined(STM32L152xE)
+#include <time.h>
+#endif
+
+static profiler_stats_t s_stats[PROF_ZONE_COUNT];
+
+static const char *const s_zone_names[PROF_ZONE_COUNT] = {
+    "modbusRtu_RunRequest", "CRC16",        "CRC8",       "SGP30 I2C transfer", "DMA1_CH5 ISR",
+    "USART1 ISR",           "DMA1_CH6 ISR", "USART2 ISR", "I2C1_EV ISR"};
+
+#if !defined(STM32L152xE)
+/**
+ * \brief Host implementation of the profiler time base
+ * \return CLOCK_MONOTONIC scaled to cycles of the 32 MHz target clock
+ */
+uint32_t profiler_Now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    uint64_t ns = (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+    return (uint32_t)(ns * PROFILER_TICKS_PER_US / 1000U);
+}
+#endif
+
+/**
+ * \brief Start the cycle counter and clear all zone statistics
+ * \author agent, agent@local, Oct.2026
+ */
+void profiler_Init(void) {
+#if defined(STM32L152xE)
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;  // enable DWT/ITM blocks
+    DWT->CYCCNT      = 0;
+    DWT->CTRL        |= DWT_CTRL_CYCCNTENA_Msk;  // start cycle counter
+#endif
+    profiler_Reset();
+}
+
+/**
+ * \brief Clear all zone statistics
+ */
+void profiler_Reset(void) {
+    for (uint32_t i = 0; i < PROF_ZONE_COUNT; i++) {
+        s_stats[i].count = 0;
+        s_stats[i].min   = UINT32_MAX;
+        s_stats[i].max   = 0;
+        s_stats[i].total = 0;
+    }
+}
+
+/**
+ * \brief Add one measurement to a zone
+ * \param[in] zone - The profiled zone
+ * \param[in] ticks - Elapsed ticks between PROFILER_BEGIN and PROFILER_END
+ * \author agent, agent@local, Oct.2026
+ * \details A zone can be recorded from the main loop and from handlers (CRC16), the update runs
+ * with interrupts disabled, about 20 cycles.
+ */
+void profiler_Record(const PROFILER_ZONE zone, const uint32_t ticks) {
+    profiler_stats_t *s = &s_stats[zone];
+#if defined(STM32L152xE)
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+#endif
+    s->count++;
+    s->total += ticks;
+    if (ticks < s->min) {
+        s->min = ticks;
+    }
+    if (ticks > s->max) {
+        s->max = ticks;
+    }
+#if defined(STM32L152xE)
+    __set_PRIMASK(primask);
+#endif
+}
+
+/**
+ * \brief Get a copy of the statistics of a zone
+ * \param[in] zone - The profiled zone
+ * \return count, min, max and total ticks of the zone
+ */
+profiler_stats_t profiler_GetStats(const PROFILER_ZONE zone) {
+#if defined(STM32L152xE)
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+#endif
+    profiler_stats_t stats = s_stats[zone];
+#if defined(STM32L152xE)
+    __set_PRIMASK(primask);
+#endif
+    return stats;
+}
+
+/**
+ * \brief Get the mean duration of a zone
+ * \param[in] zone - The profiled zone
+ * \return Mean ticks, 0 when the zone has not been entered yet
+ */
+uint32_t profiler_GetMean(const PROFILER_ZONE zone) {
+    profiler_stats_t stats = profiler_GetStats(zone);
+    if (stats.count == 0) {
+        return 0;
+    }
+    return (uint32_t)(stats.total / stats.count);
+}
+
+/**
+ * \brief Print min/max/mean cycles of all entered zones
+ * \param[in] print - Output function, ex. debug_console
+ * \author agent, agent@local, Oct.2026
+ */
+void profiler_Report(void (*print)(const char *message)) {
+    char msg[100];
+    print("zone: count, min/max/mean cycles\n\r");
+    for (uint32_t i = 0; i < PROF_ZONE_COUNT; i++) {
+        profiler_stats_t stats = profiler_GetStats(i);
+        if (stats.count == 0) {
+            continue;
+        }
+        snprintf(msg, sizeof(msg), "%s: %lu, %lu/%lu/%lu\n\r", s_zone_names[i],
+                 (unsigned long)stats.count, (unsigned long)stats.min, (unsigned long)stats.max,
+                 (unsigned long)(stats.total / stats.count));
+        print(msg);
+    }
+}
@@ -0,0 +1,74 @@
+/*
+ * profiler.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+#include <stdint.h>
+
+#define PROFILER_EN              1
+#define PROFILER_REPORT_PERIOD_S 60U  // console report interval of the main loop
+
+/*
+ * Time base of the profiler. On target it is the Cortex-M3 DWT cycle counter (1 tick = 1 CPU
+ * cycle). On the host build it is CLOCK_MONOTONIC in nanoseconds, scaled to CPU cycles of the
+ * target clock, so that numbers from both builds can be compared directly.
+ */
+#define PROFILER_TICKS_PER_US 32U  // 32 MHz system clock
+
+#if defined(STM32L152xE)
+#include "stm32l1xx.h"
+#endif
+
+/* Profiled zones */
+typedef enum {
+    PROF_ZONE_MODBUS_RUN_REQUEST = 0,
+    PROF_ZONE_CRC16,
+    PROF_ZONE_CRC8,
+    PROF_ZONE_SGP30_I2C,
+    PROF_ZONE_ISR_DMA1_CH5,
+    PROF_ZONE_ISR_USART1,
+    PROF_ZONE_ISR_DMA1_CH6,
+    PROF_ZONE_ISR_USART2,
+    PROF_ZONE_ISR_I2C1_EV,
+    PROF_ZONE_COUNT
+} PROFILER_ZONE;
+
+typedef struct profiler_stats_type {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t total;
+} profiler_stats_t;
+
+/**
+ * \brief Read the profiler time base
+ * \return Current time in profiler ticks (CPU cycles)
+ */
+#if defined(STM32L152xE)
+static inline uint32_t profiler_Now(void) { return DWT->CYCCNT; }
+#else
+uint32_t profiler_Now(void);
+#endif
+
+void             profiler_Init(void);
+void             profiler_Reset(void);
+void             profiler_Record(const PROFILER_ZONE zone, const uint32_t ticks);
+profiler_stats_t profiler_GetStats(const PROFILER_ZONE zone);
+uint32_t         profiler_GetMean(const PROFILER_ZONE zone);
+void             profiler_Report(void (*print)(const char *message));
+
+/* Scoped begin/end markers. BEGIN and END of one zone must be in the same block. */
+#if (PROFILER_EN > 0u)
+#define PROFILER_BEGIN(zone) const uint32_t profiler_t0_##zone = profiler_Now()
+#define PROFILER_END(zone)   profiler_Record((zone), profiler_Now() - profiler_t0_##zone)
+#else
+#define PROFILER_BEGIN(zone)
+#define PROFILER_END(zone)
+#endif
+
+#endif /* PROFILER_H_ */
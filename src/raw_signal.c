@@ -0,0 +1,131 @@
+/*
+ * raw_signal.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+#include "raw_signal.h"
+
+raw_signal_t raw_data;
+
+/* Private functions */
+static void s_ChannelReset(raw_channel_t *const ch) {
+    for (uint32_t i = 0; i < RAW_SIGNAL_SERIES_LEN; i++) {
+        ch->series[i] = 0;
+    }
+    ch->decimSum  = 0;
+    ch->windowSum = 0;
+    ch->windowMin = UINT16_MAX;
+    ch->windowMax = 0;
+    ch->min       = 0;
+    ch->max       = 0;
+    ch->mean      = 0;
+}
+
+static inline void s_ChannelAdd(raw_channel_t *const ch, const uint16_t sample) {
+    ch->decimSum  += sample;
+    ch->windowSum += sample;
+    if (sample < ch->windowMin) {
+        ch->windowMin = sample;
+    }
+    if (sample > ch->windowMax) {
+        ch->windowMax = sample;
+    }
+}
+
+static inline void s_ChannelDecimate(raw_channel_t *const ch, const uint16_t slot) {
+    // Rounded mean of the decimation block, a first order CIC with R = RAW_SIGNAL_DECIMATION
+    ch->series[slot] = (uint16_t)((ch->decimSum + (RAW_SIGNAL_DECIMATION / 2)) >>
+                                  RAW_SIGNAL_DECIMATION_LOG2);
+    ch->decimSum     = 0;
+}
+
+static inline void s_ChannelCloseWindow(raw_channel_t *const ch, const uint16_t count) {
+    ch->min       = ch->windowMin;
+    ch->max       = ch->windowMax;
+    ch->mean      = (uint16_t)((ch->windowSum + count / 2) / count);
+    ch->windowSum = 0;
+    ch->windowMin = UINT16_MAX;
+    ch->windowMax = 0;
+}
+
+/* Public functions */
+/**
+ * \brief Clear the decimation filters, series and window statistics. Streaming is off.
+ * \author agent, agent@local, Oct.2026
+ */
+void rawSignal_Init(void) {
+    raw_data.mode          = RAW_MODE_OFF;
+    raw_data.windowSeq     = 0;
+    raw_data.windowSamples = 0;
+    raw_data.seriesSeq     = 0;
+    raw_data.decimCount    = 0;
+    raw_data.windowCount   = 0;
+    s_ChannelReset(&raw_data.h2);
+    s_ChannelReset(&raw_data.ethanol);
+}
+
+/**
+ * \brief Feed one raw H2/Ethanol sample to the decimation filters and window statistics
+ * \param[in] h2 - sout_H2 from sgp30_MeasureRawSignals
+ * \param[in] ethanol - sout_EthOH from sgp30_MeasureRawSignals
+ * \author agent, agent@local, Oct.2026
+ */
+void rawSignal_AddSample(const uint16_t h2, const uint16_t ethanol) {
+    s_ChannelAdd(&raw_data.h2, h2);
+    s_ChannelAdd(&raw_data.ethanol, ethanol);
+    raw_data.windowCount++;
+
+    if (++raw_data.decimCount >= RAW_SIGNAL_DECIMATION) {
+        uint16_t slot = raw_data.seriesSeq % RAW_SIGNAL_SERIES_LEN;
+        s_ChannelDecimate(&raw_data.h2, slot);
+        s_ChannelDecimate(&raw_data.ethanol, slot);
+        raw_data.decimCount = 0;
+        raw_data.seriesSeq++;
+    }
+}
+
+/**
+ * \brief Publish min/max/mean of the samples added since the previous call
+ * \return 0 when success, -1 when the window is empty and the statistics were not updated
+ * \author agent, agent@local, Oct.2026
+ */
+int32_t rawSignal_CloseWindow(void) {
+    if (raw_data.windowCount == 0) {
+        return -1;
+    }
+    s_ChannelCloseWindow(&raw_data.h2, raw_data.windowCount);
+    s_ChannelCloseWindow(&raw_data.ethanol, raw_data.windowCount);
+    raw_data.windowSamples = raw_data.windowCount;
+    raw_data.windowCount   = 0;
+    raw_data.windowSeq++;
+    return 0;
+}
+
+/**
+ * \brief Read one register of the decimated H2/Ethanol series, oldest sample first
+ * \param[in] reg_addr - Register address
+ * \param[out] value - The decimated sample, 0 when not produced yet
+ * \return 0 when success, -1 when the address is not a series register
+ * \author agent, agent@local, Oct.2026
+ */
+int32_t rawSignal_ReadRegister(const uint16_t reg_addr, uint16_t *const value) {
+    const raw_channel_t *ch;
+    uint16_t             offset;
+
+    if ((reg_addr >= RAW_SIGNAL_REG_H2_SERIES) &&
+        (reg_addr < RAW_SIGNAL_REG_H2_SERIES + RAW_SIGNAL_SERIES_LEN)) {
+        ch     = &raw_data.h2;
+        offset = reg_addr - RAW_SIGNAL_REG_H2_SERIES;
+    } else if ((reg_addr >= RAW_SIGNAL_REG_ETHANOL_SERIES) &&
+               (reg_addr < RAW_SIGNAL_REG_ETHANOL_SERIES + RAW_SIGNAL_SERIES_LEN)) {
+        ch     = &raw_data.ethanol;
+        offset = reg_addr - RAW_SIGNAL_REG_ETHANOL_SERIES;
+    } else {
+        return -1;
+    }
+
+    // seriesSeq is the slot of the oldest sample once the ring is full
+    *value = ch->series[(uint16_t)(raw_data.seriesSeq + offset) % RAW_SIGNAL_SERIES_LEN];
+    return 0;
+}
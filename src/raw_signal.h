@@ -0,0 +1,54 @@
+/*
+ * raw_signal.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef RAW_SIGNAL_H_
+#define RAW_SIGNAL_H_
+
+#include <stdint.h>
+
+/* Raw H2/Ethanol acquisition parameters */
+#define RAW_SIGNAL_SAMPLE_TIME_MS  27U  // 25ms measurement + I2C transfer
+#define RAW_SIGNAL_DECIMATION_LOG2 3U   // running mean over 8 raw samples per output
+#define RAW_SIGNAL_DECIMATION      (1U << RAW_SIGNAL_DECIMATION_LOG2)
+#define RAW_SIGNAL_SERIES_LEN      32U  // decimated samples kept per channel
+
+/* Decimated series register blocks, oldest sample first */
+#define RAW_SIGNAL_REG_H2_SERIES      0x0200U
+#define RAW_SIGNAL_REG_ETHANOL_SERIES (RAW_SIGNAL_REG_H2_SERIES + RAW_SIGNAL_SERIES_LEN)
+
+typedef enum { RAW_MODE_OFF = 0, RAW_MODE_STREAMING } RAW_MODE;
+
+typedef struct raw_channel_type {
+    uint16_t series[RAW_SIGNAL_SERIES_LEN];  // decimated output, ring buffer
+    uint32_t decimSum;                       // running sum of the current decimation block
+    uint32_t windowSum;                      // sum of the raw samples in the current window
+    uint16_t windowMin;
+    uint16_t windowMax;
+    uint16_t min;  // statistics of the last closed window
+    uint16_t max;
+    uint16_t mean;
+} raw_channel_t;
+
+typedef struct raw_signal_type {
+    uint16_t      mode;           // RAW_MODE, written by the Modbus master
+    uint16_t      windowSeq;      // number of closed windows
+    uint16_t      windowSamples;  // number of raw samples in the last closed window
+    uint16_t      seriesSeq;      // number of decimated samples produced
+    uint16_t      decimCount;     // raw samples in the current decimation block
+    uint16_t      windowCount;    // raw samples in the current window
+    raw_channel_t h2;
+    raw_channel_t ethanol;
+} raw_signal_t;
+
+extern raw_signal_t raw_data;
+
+void    rawSignal_Init(void);
+void    rawSignal_AddSample(const uint16_t h2, const uint16_t ethanol);
+int32_t rawSignal_CloseWindow(void);
+int32_t rawSignal_ReadRegister(const uint16_t reg_addr, uint16_t *const value);
+
+#endif /* RAW_SIGNAL_H_ */
@@ -0,0 +1,78 @@
+/*
+ * report.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+#include "report.h"
+
+report_t report_data;
+
+/**
+ * \brief The distance of two unsigned measurements
+ * \author agent, agent@local, Oct.2026
+ */
+static inline uint16_t s_Distance(const uint16_t a, const uint16_t b) {
+    return (a > b) ? (uint16_t)(a - b) : (uint16_t)(b - a);
+}
+
+/**
+ * \brief Set the default deadbands, no change event is pending
+ * \author agent, agent@local, Oct.2026
+ */
+void report_Init(void) {
+    report_data.deadbandCO2  = REPORT_DEADBAND_CO2;
+    report_data.deadbandTVOC = REPORT_DEADBAND_TVOC;
+    report_data.seq          = 0;
+    report_data.ack          = 0;
+    report_data.refCO2       = 0;
+    report_data.refTVOC      = 0;
+    report_data.status       = 0;
+}
+
+/**
+ * \brief Compare a measurement with the last change event, called once per measurement
+ * \param[in] valid - 0 when the measurement failed, co2 and tvoc are then ignored
+ * \param[in] co2 - CO2eq in ppm
+ * \param[in] tvoc - TVOC in ppb
+ * \return 1 when a change event was counted, 0 when not
+ * \author agent, agent@local, Oct.2026
+ */
+int32_t report_Update(const int32_t valid, const uint16_t co2, const uint16_t tvoc) {
+    uint16_t status = valid ? REPORT_STATUS_VALID : 0;
+
+    if (valid && (report_data.status & REPORT_STATUS_VALID)) {
+        if (s_Distance(co2, report_data.refCO2) > report_data.deadbandCO2) {
+            status |= REPORT_STATUS_CO2;
+        }
+        if (s_Distance(tvoc, report_data.refTVOC) > report_data.deadbandTVOC) {
+            status |= REPORT_STATUS_TVOC;
+        }
+        if (!(status & (REPORT_STATUS_CO2 | REPORT_STATUS_TVOC))) {
+            return 0;
+        }
+    } else if ((status ^ report_data.status) == 0) {
+        return 0;  // still invalid
+    }
+
+    if (valid) {
+        report_data.refCO2  = co2;
+        report_data.refTVOC = tvoc;
+    }
+    report_data.status = status;
+    report_data.seq++;
+    return 1;
+}
+
+/**
+ * \brief The REPORT_STATUS register
+ * \return REPORT_STATUS_* bits
+ * \author agent, agent@local, Oct.2026
+ */
+uint16_t report_Status(void) {
+    uint16_t status = report_data.status;
+    if (report_data.seq != report_data.ack) {
+        status |= REPORT_STATUS_CHANGED;
+    }
+    return status;
+}
@@ -0,0 +1,47 @@
+/*
+ * report.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef REPORT_H_
+#define REPORT_H_
+
+#include <stdint.h>
+
+/*
+ * Change-triggered reporting. The SGP30 keeps its 1 Hz measurement cadence, but a change event is
+ * counted only when CO2eq or TVOC moves beyond its deadband from the values of the previous event,
+ * or when the measurement becomes valid or invalid. A master polls REPORT_STATUS (or compares
+ * the change sequence with its own copy) and reads the measurements only after a change.
+ *
+ * The master acknowledges by writing the sequence it has read to the ack register, which clears
+ * REPORT_STATUS_CHANGED. Masters that keep the last sequence per node do not need to write.
+ */
+#define REPORT_DEADBAND_CO2  50U  // ppm, default deadband of CO2eq
+#define REPORT_DEADBAND_TVOC 25U  // ppb, default deadband of TVOC
+
+/* REPORT_STATUS bits */
+#define REPORT_STATUS_CHANGED (uint16_t)0x01  // change events not acknowledged by the master
+#define REPORT_STATUS_CO2     (uint16_t)0x02  // CO2eq left its deadband in the last event
+#define REPORT_STATUS_TVOC    (uint16_t)0x04  // TVOC left its deadband in the last event
+#define REPORT_STATUS_VALID   (uint16_t)0x08  // the last measurement is valid
+
+typedef struct report_type {
+    uint16_t deadbandCO2;   // ppm, written by the Modbus master, 0 reports every change
+    uint16_t deadbandTVOC;  // ppb, written by the Modbus master, 0 reports every change
+    uint16_t seq;           // change events since power-on
+    uint16_t ack;           // last sequence read by the master, written by the Modbus master
+    uint16_t refCO2;        // measurement of the last event
+    uint16_t refTVOC;
+    uint16_t status;        // REPORT_STATUS_CO2/TVOC/VALID of the last event
+} report_t;
+
+extern report_t report_data;
+
+void     report_Init(void);
+int32_t  report_Update(const int32_t valid, const uint16_t co2, const uint16_t tvoc);
+uint16_t report_Status(void);
+
+#endif /* REPORT_H_ */
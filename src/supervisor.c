@@ -0,0 +1,179 @@
+/*
+ * supervisor.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+#include "supervisor.h"
+
+#include "eeprom.h"
+#include "modbus_map.h"
+
+#define SUPERVISOR_EE_ADDR(word) (EEPROM_SGP30_OFFSET + 4U * (word))
+
+supervisor_t sup_data;
+
+/* Private functions */
+/**
+ * \brief Read the persisted baseline
+ * \param[out] baseline_co2 - CO2eq baseline
+ * \param[out] baseline_tvoc - TVOC baseline
+ * \return 0 when a valid record was found, -1 when not
+ * \author agent, agent@local, Oct.2026
+ */
+static int32_t s_LoadBaseline(uint16_t *const baseline_co2, uint16_t *const baseline_tvoc) {
+    uint32_t baseline = eeprom_ReadWord(SUPERVISOR_EE_ADDR(SUPERVISOR_EE_WORD_BASELINE));
+
+    if ((eeprom_ReadWord(SUPERVISOR_EE_ADDR(SUPERVISOR_EE_WORD_MAGIC)) != SUPERVISOR_EE_MAGIC) ||
+        (eeprom_ReadWord(SUPERVISOR_EE_ADDR(SUPERVISOR_EE_WORD_CHECK)) != ~baseline)) {
+        return -1;
+    }
+    *baseline_co2  = (uint16_t)(baseline >> 16);
+    *baseline_tvoc = (uint16_t)(baseline & 0xffff);
+    return 0;
+}
+
+/**
+ * \brief Count a fault and wait before the next probe
+ * \author agent, agent@local, Oct.2026
+ */
+static void s_Fault(void) {
+    if (sup_data.faults < UINT16_MAX) {
+        sup_data.faults++;
+    }
+    rFlag &= ~(RFLAG_CO2 | RFLAG_TVOC | RFLAG_BASE_CO2 | RFLAG_BASE_TVOC | RFLAG_FEATURE_SET |
+               RFLAG_SERIAL_ID | RFLAG_HUMIDITY);
+    sup_data.state   = SUPERVISOR_BACKOFF;
+    sup_data.wait    = sup_data.backoff;
+    sup_data.backoff = (sup_data.backoff < SUPERVISOR_BACKOFF_MAX_S / 2U)
+                           ? (uint16_t)(2U * sup_data.backoff)
+                           : (uint16_t)SUPERVISOR_BACKOFF_MAX_S;
+}
+
+/**
+ * \brief Detect and initialize the sensor, restore the persisted baseline
+ * \param[out] sgp_data - Serial ID and feature set
+ * \return 0 when the sensor is measuring, -1 when not
+ * \author agent, agent@local, Oct.2026
+ */
+static int32_t s_Probe(sgp30_t *const sgp_data) {
+    uint16_t baseline_co2, baseline_tvoc;
+
+    if (SGP30_SUCCESS != sgp30_GetSerialId(sgp_data)) {
+        return -1;
+    }
+    rFlag |= RFLAG_SERIAL_ID;
+    if (SGP30_SUCCESS == sgp30_GetFeatureSetVersion(sgp_data)) {
+        rFlag |= RFLAG_FEATURE_SET;
+    }
+    if (SGP30_SUCCESS != sgp30_InitAirQuality()) {
+        return -1;
+    }
+
+    // The baseline has to be set after Init_air_quality
+    sup_data.restored = 0;
+    if ((0 == s_LoadBaseline(&baseline_co2, &baseline_tvoc)) &&
+        (SGP30_SUCCESS == sgp30_SetBaseline(baseline_co2, baseline_tvoc))) {
+        sup_data.restored = 1;
+    }
+    // The reset lost the humidity compensation, the main loop sends it again
+    rFlag &= ~RFLAG_HUMIDITY;
+    return 0;
+}
+
+/* Public functions */
+/**
+ * \brief Start with a probe, no reset before the first one
+ * \author agent, agent@local, Oct.2026
+ */
+void supervisor_Init(void) {
+    sup_data.state      = SUPERVISOR_PROBE;
+    sup_data.faults     = 0;
+    sup_data.resets     = 0;
+    sup_data.recoveries = 0;
+    sup_data.backoff    = 1;
+    sup_data.wait       = 0;
+    sup_data.failRun    = 0;
+    sup_data.restored   = 0;
+    sup_data.uptime     = 0;
+}
+
+/**
+ * \brief Run the supervisor, once per main loop before the measurement
+ * \param[out] sgp_data - Serial ID and feature set when the sensor is probed
+ * \return 1 when the sensor is online and the main loop can measure, 0 when not
+ * \author agent, agent@local, Oct.2026
+ */
+int32_t supervisor_Run(sgp30_t *const sgp_data) {
+    switch (sup_data.state) {
+        case SUPERVISOR_ONLINE:
+            sup_data.uptime++;
+            return 1;
+        case SUPERVISOR_BACKOFF:
+            if (sup_data.wait > 1) {
+                sup_data.wait--;
+                return 0;
+            }
+            // The sensor may hang in a command or hold the bus, restart it before the probe
+            if (sup_data.resets < UINT16_MAX) {
+                sup_data.resets++;
+            }
+            sgp30_SoftReset();
+            break;
+        default:
+            break;
+    }
+
+    if (0 != s_Probe(sgp_data)) {
+        s_Fault();
+        return 0;
+    }
+    if ((sup_data.faults > 0) && (sup_data.recoveries < UINT16_MAX)) {
+        sup_data.recoveries++;
+    }
+    sup_data.state   = SUPERVISOR_ONLINE;
+    sup_data.backoff = 1;
+    sup_data.failRun = 0;
+    sup_data.uptime  = 0;
+    return 1;
+}
+
+/**
+ * \brief Report the result of a measurement, SUPERVISOR_FAIL_LIMIT failures in a row take the
+ * sensor offline
+ * \param[in] err - The result of sgp30_MeasureAirQuality
+ * \author agent, agent@local, Oct.2026
+ */
+void supervisor_Result(const SGP30ERR err) {
+    if (sup_data.state != SUPERVISOR_ONLINE) {
+        return;
+    }
+    if (SGP30_SUCCESS == err) {
+        sup_data.failRun = 0;
+    } else if (++sup_data.failRun >= SUPERVISOR_FAIL_LIMIT) {
+        s_Fault();
+    }
+}
+
+/**
+ * \brief Persist the baseline read by spg30_GetBaseLine, when the baseline is valid
+ * \param[in] baseline_co2 - CO2eq baseline
+ * \param[in] baseline_tvoc - TVOC baseline
+ * \return 0 when persisted, -1 when the baseline is not valid yet or the write failed
+ * \author agent, agent@local, Oct.2026
+ */
+int32_t supervisor_SaveBaseline(const uint16_t baseline_co2, const uint16_t baseline_tvoc) {
+    uint32_t baseline = ((uint32_t)baseline_co2 << 16) | baseline_tvoc;
+
+    if (!sup_data.restored && (sup_data.uptime < SUPERVISOR_EARLY_S)) {
+        return -1;
+    }
+    // The check word goes last, an interrupted write leaves an invalid record
+    if ((0 != eeprom_WriteWord(SUPERVISOR_EE_ADDR(SUPERVISOR_EE_WORD_MAGIC),
+                               SUPERVISOR_EE_MAGIC)) ||
+        (0 != eeprom_WriteWord(SUPERVISOR_EE_ADDR(SUPERVISOR_EE_WORD_BASELINE), baseline)) ||
+        (0 != eeprom_WriteWord(SUPERVISOR_EE_ADDR(SUPERVISOR_EE_WORD_CHECK), ~baseline))) {
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,62 @@
+/*
+ * supervisor.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef SUPERVISOR_H_
+#define SUPERVISOR_H_
+
+#include <stdint.h>
+
+#include "sgp30.h"
+
+/*
+ * SGP30 supervisor, run once per main loop.
+ *
+ * PROBE reads the serial ID and the feature set, starts the air quality algorithm and restores
+ * the baseline persisted in the data EEPROM. SUPERVISOR_FAIL_LIMIT failed measurements in a row,
+ * or a failed probe, move to BACKOFF: the next probe follows after 1, 2, 4... seconds up to
+ * SUPERVISOR_BACKOFF_MAX_S, and each probe after a fault starts with the I2C general call reset.
+ *
+ * The baseline is persisted when the main loop reads it every hour, but only once it is valid:
+ * right after a restore, or after SUPERVISOR_EARLY_S of operation without a stored baseline. The
+ * record has no time stamp, the datasheet's 7 day limit on a stored baseline is not checked.
+ */
+#define SUPERVISOR_FAIL_LIMIT    3U      // failed measurements in a row before a reset
+#define SUPERVISOR_BACKOFF_MAX_S 64U     // s, longest wait between probes
+#define SUPERVISOR_EARLY_S       43200U  // s, 12h before a new baseline is valid
+
+/* Baseline record in the EEPROM_SGP30 region, word offsets */
+#define SUPERVISOR_EE_MAGIC         0x53473330U  // "SG30"
+#define SUPERVISOR_EE_WORD_MAGIC    0U
+#define SUPERVISOR_EE_WORD_BASELINE 1U           // CO2eq << 16 | TVOC
+#define SUPERVISOR_EE_WORD_CHECK    2U           // ~baseline word
+
+typedef enum {
+    SUPERVISOR_PROBE = 0,  // detect and initialize the sensor in this loop
+    SUPERVISOR_ONLINE,     // measuring
+    SUPERVISOR_BACKOFF     // waiting for the next probe
+} SUPERVISOR_STATE;
+
+typedef struct supervisor_type {
+    uint16_t state;       // SUPERVISOR_STATE
+    uint16_t faults;      // failed probes and measurements since power-on
+    uint16_t resets;      // general call resets since power-on
+    uint16_t recoveries;  // successful probes after a fault
+    uint16_t backoff;     // s, wait before the next probe
+    uint16_t wait;        // s, left of the current wait
+    uint16_t failRun;     // failed measurements in a row
+    uint16_t restored;    // 1 when the baseline was restored from the EEPROM
+    uint32_t uptime;      // s since the last successful probe
+} supervisor_t;
+
+extern supervisor_t sup_data;
+
+void    supervisor_Init(void);
+int32_t supervisor_Run(sgp30_t *const sgp_data);
+void    supervisor_Result(const SGP30ERR err);
+int32_t supervisor_SaveBaseline(const uint16_t baseline_co2, const uint16_t baseline_tvoc);
+
+#endif /* SUPERVISOR_H_ */
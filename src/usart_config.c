@@ -2,8 +2,11 @@
 
 #include <string.h>
 
+#include "irq_stats.h"
 #include "stm32l1xx.h"
-#include "utils.h"
+
+static uint8_t          s_rs485TxBuffer[USART1_TX_DMA_BUFFER_SIZE];
+static volatile uint8_t s_rs485TxBusy;  // the reply is being sent, DE is high
 
 /*
  * usart_config.c
@@ -13,7 +16,7 @@
  */
 
 /**
- * \brief           Initialize USART1 with DMA in normal mode on RX
+ * \brief           Initialize USART1 with DMA in normal mode on RX and TX
  */
 void USART1_dma_init(void) {
     /*
@@ -22,7 +25,8 @@ void USART1_dma_init(void) {
      * PA9/D8   ------> USART1_TX
      * PA10/D2  ------> USART1_RX
      * PA7/D11	------> TX_EN
-     * USART2_RX --> DMA1_channel_5
+     * USART1_RX --> DMA1_channel_5
+     * USART1_TX --> DMA1_channel_4
      */
 
     // ref. manual p.260
@@ -44,9 +48,16 @@ void USART1_dma_init(void) {
     DMA1_Channel5->CNDTR = (uint16_t)USART1_RX_DMA_BUFFER_SIZE; /*!< Set data length */
 
     /* DMA interrupt init */
-    NVIC_SetPriority(DMA1_Channel5_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), 0, 0));
+    NVIC_SetPriority(DMA1_Channel5_IRQn,
+                     NVIC_EncodePriority(NVIC_GetPriorityGrouping(), IRQ_PRIORITY_RS485_RX, 0));
     NVIC_EnableIRQ(DMA1_Channel5_IRQn);
 
+    /* TX, the buffer length is set by rs485_send_data for every frame */
+    DMA1_Channel4->CCR  = (DMA_CCR_DIR |                 /*!< Memory to peripheral */
+                          DMA_CCR_MINC);                 /*!< Memory increment, 8-bits, normal */
+    DMA1_Channel4->CPAR = (uint32_t) & (USART1->DR);     /*!< set peripheral address */
+    DMA1_Channel4->CMAR = (uint32_t)s_rs485TxBuffer;
+
     /* USART configuration */
     // ref. manual p.247
     RCC->APB2ENR |= RCC_APB2ENR_USART1EN;  // set bit 14 (USART1 clock EN)
@@ -68,11 +79,12 @@ void USART1_dma_init(void) {
     USART1->BRR = USART_BRR_VAL;      // 9600 BAUD and crystal 32MHz. p710, D05
     USART1->CR1 |= USART_CR1_TE;      // TE bit. p739-740. Enable transmit
     USART1->CR1 |= USART_CR1_RE;      // RE bit. p739-740. Enable receiver
-    USART1->CR3 |= USART_CR3_DMAR;    /*!< DMA Enable Receiver */
+    USART1->CR3 |= USART_CR3_DMAR | USART_CR3_DMAT;  /*!< DMA Enable Receiver and Transmitter */
     USART1->CR1 |= USART_CR1_IDLEIE;  // Enable idle line detection interrupt
 
     /* USART interrupt */
-    NVIC_SetPriority(USART1_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), 0, 0));
+    NVIC_SetPriority(USART1_IRQn,
+                     NVIC_EncodePriority(NVIC_GetPriorityGrouping(), IRQ_PRIORITY_RS485_RX, 0));
     NVIC_EnableIRQ(USART1_IRQn);
 
     /* Enable USART and DMA */
@@ -155,18 +167,35 @@ void DMA1_Channel15_Reload(void) {
 }
 
 /**
- * \brief           Send string to USART1
- * \param[in]       str: String to send
+ * \brief           Start sending a frame to RS-485 with USART1 TX DMA, returns at once
+ * \param[in]       data: the frame, copied, the caller may reuse it
+ * \param[in]       len: the length of the frame, at most USART1_TX_DMA_BUFFER_SIZE
+ * \details         The USART1 TC interrupt calls rs485_tx_complete, which releases the bus. A
+ *                  frame is dropped while the previous one is still being sent.
  */
 void rs485_send_data(const uint8_t *data, const size_t len) {
-    RS485_TX_Enable();
-    for (size_t i = 0; i < len; i++) {
-        USART1_write(data[i]);
+    if (s_rs485TxBusy || (len == 0) || (len > USART1_TX_DMA_BUFFER_SIZE)) {
+        return;
     }
-    while (!(USART2->SR & USART_SR_TC)) {
-    }             /*!< Transmission Complete */
-    delay_ms(3);  // measured with oscilloscope, it can be a bit shorter
+    memcpy(s_rs485TxBuffer, data, len);
+    s_rs485TxBusy = 1;
+    RS485_TX_Enable();
+    DMA1_Channel4->CCR   &= ~DMA_CCR_EN;
+    DMA1->IFCR           = DMA_IFCR_CGIF4;
+    DMA1_Channel4->CNDTR = (uint16_t)len;
+    USART1->SR           &= ~USART_SR_TC;
+    USART1->CR1          |= USART_CR1_TCIE;
+    DMA1_Channel4->CCR   |= DMA_CCR_EN;
+}
+
+/**
+ * \brief           USART1 TC interrupt: the stop bit of the last byte is out, release the bus
+ */
+void rs485_tx_complete(void) {
+    USART1->CR1        &= ~USART_CR1_TCIE;
+    DMA1_Channel4->CCR &= ~DMA_CCR_EN;
     RS485_TX_Disable();
+    s_rs485TxBusy = 0;
 }
 
 /**
@@ -200,7 +229,8 @@ void USART2_dma_init(void) {
     DMA1_Channel6->CNDTR = (uint16_t)USART2_RX_DMA_BUFFER_SIZE; /*!< Set data length */
 
     /* DMA interrupt init */
-    NVIC_SetPriority(DMA1_Channel6_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), 0, 0));
+    NVIC_SetPriority(DMA1_Channel6_IRQn,
+                     NVIC_EncodePriority(NVIC_GetPriorityGrouping(), IRQ_PRIORITY_CONSOLE, 0));
     NVIC_EnableIRQ(DMA1_Channel6_IRQn);
 
     /* USART configuration */
@@ -219,7 +249,8 @@ void USART2_dma_init(void) {
     USART2->CR1 |= USART_CR1_IDLEIE;  // Enable idle line detection interrupt
 
     /* USART interrupt */
-    NVIC_SetPriority(USART2_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), 0, 0));
+    NVIC_SetPriority(USART2_IRQn,
+                     NVIC_EncodePriority(NVIC_GetPriorityGrouping(), IRQ_PRIORITY_CONSOLE, 0));
     NVIC_EnableIRQ(USART2_IRQn);
 
     /* Enable USART and DMA */
@@ -227,6 +258,56 @@ void USART2_dma_init(void) {
     USART2->CR1        |= USART_CR1_UE;  // UE bit. p739-740. Uart enable
 }
 
+/**
+ * \brief           Initialize USART3 with DMA on TX and RX, for the Modbus master
+ */
+void USART3_dma_init(void) {
+    /*
+     * USART3 GPIO and DMA configuration
+     *
+     * PB10     ------> USART3_TX
+     * PB11     ------> USART3_RX
+     * PB5/D4   ------> TX_EN
+     * USART3_TX --> DMA1_channel_2
+     * USART3_RX --> DMA1_channel_3
+     *
+     * The buffers and transfer lengths are set by modbus_master.c for every frame.
+     */
+
+    // ref. manual p.260
+    RCC->AHBENR         |= RCC_AHBENR_DMA1EN;            // DMA1 clock enable
+    DMA1_Channel2->CCR  = (DMA_CCR_DIR |                 /*!< Memory to peripheral */
+                          DMA_CCR_MINC);                 /*!< Memory increment, 8-bits, normal */
+    DMA1_Channel3->CCR  = DMA_CCR_MINC;                  /*!< Peripheral to memory, 8-bits */
+    DMA1_Channel2->CPAR = (uint32_t) & (USART3->DR);     /*!< set peripheral address */
+    DMA1_Channel3->CPAR = (uint32_t) & (USART3->DR);
+
+    /* USART configuration */
+    RCC->APB1ENR  |= RCC_APB1ENR_USART3EN;
+    RCC->AHBENR   |= RCC_AHBENR_GPIOBEN;
+    GPIOB->AFR[1] = (GPIOB->AFR[1] & ~(GPIO_AFRH_AFRH2 | GPIO_AFRH_AFRH3)) |
+                    (0x07 << GPIO_AFRH_AFRH2_Pos) |  // PB10 AF7
+                    (0x07 << GPIO_AFRH_AFRH3_Pos);   // PB11 AF7
+    GPIOB->MODER =
+        (GPIOB->MODER & ~(GPIO_MODER_MODER10 | GPIO_MODER_MODER11 | GPIO_MODER_MODER5)) |
+        (0x02 << GPIO_MODER_MODER10_Pos) |  // PB10 alternate function
+        (0x02 << GPIO_MODER_MODER11_Pos) |  // PB11 alternate function
+        (0x01 << GPIO_MODER_MODER5_Pos);    // PB5 as output
+    GPIOB->ODR &= ~GPIO_ODR_ODR_5;          // Disable TX and Enable RX
+
+    USART3->BRR = USART_BRR_VAL;                     // 9600 BAUD and crystal 32MHz
+    USART3->CR1 |= USART_CR1_TE | USART_CR1_RE;      // Enable transmit and receive
+    USART3->CR3 |= USART_CR3_DMAT | USART_CR3_DMAR;  /*!< DMA Enable Transmitter and Receiver */
+    USART3->CR1 |= USART_CR1_IDLEIE;                 // Enable idle line detection interrupt
+
+    /* USART interrupt */
+    NVIC_SetPriority(USART3_IRQn,
+                     NVIC_EncodePriority(NVIC_GetPriorityGrouping(), IRQ_PRIORITY_RS485_MASTER, 0));
+    NVIC_EnableIRQ(USART3_IRQn);
+
+    USART3->CR1 |= USART_CR1_UE;  // Uart enable
+}
+
 /**
  * \brief           Send a character to USART2
  * \param[in]       data: the character to send
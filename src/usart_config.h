@@ -14,7 +14,8 @@
 #define F_CPU                     32000000UL
 #define BAUDRATE                  9600U
 #define USART_BRR_VAL             (uint32_t)(F_CPU / BAUDRATE)
-#define USART1_RX_DMA_BUFFER_SIZE 8
+#define USART1_RX_DMA_BUFFER_SIZE 32  // longest accepted request, a longer frame is dropped
+#define USART1_TX_DMA_BUFFER_SIZE 256  // longest reply, 125 registers
 #define USART2_RX_DMA_BUFFER_SIZE 8
 
 extern uint8_t usart1_rx_dma_buffer[USART1_RX_DMA_BUFFER_SIZE];
@@ -25,6 +26,7 @@ void USART1_write(const uint8_t data);
 void USART1_RX_Buffer_Reset();
 void DMA1_Channel15_Reload(void);
 void rs485_send_data(const uint8_t* data, const size_t len);
+void rs485_tx_complete(void);
 
 void USART2_dma_init(void);
 char USART2_read(void);
@@ -33,4 +35,6 @@ void DMA1_Channel16_Reload(void);
 void USART2_send_string(const char* string);
 void USART2_send_data(const void* data, size_t len);
 
+void USART3_dma_init(void);
+
 #endif /* USART_CONFIG_H_ */
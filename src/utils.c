@@ -7,33 +7,47 @@
 #include "stm32l1xx.h"
 #include "usart_config.h"
 
-void delay_us(const unsigned long delay) {
-    unsigned long i = 0;
-    SysTick->LOAD   = 32 - 1;  // 32 000 000 = 1s so 32 = 1 us
-    SysTick->VAL    = 0;
-    // enable counter, use processor clock, M3 Generic User Guide p. 159
-    SysTick->CTRL = 5;
+static volatile uint32_t s_tick_ms = 0;  // milliseconds since tick_init
+
+/**
+ * \brief Start the 1ms SysTick time base and the DWT cycle counter used by the delays
+ * \author agent, agent@local, Oct.2026
+ */
+void tick_init(void) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;  // enable DWT
+    DWT->CTRL        |= DWT_CTRL_CYCCNTENA_Msk;      // start cycle counter
+    SysTick_Config(F_CPU / 1000U);                   // 1ms interrupt, lowest priority
+}
 
-    while (i < delay) {
-        // CTRL register bit 16  returns 1 if timer counted to 0 since last time this was read.
-        while (!((SysTick->CTRL) & 0x10000)) {
-        }  // M3 Generic User Guide p. 159
-        i++;
+/**
+ * \brief Milliseconds since tick_init, wraps after 49 days
+ */
+uint32_t tick_ms(void) { return s_tick_ms; }
+
+/**
+ * \brief SysTick interrupt handler, 1ms time base
+ */
+void SysTick_Handler(void) { s_tick_ms++; }
+
+/**
+ * \brief Busy wait. Uses the DWT cycle counter, so it is safe in interrupt handlers and does not
+ * disturb the SysTick time base.
+ * \param[in] delay - microseconds
+ */
+void delay_us(const unsigned long delay) {
+    uint32_t start  = DWT->CYCCNT;
+    uint32_t cycles = (uint32_t)delay * (F_CPU / 1000000U);
+    while ((DWT->CYCCNT - start) < cycles) {
     }
 }
 
+/**
+ * \brief Busy wait, see delay_us
+ * \param[in] delay - milliseconds
+ */
 void delay_ms(const unsigned long delay) {
-    unsigned long i = 0;
-    SysTick->LOAD   = 32000 - 1;  // 32 000 000 = 1s so 32 = 1 us
-    SysTick->VAL    = 0;
-    // enable counter, use processor clock, M3 Generic User Guide p. 159
-    SysTick->CTRL = 5;
-
-    while (i < delay) {
-        // CTRL register bit 16  returns 1 if timer counted to 0 since last time this was read.
-        while (!((SysTick->CTRL) & 0x10000)) {
-        }  // M3 Generic User Guide p. 159
-        i++;
+    for (unsigned long i = 0; i < delay; i++) {
+        delay_us(1000);
     }
 }
 
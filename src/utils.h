@@ -11,8 +11,12 @@
 #define DEBUG_CONSOLE_EN 1
 #define DBUG_MSG_LEN     100
 
-void delay_us(const unsigned long delay);
-void delay_ms(const unsigned long delay);
-void debug_console(const char *message);
+#include <stdint.h>
+
+void     tick_init(void);
+uint32_t tick_ms(void);
+void     delay_us(const unsigned long delay);
+void     delay_ms(const unsigned long delay);
+void     debug_console(const char *message);
 
 #endif /* UTILS_H_ */
@@ -0,0 +1,37 @@
+/*
+ * version.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef VERSION_H_
+#define VERSION_H_
+
+/*
+ * Firmware identity, reported by Modbus FC 0x11 and FC 0x2B/0x0E.
+ *
+ * FW_BUILD_HASH is the short commit hash of the build. Pass it from the build command, e.g.
+ * -DFW_BUILD_HASH=0x$(git rev-parse --short=8 HEAD), 0 marks an untracked build.
+ */
+#define FW_VENDOR_NAME   "VAMK"
+#define FW_PRODUCT_CODE  "SGP30-MODBUS"
+#define FW_PRODUCT_NAME  "SGP30 air quality node"
+#define FW_MODEL_NAME    "NUCLEO-L152RE"
+#define FW_VENDOR_URL    "https://www.vamk.fi"
+
+#define FW_VERSION_MAJOR 1
+#define FW_VERSION_MINOR 4
+#define FW_VERSION_PATCH 0
+
+#define FW_STRINGIFY_(x) #x
+#define FW_STRINGIFY(x)  FW_STRINGIFY_(x)
+#define FW_VERSION_STRING                                                 \
+    FW_STRINGIFY(FW_VERSION_MAJOR) "." FW_STRINGIFY(FW_VERSION_MINOR) "." \
+        FW_STRINGIFY(FW_VERSION_PATCH)
+
+#ifndef FW_BUILD_HASH
+#define FW_BUILD_HASH 0x00000000UL
+#endif
+
+#endif /* VERSION_H_ */
@@ -0,0 +1,26 @@
+"""Minimal host test helpers of the gateway side scripts, the Python side of test.h.
+
+check counts and prints the failures, a test script exits with result() so that make stops at
+the first failing test.
+"""
+import os
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "iot-ticket"))
+
+checks = 0
+failures = 0
+
+
+def check(cond, message, *args):
+    global checks, failures
+    checks += 1
+    if not cond:
+        failures += 1
+        if failures <= 20:
+            print("CHECK failed: " + message.format(*args))
+
+
+def result(name):
+    print("{}: {} checks, {} failed".format(name, checks, failures))
+    return 1 if failures else 0
@@ -0,0 +1,77 @@
+/*
+ * crc_test.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ *
+ * Every software CRC backend against the reference kernels (crc16_Table, crc8_Bitwise) and the
+ * catalogue check values. The hardware backend is only compiled on the host (make crc_hw).
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "crc.h"
+#include "test.h"
+
+#define RANDOM_MESSAGES 200000U
+#define MESSAGE_MAX     300U  // longer than a Modbus frame
+
+#define SGP30_CRC8_INIT 0xFFU
+
+static uint8_t s_message[MESSAGE_MAX];
+
+int main(void) {
+    const uint8_t check[]   = "123456789";
+    const uint8_t sgp30[]   = {0xBE, 0xEF};  // example of the SGP30 datasheet
+    const size_t  check_len = sizeof(check) - 1U;
+
+    // catalogue check values: CRC-16/MODBUS and the SGP30 CRC-8
+    CHECK(crc16_Table(check, check_len) == 0x4B37, "crc16_Table = 0x%04X",
+          crc16_Table(check, check_len));
+    CHECK(crc16_Slice4(check, check_len) == 0x4B37, "crc16_Slice4 = 0x%04X",
+          crc16_Slice4(check, check_len));
+    CHECK(CRC16(check, (uint16_t)check_len) == 0x4B37, "CRC16 = 0x%04X",
+          CRC16(check, (uint16_t)check_len));
+    CHECK(crc8_Bitwise(sgp30, 2, CRC8_TABLE_POLY, SGP30_CRC8_INIT) == 0x92, "crc8_Bitwise = 0x%02X",
+          crc8_Bitwise(sgp30, 2, CRC8_TABLE_POLY, SGP30_CRC8_INIT));
+    CHECK(crc8_Table(sgp30, 2, SGP30_CRC8_INIT) == 0x92, "crc8_Table = 0x%02X",
+          crc8_Table(sgp30, 2, SGP30_CRC8_INIT));
+    CHECK(CRC8(sgp30, 2, CRC8_TABLE_POLY, SGP30_CRC8_INIT, 0x00) == 0x92, "CRC8 = 0x%02X",
+          CRC8(sgp30, 2, CRC8_TABLE_POLY, SGP30_CRC8_INIT, 0x00));
+
+    // empty message: the initial value
+    CHECK(crc16_Slice4(s_message, 0) == CRC16_MODBUS_INIT, "crc16_Slice4 of 0 bytes");
+    CHECK(crc8_Table(s_message, 0, 0x5A) == 0x5A, "crc8_Table of 0 bytes");
+
+    // random messages, all lengths up to 16 first so that every tail of slicing-by-4 is covered
+    for (uint32_t n = 0; n < RANDOM_MESSAGES; n++) {
+        size_t  len  = (n < 16U * 64U) ? (n % 16U) : test_RandomBelow(MESSAGE_MAX + 1U);
+        uint8_t init = (uint8_t)test_Random();
+        uint8_t poly = (uint8_t)(test_Random() | 0x01U);
+        uint8_t xout = (uint8_t)test_Random();
+
+        for (size_t i = 0; i < len; i++) {
+            s_message[i] = (uint8_t)test_Random();
+        }
+        uint16_t ref16 = crc16_Table(s_message, len);
+        CHECK(crc16_Slice4(s_message, len) == ref16, "crc16_Slice4, %lu bytes", (unsigned long)len);
+        CHECK(CRC16(s_message, (uint16_t)len) == ref16, "CRC16, %lu bytes", (unsigned long)len);
+
+        uint8_t ref8 = crc8_Bitwise(s_message, len, CRC8_TABLE_POLY, init);
+        CHECK(crc8_Table(s_message, len, init) == ref8, "crc8_Table, %lu bytes, init 0x%02X",
+              (unsigned long)len, init);
+        CHECK(CRC8(s_message, len, CRC8_TABLE_POLY, init, xout) == (uint8_t)(ref8 ^ xout),
+              "CRC8 poly 0x31, %lu bytes", (unsigned long)len);
+        // other polynomials fall back to the bitwise kernel
+        CHECK(CRC8(s_message, len, poly, init, xout) ==
+                  (uint8_t)(crc8_Bitwise(s_message, len, poly, init) ^ xout),
+              "CRC8 poly 0x%02X, %lu bytes", poly, (unsigned long)len);
+    }
+
+    // CRC of a request of the README, the frames of this project carry it high byte first
+    const uint8_t frame[] = {0x05, 0x04, 0x00, 0x01, 0x00, 0x01};
+    CHECK(CRC16(frame, sizeof(frame)) == ((142U << 8) | 97U), "CO2 request CRC 0x%04X",
+          CRC16(frame, sizeof(frame)));  // "5 4 0 1 0 1 142 97"
+
+    return test_Result("crc_test");
+}
@@ -0,0 +1,162 @@
+/*
+ * dht22_test.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ *
+ * DHT22 transfer decoding from falling edge time stamps, as TIM4_CH1 captures them at 1MHz: two
+ * fixed traces, the timer wrap, glitches, cut and corrupted transfers, and random values encoded
+ * with the bit period jitter of the sensor.
+ */
+#include <string.h>
+
+#include "dht22.h"
+#include "test.h"
+
+#define EDGES  42U  // response start, response end, 40 bits
+#define ROUNDS 100000U
+
+/* 65.2 %RH, 35.1 degC: 0x028C 0x015F, checksum 0xEE */
+static const uint16_t s_warm[EDGES] = {
+    12034, 12195, 12271, 12348, 12426, 12502, 12578, 12656,
+    12775, 12852, 12971, 13049, 13125, 13201, 13320, 13442,
+    13519, 13595, 13671, 13747, 13825, 13902, 13978, 14056,
+    14132, 14252, 14330, 14449, 14527, 14649, 14768, 14888,
+    15007, 15127, 15248, 15370, 15490, 15568, 15687, 15808,
+    15928, 16004,
+};
+
+/* 45.0 %RH, -10.1 degC: 0x01C2 0x8065, checksum 0xA8 */
+static const uint16_t s_cold[EDGES] = {
+    40117, 40277, 40354, 40430, 40508, 40586, 40662, 40740,
+    40816, 40936, 41058, 41180, 41257, 41334, 41412, 41489,
+    41610, 41687, 41807, 41883, 41961, 42037, 42113, 42191,
+    42268, 42346, 42423, 42544, 42666, 42743, 42821, 42940,
+    43016, 43138, 43258, 43335, 43455, 43532, 43654, 43730,
+    43808, 43884,
+};
+
+static uint16_t s_edges[DHT22_EDGES_MAX];
+
+/* Decode and check the result, out must stay untouched when the decoding fails */
+static void s_Expect(const char *name, const uint16_t *const edges, const size_t n,
+                     const DHT22ERR expected, const int16_t temperature, const uint16_t rh) {
+    dht22_t  out    = {0x7FFF, 0xFFFF, 0, 0};
+    DHT22ERR result = dht22_Decode(edges, n, &out);
+
+    CHECK(result == expected, "%s: result %d, expected %d", name, result, expected);
+    if (expected == DHT22_SUCCESS) {
+        CHECK((out.temperature == temperature) && (out.rh == rh), "%s: %d/10 degC %u/10 %%RH",
+              name, out.temperature, out.rh);
+    } else {
+        CHECK((out.temperature == 0x7FFF) && (out.rh == 0xFFFF), "%s: output written", name);
+    }
+}
+
+/* Copy a trace into s_edges, moved by offset in the 16-bit timer range */
+static void s_Copy(const uint16_t *const trace, const uint16_t offset) {
+    for (size_t i = 0; i < EDGES; i++) {
+        s_edges[i] = (uint16_t)(trace[i] + offset);
+    }
+}
+
+/* Change the period before edge i by delta, the later edges move with it */
+static void s_Stretch(const size_t i, const int delta) {
+    for (size_t k = i; k < EDGES; k++) {
+        s_edges[k] = (uint16_t)(s_edges[k] + delta);
+    }
+}
+
+/* Set the period before edge i */
+static void s_SetPeriod(const size_t i, const uint16_t period) {
+    s_Stretch(i, (int)period - (int)(uint16_t)(s_edges[i] - s_edges[i - 1]));
+}
+
+/* Invert bit of s_edges: a 0 period becomes a 1 period and back */
+static void s_FlipBit(const size_t bit) {
+    uint16_t period = (uint16_t)(s_edges[bit + 2] - s_edges[bit + 1]);
+    s_Stretch(bit + 2, (period > DHT22_BIT_THRESHOLD) ? -43 : 43);
+}
+
+/* Encode 4 data bytes and their checksum into s_edges from start, with the sensor's jitter */
+static void s_Encode(const uint8_t *const data, const uint16_t start) {
+    uint8_t  bytes[5] = {data[0], data[1], data[2], data[3],
+                         (uint8_t)(data[0] + data[1] + data[2] + data[3])};
+    uint16_t t        = start;
+
+    s_edges[0] = t;
+    t          = (uint16_t)(t + 155U + test_RandomBelow(10));
+    s_edges[1] = t;
+    for (size_t bit = 0; bit < 40U; bit++) {
+        if (bytes[bit / 8] & (0x80U >> (bit % 8))) {
+            t = (uint16_t)(t + 115U + test_RandomBelow(10));
+        } else {
+            t = (uint16_t)(t + 74U + test_RandomBelow(6));
+        }
+        s_edges[bit + 2] = t;
+    }
+}
+
+int main(void) {
+    // the fixed traces, and moved so that the timer wraps in the middle of the transfer
+    s_Expect("warm", s_warm, EDGES, DHT22_SUCCESS, 351, 652);
+    s_Expect("cold", s_cold, EDGES, DHT22_SUCCESS, -101, 450);
+    s_Copy(s_warm, (uint16_t)(0x10000U - 13000U));
+    s_Expect("warm, timer wrap", s_edges, EDGES, DHT22_SUCCESS, 351, 652);
+    s_Copy(s_cold, (uint16_t)(0x10000U - 42000U));
+    s_Expect("cold, timer wrap", s_edges, EDGES, DHT22_SUCCESS, -101, 450);
+
+    // glitch edges before the response are skipped
+    s_edges[0] = 11990;
+    s_edges[1] = 12011;
+    memcpy(&s_edges[2], s_warm, sizeof(s_warm));
+    s_Expect("leading glitches", s_edges, EDGES + 2, DHT22_SUCCESS, 351, 652);
+
+    // no response: nothing captured, a single edge, the response start missed
+    s_Expect("no edges", s_warm, 0, DHT22_ERR_NO_RESPONSE, 0, 0);
+    s_Expect("one edge", s_warm, 1, DHT22_ERR_NO_RESPONSE, 0, 0);
+    s_Expect("response start missed", s_warm + 1, EDGES - 1, DHT22_ERR_NO_RESPONSE, 0, 0);
+    s_Copy(s_warm, 0);
+    s_SetPeriod(1, DHT22_RESPONSE_MAX + 1U);
+    s_Expect("response too long", s_edges, EDGES, DHT22_ERR_NO_RESPONSE, 0, 0);
+
+    // bit periods out of range, and a transfer cut short
+    s_Copy(s_cold, 0);
+    s_SetPeriod(10, DHT22_BIT_PERIOD_MIN - 1U);  // a glitch inside a bit
+    s_Expect("bit period too short", s_edges, EDGES, DHT22_ERR_TIMING, 0, 0);
+    s_Copy(s_cold, 0);
+    s_SetPeriod(30, DHT22_BIT_PERIOD_MAX + 1U);  // a falling edge missed
+    s_Expect("bit period too long", s_edges, EDGES, DHT22_ERR_TIMING, 0, 0);
+    s_Expect("last edge missing", s_cold, EDGES - 1, DHT22_ERR_TIMING, 0, 0);
+
+    // a flipped bit in the data or in the checksum
+    for (size_t bit = 0; bit < 40U; bit++) {
+        s_Copy((bit & 1U) ? s_warm : s_cold, 0);
+        s_FlipBit(bit);
+        s_Expect("flipped bit", s_edges, EDGES, DHT22_ERR_CHECKSUM, 0, 0);
+    }
+
+    // values outside the sensor range, with a valid checksum
+    const uint8_t wet[4]  = {0x03, 0xE9, 0x00, 0xC8};  // 100.1 %RH
+    const uint8_t cold[4] = {0x01, 0xF4, 0x81, 0x91};  // -40.1 degC
+    const uint8_t hot[4]  = {0x01, 0xF4, 0x03, 0x21};  // 80.1 degC
+    s_Encode(wet, 1000);
+    s_Expect("rh above 100 %", s_edges, EDGES, DHT22_ERR_RANGE, 0, 0);
+    s_Encode(cold, 1000);
+    s_Expect("below -40 degC", s_edges, EDGES, DHT22_ERR_RANGE, 0, 0);
+    s_Encode(hot, 1000);
+    s_Expect("above 80 degC", s_edges, EDGES, DHT22_ERR_RANGE, 0, 0);
+
+    // random values of the sensor range at random timer positions
+    for (uint32_t n = 0; n < ROUNDS; n++) {
+        int16_t  temperature = (int16_t)((int32_t)test_RandomBelow(1201) - 400);
+        uint16_t rh          = (uint16_t)test_RandomBelow(1001);
+        uint16_t raw = (temperature < 0) ? (uint16_t)(0x8000U | (uint16_t)-temperature)
+                                         : (uint16_t)temperature;
+        uint8_t  data[4] = {(uint8_t)(rh >> 8), (uint8_t)rh, (uint8_t)(raw >> 8), (uint8_t)raw};
+
+        s_Encode(data, (uint16_t)test_Random());
+        s_Expect("random", s_edges, EDGES, DHT22_SUCCESS, temperature, rh);
+    }
+    return test_Result("dht22_test");
+}
@@ -0,0 +1,100 @@
+"""Gateway scheduler against simulated slaves on a pty (iot-ticket/gateway.py, modbus_sim.py).
+
+One bus of four slaves, slave 3 dead, each slave polled for CO2eq/TVOC and for a register that
+does not exist. The dead slave must go offline and back off, the live slaves must keep their
+period, and their exception replies must keep them online. The metrics are scraped from another
+thread meanwhile, as the metrics server does.
+"""
+import asyncio
+import contextlib
+import io
+import statistics
+import sys
+import threading
+
+from check import check, result
+import gateway
+import modbus_rtu
+import modbus_sim
+import telemetry
+
+PERIOD = 0.3
+DURATION = 4.0
+DEAD = 3
+LIVE = (1, 2, 4)
+MISSING = 0x7000  # no register, the slaves reply with an exception
+
+
+def scrape(metrics, stop, errors, pages):
+    while not stop.is_set():
+        try:
+            pages.append(metrics.render())
+        except Exception as e:
+            errors.append(e)
+
+
+async def run(gw):
+    try:
+        await asyncio.wait_for(gw.run(), DURATION)
+    except asyncio.TimeoutError:
+        pass
+
+
+def main():
+    gateway.BACKOFF_MIN = 0.5
+    bus = modbus_sim.SimBus([modbus_sim.SimSlave(n, 0.003, n == DEAD) for n in LIVE + (DEAD,)])
+    bus.start()
+    samples = []
+    metrics = telemetry.Telemetry()
+    stop = threading.Event()
+    errors = []
+    pages = []
+    scraper = threading.Thread(target=scrape, args=(metrics, stop, errors, pages))
+    polls = [[modbus_rtu.READ_INPUT_REGISTERS, "CO2", 2],
+             [modbus_rtu.READ_INPUT_REGISTERS, MISSING, 1]]
+    gw = gateway.Gateway([{"port": bus.path, "slaves": sorted(LIVE + (DEAD,)), "period": PERIOD,
+                           "polls": polls}], on_sample=samples.append,
+                         telemetry=metrics)
+    scraper.start()
+    try:
+        with contextlib.redirect_stdout(io.StringIO()):  # a line per exception reply
+            asyncio.run(run(gw))
+    finally:
+        stop.set()
+        scraper.join()
+        bus.stop()
+    slaves = {s.address: s for s in gw.buses[0].slaves}
+
+    dead = slaves[DEAD]
+    check(not dead.online, "slave {} is online", DEAD)
+    check(dead.stats["offline"] == 1, "slave {} offline {} times", DEAD, dead.stats["offline"])
+    check(dead.backoff >= 2 * gateway.BACKOFF_MIN, "slave {} backoff {} s", DEAD, dead.backoff)
+    # without the backoff it would get 2 requests per period
+    check(dead.stats["requests"] < DURATION / PERIOD, "slave {}: {} requests", DEAD,
+          dead.stats["requests"])
+    check(not any(s.slave == DEAD for s in samples), "sample of slave {}", DEAD)
+
+    for address in LIVE:
+        slave = slaves[address]
+        times = [s.time for s in samples if s.slave == address]
+        check(slave.online and slave.failures == 0, "slave {} is not online", address)
+        check(slave.stats["exceptions"] >= len(times), "slave {}: {} exceptions, {} samples",
+              address, slave.stats["exceptions"], len(times))
+        check(slave.stats["offline"] == 0, "slave {} went offline", address)
+        check(len(times) >= 0.7 * DURATION / PERIOD, "slave {}: {} samples", address, len(times))
+        intervals = [b - a for a, b in zip(times, times[1:])]
+        median = statistics.median(intervals) if intervals else 0
+        check(abs(median - PERIOD) < 0.1 * PERIOD, "slave {}: median interval {:.3f} s",
+              address, median)
+        check(all(s.values.get("CO2") is not None for s in samples if s.slave == address),
+              "slave {}: sample without CO2", address)
+
+    check(not errors, "scrape failed: {!r}", errors[:1])
+    check(len(pages) > 10, "{} scrapes", len(pages))
+    check('modbus_slave_online{{port="{}",slave="{}"}} 0'.format(bus.path, DEAD) in pages[-1],
+          "slave {} not offline in the metrics", DEAD)
+    return result("gateway_test")
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,42 @@
+"""Check the gateway side decoder (iot-ticket/history_block.py) against the firmware codec.
+
+Usage: python history_block_check.py blocks.jsonl
+The file is written by history_codec_test: the blocks with the records the firmware decoder gave,
+or "error" when it rejected them. The Python decoder must give the same result for every block.
+"""
+import json
+import os
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "iot-ticket"))
+import history_block  # noqa: E402
+
+
+def main(path):
+    checked = failed = 0
+    with open(path) as f:
+        for line in f:
+            sample = json.loads(line)
+            block = bytes.fromhex(sample["block"])
+            checked += 1
+            try:
+                seq, time_s, records = history_block.decode(block)
+            except ValueError as e:
+                if not sample.get("error"):
+                    failed += 1
+                    print("rejected a valid block ({}): {}".format(e, sample["block"]))
+                continue
+            values = [[history_block.INVALID if r[ch] is None else r[ch]
+                       for ch in history_block.CHANNELS] for r in records]
+            if sample.get("error"):
+                failed += 1
+                print("accepted an invalid block: {}".format(sample["block"]))
+            elif (seq, time_s, values) != (sample["seq"], sample["time_s"], sample["records"]):
+                failed += 1
+                print("decoded differently: {}".format(sample["block"]))
+    print("history_block_check: {} blocks, {} failed".format(checked, failed))
+    return 1 if failed or not checked else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1]))
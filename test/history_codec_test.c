@@ -0,0 +1,202 @@
+/*
+ * history_codec_test.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ *
+ * Fuzz test of the history block codec: random blocks round-trip, truncated and corrupted blocks
+ * are rejected, payloads with a recomputed CRC never crash the decoder. With a file argument a
+ * sample of the blocks is written as JSON lines for history_block_check.py.
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "crc.h"
+#include "history_codec.h"
+#include "test.h"
+
+#define FUZZ_BLOCKS     200000U
+#define SAMPLE_EVERY    100U  // every n-th block of each kind goes to the sample file
+#define BLOCK_SIZE_MAX  HISTORY_CODEC_BLOCK_SIZE(HISTORY_CODEC_RECORDS_MAX)
+
+static history_record_t s_records[HISTORY_CODEC_RECORDS_MAX];
+static history_record_t s_decoded[HISTORY_CODEC_RECORDS_MAX];
+static uint8_t          s_block[BLOCK_SIZE_MAX];
+static uint8_t          s_copy[BLOCK_SIZE_MAX];
+
+/* Records like the sensor gives them: random walks, now and then a jump or a failed measurement */
+static uint8_t s_RandomRecords(void) {
+    uint8_t  count = (uint8_t)(1U + test_RandomBelow(HISTORY_CODEC_RECORDS_MAX));
+    uint16_t value[HISTORY_CHANNEL_COUNT];
+    uint32_t invalid = test_RandomBelow(4);  // 0: none, 1: sometimes, 2: one channel, 3: all
+
+    for (uint8_t ch = 0; ch < HISTORY_CHANNEL_COUNT; ch++) {
+        value[ch] = (uint16_t)test_Random();
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        for (uint8_t ch = 0; ch < HISTORY_CHANNEL_COUNT; ch++) {
+            uint32_t r = test_RandomBelow(100);
+            if (r < 2) {
+                value[ch] = (uint16_t)test_Random();
+            } else {
+                value[ch] = (uint16_t)(value[ch] + test_RandomBelow(65) - 32U);
+            }
+            s_records[i].value[ch] = value[ch];
+            if (((invalid == 1) && (r >= 95)) || ((invalid == 2) && (ch == 1)) || (invalid == 3)) {
+                s_records[i].value[ch] = HISTORY_CODEC_INVALID;
+            }
+        }
+    }
+    return count;
+}
+
+static void s_WriteSample(FILE *file, const uint8_t *const block, const size_t len) {
+    history_block_info_t info;
+    int32_t              count;
+
+    if (file == NULL) {
+        return;
+    }
+    fprintf(file, "{\"block\": \"");
+    for (size_t i = 0; i < len; i++) {
+        fprintf(file, "%02x", block[i]);
+    }
+    count = historyCodec_Decode(block, len, &info, s_decoded, HISTORY_CODEC_RECORDS_MAX);
+    if (count < 0) {
+        fprintf(file, "\", \"error\": true}\n");
+        return;
+    }
+    fprintf(file, "\", \"seq\": %u, \"time_s\": %lu, \"records\": [", info.seq,
+            (unsigned long)info.time_s);
+    for (int32_t i = 0; i < count; i++) {
+        fprintf(file, "%s[%u, %u, %u, %u]", i ? ", " : "", s_decoded[i].value[0],
+                s_decoded[i].value[1], s_decoded[i].value[2], s_decoded[i].value[3]);
+    }
+    fprintf(file, "]}\n");
+}
+
+/* Replace the CRC of a corrupted block, so the decoder has to reject the payload itself */
+static void s_FixCrc(uint8_t *const block, const size_t len) {
+    uint16_t crc = CRC16(block, (uint16_t)(len - HISTORY_CODEC_CRC_SIZE));
+    block[len - 2] = (uint8_t)(crc >> 8);
+    block[len - 1] = (uint8_t)(crc & 0xff);
+}
+
+int main(int argc, char *argv[]) {
+    FILE                *sample = NULL;
+    history_block_info_t info;
+    uint32_t             bytes = 0, records = 0, accepted = 0;
+
+    if (argc > 1) {
+        sample = fopen(argv[1], "w");
+        if (sample == NULL) {
+            perror(argv[1]);
+            return 1;
+        }
+    }
+
+    for (uint32_t n = 0; n < FUZZ_BLOCKS; n++) {
+        uint8_t  count = s_RandomRecords();
+        uint16_t seq   = (uint16_t)test_Random();
+        uint32_t time  = test_Random();
+        int32_t  len   = historyCodec_Encode(seq, time, s_records, count, s_block,
+                                             HISTORY_CODEC_BLOCK_SIZE(count));
+        int32_t  result;
+
+        CHECK(len > 0, "block %lu: encode failed", (unsigned long)n);
+        if (len <= 0) {
+            continue;
+        }
+        bytes   += (uint32_t)len;
+        records += count;
+
+        // round trip
+        result = historyCodec_Decode(s_block, (size_t)len, &info, s_decoded, count);
+        CHECK(result == count, "block %lu: decoded %ld of %u records", (unsigned long)n,
+              (long)result, count);
+        CHECK((info.seq == seq) && (info.time_s == time) && (info.count == count),
+              "block %lu: header mismatch", (unsigned long)n);
+        CHECK(0 == memcmp(s_records, s_decoded, count * sizeof(history_record_t)),
+              "block %lu: records differ", (unsigned long)n);
+        CHECK(historyCodec_Decode(s_block, (size_t)len, &info, s_decoded, count - 1U) == -1,
+              "block %lu: accepted more records than records_max", (unsigned long)n);
+        if ((n % SAMPLE_EVERY) == 0) {
+            s_WriteSample(sample, s_block, (size_t)len);
+        }
+
+        // truncated: the CRC is then taken over the wrong bytes
+        size_t cut = test_RandomBelow((uint32_t)len);
+        CHECK(historyCodec_Decode(s_block, cut, &info, s_decoded, HISTORY_CODEC_RECORDS_MAX) == -1,
+              "block %lu: truncated to %lu of %ld bytes accepted", (unsigned long)n,
+              (unsigned long)cut, (long)len);
+
+        // one flipped bit, the CRC16 detects every single bit error
+        memcpy(s_copy, s_block, (size_t)len);
+        s_copy[test_RandomBelow((uint32_t)len)] ^= (uint8_t)(1U << test_RandomBelow(8));
+        CHECK(historyCodec_Decode(s_copy, (size_t)len, &info, s_decoded,
+                                  HISTORY_CODEC_RECORDS_MAX) == -1,
+              "block %lu: corrupted block accepted", (unsigned long)n);
+
+        // corrupted payload or shortened block with a valid CRC: rejected or decoded, no overrun
+        size_t corrupt_len = (size_t)len;
+        memcpy(s_copy, s_block, (size_t)len);
+        if (test_RandomBelow(2) &&
+            ((size_t)len > HISTORY_CODEC_HEADER_SIZE + HISTORY_CODEC_CRC_SIZE)) {
+            corrupt_len = HISTORY_CODEC_HEADER_SIZE + HISTORY_CODEC_CRC_SIZE +
+                          test_RandomBelow((uint32_t)len - HISTORY_CODEC_HEADER_SIZE -
+                                           HISTORY_CODEC_CRC_SIZE);
+        } else {
+            for (uint32_t i = 1U + test_RandomBelow(4); i > 0; i--) {
+                s_copy[test_RandomBelow((uint32_t)len - HISTORY_CODEC_CRC_SIZE)] =
+                    (uint8_t)test_Random();
+            }
+        }
+        s_FixCrc(s_copy, corrupt_len);
+        result = historyCodec_Decode(s_copy, corrupt_len, &info, s_decoded,
+                                     HISTORY_CODEC_RECORDS_MAX);
+        CHECK((result == -1) || (result == info.count), "block %lu: bad result %ld",
+              (unsigned long)n, (long)result);
+        accepted += (result > 0);
+        if ((n % SAMPLE_EVERY) == 1) {
+            s_WriteSample(sample, s_copy, corrupt_len);
+        }
+    }
+
+    // a varint above 0xFFFF in a block with a valid CRC
+    const uint8_t overflow[] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x01, 0xFF, 0xFF, 0x07};
+    memcpy(s_copy, overflow, sizeof(overflow));
+    s_FixCrc(s_copy, sizeof(overflow) + HISTORY_CODEC_CRC_SIZE);
+    CHECK(historyCodec_Decode(s_copy, sizeof(overflow) + HISTORY_CODEC_CRC_SIZE, &info, s_decoded,
+                              HISTORY_CODEC_RECORDS_MAX) == -1,
+          "varint 0x1FFFFF accepted");
+    s_WriteSample(sample, s_copy, sizeof(overflow) + HISTORY_CODEC_CRC_SIZE);
+
+    // a record count of 0 and a mask bit above the channels
+    const uint8_t empty[]   = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01};
+    const uint8_t badmask[] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x11, 0x00, 0x00};
+    memcpy(s_copy, empty, sizeof(empty));
+    s_FixCrc(s_copy, sizeof(empty) + HISTORY_CODEC_CRC_SIZE);
+    CHECK(historyCodec_Decode(s_copy, sizeof(empty) + HISTORY_CODEC_CRC_SIZE, &info, s_decoded,
+                              HISTORY_CODEC_RECORDS_MAX) == -1,
+          "empty block accepted");
+    s_WriteSample(sample, s_copy, sizeof(empty) + HISTORY_CODEC_CRC_SIZE);
+    memcpy(s_copy, badmask, sizeof(badmask));
+    s_FixCrc(s_copy, sizeof(badmask) + HISTORY_CODEC_CRC_SIZE);
+    CHECK(historyCodec_Decode(s_copy, sizeof(badmask) + HISTORY_CODEC_CRC_SIZE, &info, s_decoded,
+                              HISTORY_CODEC_RECORDS_MAX) == -1,
+          "mask 0x11 accepted");
+    s_WriteSample(sample, s_copy, sizeof(badmask) + HISTORY_CODEC_CRC_SIZE);
+
+    // the encoder refuses what does not fit
+    CHECK(historyCodec_Encode(0, 0, s_records, 0, s_block, sizeof(s_block)) == -1,
+          "0 records encoded");
+    CHECK(historyCodec_Encode(0, 0, s_records, 1, s_block, HISTORY_CODEC_HEADER_SIZE) == -1,
+          "block encoded into a buffer without room for the CRC");
+
+    if (sample != NULL) {
+        fclose(sample);
+    }
+    printf("%lu blocks, %.2f bytes per record, %lu corrupted payloads decoded\n",
+           (unsigned long)FUZZ_BLOCKS, (double)bytes / records, (unsigned long)accepted);
+    return test_Result("history_codec_test");
+}
@@ -0,0 +1,90 @@
+/*
+ * humidity_test.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ *
+ * Fixed point absolute humidity against a double precision reference of the same Magnus/Sonntag
+ * formula, for every 0.1 degC and 0.1 %RH step of the input range.
+ */
+#include <math.h>
+#include <stdio.h>
+
+#include "humidity.h"
+#include "test.h"
+
+#define TOLERANCE 0.0005  // 0.05 %
+
+static double s_SaturationRef(const int16_t temperature) {
+    double t = temperature / 10.0;
+    return 611.2 * exp(17.62 * t / (243.12 + t));
+}
+
+static double s_AbsoluteRef(const int16_t temperature, const uint16_t rh) {
+    return 2.16679 * (rh / 1000.0) * s_SaturationRef(temperature) / (273.15 + temperature / 10.0);
+}
+
+/* Within 1 LSB plus 0.05 % of the reference: rounding plus the error of the interpolation */
+static int s_Close(const double value, const double ref, const double lsb) {
+    return fabs(value - ref) <= lsb + TOLERANCE * ref;
+}
+
+int main(void) {
+    double   worst_es = 0.0, worst_q16 = 0.0, worst_88 = 0.0;
+    uint32_t ah;
+
+    for (int16_t t = HUMIDITY_TEMP_MIN; t <= HUMIDITY_TEMP_MAX; t++) {
+        double es  = s_SaturationRef(t);
+        double got = humidity_SaturationPressure(t) / 65536.0;
+        CHECK(s_Close(got, es, 1.0 / 65536.0), "Es(%d) = %f, reference %f", t, got, es);
+        worst_es = fmax(worst_es, fabs(got - es) / es);
+
+        for (uint16_t rh = 0; rh <= HUMIDITY_RH_MAX; rh++) {
+            double ref = s_AbsoluteRef(t, rh);
+            CHECK(humidity_Absolute(t, rh, &ah) == 0, "T %d RH %u rejected", t, rh);
+            CHECK(s_Close(ah / 65536.0, ref, 1.0 / 65536.0), "AH(%d, %u) = %f, reference %f", t,
+                  rh, ah / 65536.0, ref);
+            // the 8.8 value saturates at 1/256...255.996 g/m3
+            double ref88 = fmin(fmax(ref, 1.0 / 256.0), 65535.0 / 256.0);
+            CHECK(s_Close(humidity_ToSgp30(ah) / 256.0, ref88, 1.0 / 256.0),
+                  "8.8 AH(%d, %u) = 0x%04X, reference %f", t, rh, humidity_ToSgp30(ah), ref);
+            if (ref >= 1.0) {
+                worst_q16 = fmax(worst_q16, fabs(ah / 65536.0 - ref) / ref);
+                worst_88  = fmax(worst_88, fabs(humidity_ToSgp30(ah) / 256.0 - ref88) / ref88);
+            }
+        }
+    }
+
+    // out of range inputs
+    ah = 12345U;
+    CHECK(humidity_Absolute(HUMIDITY_TEMP_MIN - 1, 500, &ah) == -1, "T below the table accepted");
+    CHECK(humidity_Absolute(HUMIDITY_TEMP_MAX + 1, 500, &ah) == -1, "T above the table accepted");
+    CHECK(humidity_Absolute(250, HUMIDITY_RH_MAX + 1U, &ah) == -1, "RH above 100 %% accepted");
+    CHECK(ah == 12345U, "output written on error");
+    CHECK(humidity_SaturationPressure(HUMIDITY_TEMP_MIN - 1) == 0, "Es below the table");
+    CHECK(humidity_SaturationPressure(HUMIDITY_TEMP_MAX + 1) == 0, "Es above the table");
+
+    // 8.8 rounding: half an LSB rounds up
+    CHECK(humidity_ToSgp30(0x0001017FU) == 0x0101, "0x0001017F -> 0x%04X",
+          humidity_ToSgp30(0x0001017FU));
+    CHECK(humidity_ToSgp30(0x00010180U) == 0x0102, "0x00010180 -> 0x%04X",
+          humidity_ToSgp30(0x00010180U));
+    CHECK(humidity_ToSgp30(0x000B8000U) == 0x0B80, "11.5 g/m3 -> 0x%04X",
+          humidity_ToSgp30(0x000B8000U));
+    // 8.8 clamp: 0 turns the compensation off, so the smallest value is 1/256 g/m3
+    CHECK(humidity_ToSgp30(0U) == 0x0001, "0 -> 0x%04X", humidity_ToSgp30(0U));
+    CHECK(humidity_ToSgp30(0x7FU) == 0x0001, "0x7F -> 0x%04X", humidity_ToSgp30(0x7FU));
+    CHECK(humidity_ToSgp30(0x180U) == 0x0002, "0x180 -> 0x%04X", humidity_ToSgp30(0x180U));
+    CHECK(humidity_ToSgp30(0x00FFFF7FU) == 0xFFFF, "0x00FFFF7F -> 0x%04X",
+          humidity_ToSgp30(0x00FFFF7FU));
+    CHECK(humidity_ToSgp30(0x00FFFF80U) == 0xFFFF, "0x00FFFF80 -> 0x%04X",
+          humidity_ToSgp30(0x00FFFF80U));
+    CHECK(humidity_ToSgp30(0x01000000U) == 0xFFFF, "0x01000000 -> 0x%04X",
+          humidity_ToSgp30(0x01000000U));
+    CHECK(humidity_ToSgp30(0xFFFFFFFFU) == 0xFFFF, "0xFFFFFFFF -> 0x%04X",
+          humidity_ToSgp30(0xFFFFFFFFU));
+
+    printf("worst relative error: Es %.4f %%, above 1 g/m3 AH Q16.16 %.4f %%, 8.8 %.4f %%\n",
+           100.0 * worst_es, 100.0 * worst_q16, 100.0 * worst_88);
+    return test_Result("humidity_test");
+}
@@ -0,0 +1,90 @@
+"""Paged reading of Client.iterdata against the IoT-Ticket stand-in server (iot-ticket/iotticket).
+
+Every value between the dates must be yielded once, in time order, datanode after datanode,
+with and without prefetch: page boundaries inside a group of values at one timestamp, a full
+page at one timestamp, the date bounds, an early close and a server error.
+"""
+import sys
+import threading
+
+from check import check, result
+import standin_server
+from iotticket.client import Client
+from iotticket.models import criteria
+from iotticket.models import errorinfo
+
+DEVICE = "dev"
+PAGE = 100
+
+
+def names(*items):
+    crit = criteria()
+    crit.criterialist.clear()
+    crit.set_criterialist(*items)
+    return crit
+
+
+def read(client, crit, fromdate, todate, prefetch):
+    return [(name, value.ts, value.v) for name, path, value in
+            client.iterdata(DEVICE, crit, fromdate, todate, pagesize=PAGE, prefetch=prefetch)]
+
+
+def main():
+    server = standin_server.StandInServer(keep=10 ** 6)
+    threading.Thread(target=server.serve_forever, daemon=True).start()
+    client = Client(server.url, "user", "password", retries=0)
+    # A: 2500 values, 3 per timestamp, so that page boundaries fall inside a timestamp
+    # B: 1234 values, one per timestamp
+    # C: a full page and more at ts 5, then one value at ts 6
+    a = [(1000 + i // 3, i) for i in range(2500)]
+    b = [(1000 + i, i) for i in range(1234)]
+    c = [(5, i) for i in range(PAGE + 20)] + [(6, -1)]
+    server.store.write(DEVICE, [{"name": name, "path": "/test", "dataType": "long",
+                                 "values": [{"v": v, "ts": ts} for ts, v in values]}
+                                for name, values in (("A", a), ("B", b), ("C", c))])
+    try:
+        for prefetch in (False, True):
+            mode = "prefetch" if prefetch else "no prefetch"
+            requests = server.store.stats["requests"]
+            got = read(client, names("A", "B"), 0, 10 ** 9, prefetch)
+            expected = [("A", ts, v) for ts, v in a] + [("B", ts, v) for ts, v in b]
+            check([(n, ts, int(v)) for n, ts, v in got] == expected,
+                  "{}: {} of {} values, or out of order", mode, len(got), len(expected))
+            pages = server.store.stats["requests"] - requests
+            check(pages <= len(a) // PAGE * 3 // 2 + len(b) // PAGE + 4, "{}: {} requests",
+                  mode, pages)
+
+            # the dates are inclusive
+            got = read(client, names("B"), 1100, 1599, prefetch)
+            check([int(v) for n, ts, v in got] == list(range(100, 600)), "{}: B 1100...1599 {}",
+                  mode, len(got))
+
+            # a full page at one timestamp can not be paged: its first page, then the next ts
+            got = read(client, names("C"), 0, 10 ** 9, prefetch)
+            check([int(v) for n, ts, v in got] == list(range(PAGE)) + [-1],
+                  "{}: C {} values", mode, len(got))
+
+            # closing the generator early ends the prefetch thread
+            values = client.iterdata(DEVICE, names("A"), 0, 10 ** 9, pagesize=PAGE,
+                                     prefetch=prefetch)
+            next(values)
+            values.close()
+
+            # a server error reaches the consumer
+            server.error_rate = 1.0
+            try:
+                read(client, names("A"), 0, 10 ** 9, prefetch)
+                check(False, "{}: no error raised", mode)
+            except errorinfo as e:
+                check(e.get_httpstatus() == 503, "{}: status {}", mode, e.get_httpstatus())
+            server.error_rate = 0.0
+        # the server keeps a handler thread per keep-alive connection, the prefetch threads run run
+        left = [t.name for t in threading.enumerate() if t.name.endswith("(run)")]
+        check(not left, "prefetch threads left: {}", left)
+    finally:
+        server.shutdown()
+    return result("iterdata_test")
+
+
+if __name__ == "__main__":
+    sys.exit(main())
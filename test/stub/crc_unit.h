@@ -0,0 +1,47 @@
+/*
+ * crc_unit.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ *
+ * Stand-in device header with the configurable CRC unit of the STM32L0/F0/F3, register layout and
+ * bits as in the reference manuals. Only for compiling the hardware CRC backend on the host
+ * (make -C test crc_hw), the kernels cannot run without the peripheral.
+ */
+#ifndef CRC_UNIT_H_
+#define CRC_UNIT_H_
+
+#include <stdint.h>
+
+typedef struct {
+    volatile uint32_t DR;
+    volatile uint32_t IDR;
+    volatile uint32_t CR;
+    uint32_t          RESERVED;
+    volatile uint32_t INIT;
+    volatile uint32_t POL;
+} CRC_TypeDef;
+
+typedef struct {
+    volatile uint32_t AHBENR;
+} RCC_TypeDef;
+
+extern CRC_TypeDef crc_unit;
+extern RCC_TypeDef rcc_unit;
+#define CRC (&crc_unit)
+#define RCC (&rcc_unit)
+
+#define CRC_CR_RESET       0x00000001U
+#define CRC_CR_POLYSIZE_0  0x00000008U
+#define CRC_CR_POLYSIZE_1  0x00000010U
+#define CRC_CR_REV_IN_0    0x00000020U
+#define CRC_CR_REV_IN_1    0x00000040U
+#define CRC_CR_REV_OUT     0x00000080U
+#define CRC_POL_POL        0xFFFFFFFFU
+#define RCC_AHBENR_CRCEN   0x00001000U
+
+static inline uint32_t __get_PRIMASK(void) { return 0; }
+static inline void     __set_PRIMASK(uint32_t primask) { (void)primask; }
+static inline void     __disable_irq(void) {}
+
+#endif /* CRC_UNIT_H_ */
@@ -0,0 +1,49 @@
+/*
+ * test.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef TEST_H_
+#define TEST_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+ * Minimal host test helpers. CHECK counts and prints the failures, a test program returns
+ * test_Result() from main, so make stops at the first failing program.
+ */
+static unsigned s_testChecks;
+static unsigned s_testFailures;
+
+#define CHECK(cond, ...)                                                                \
+    do {                                                                                \
+        s_testChecks++;                                                                 \
+        if (!(cond) && (s_testFailures++ < 20U)) {                                      \
+            printf("%s:%d: CHECK(%s) failed: ", __FILE__, __LINE__, #cond);             \
+            printf(__VA_ARGS__);                                                        \
+            printf("\n");                                                               \
+        }                                                                               \
+    } while (0)
+
+static inline int test_Result(const char *name) {
+    printf("%s: %u checks, %u failed\n", name, s_testChecks, s_testFailures);
+    return s_testFailures ? 1 : 0;
+}
+
+/* xorshift32, fixed seed so that a failure can be repeated */
+static uint32_t s_testRandom = 2463534242U;
+
+static inline uint32_t test_Random(void) {
+    s_testRandom ^= s_testRandom << 13;
+    s_testRandom ^= s_testRandom >> 17;
+    s_testRandom ^= s_testRandom << 5;
+    return s_testRandom;
+}
+
+/* Uniform in 0...n-1 */
+static inline uint32_t test_RandomBelow(const uint32_t n) { return test_Random() % n; }
+
+#endif /* TEST_H_ */
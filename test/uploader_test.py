@@ -0,0 +1,127 @@
+"""Uploader spool against the IoT-Ticket stand-in server (iot-ticket/uploader.py).
+
+Batches refused with 503 or 429, or lost with the connection, are spooled and reach the server
+in order once it answers again, also through a restart of the uploader. A batch rejected with
+another 4xx is dropped, it would be refused again.
+"""
+import os
+import shutil
+import sys
+import tempfile
+import threading
+import time
+
+from check import check, result
+import standin_server
+import uploader
+from iotticket.client import Client
+
+DEVICE = "dev"
+RETRY = 0.05
+
+
+class Server(standin_server.StandInServer):
+    """Stand-in server that refuses the writes with status while status is set."""
+
+    status = None
+
+    def __init__(self):
+        super().__init__()
+        write = self.store.write
+
+        def refuse(deviceId, body):
+            if self.status is not None:
+                raise standin_server.HttpError(self.status, "refused", self.status)
+            return write(deviceId, body)
+        self.store.write = refuse
+
+
+def stored(server, name):
+    node = server.store.nodes.get(DEVICE, {}).get((name, "/test"))
+    return [int(v) for ts, v in node["values"]] if node else []
+
+
+def make(server, spool, logs):
+    client = Client(server.url, "user", "password", retries=1, backoff=0.01)
+    return uploader.Uploader(client, DEVICE, batch_size=4, spool=spool, retry=RETRY,
+                             log=logs.append)
+
+
+def add(up, node, values):
+    for v in values:
+        up.add(node, v, 1000 + v)
+        up.poll()
+
+
+def outage(name, server, spool, fail, recover):
+    """Send 10 samples during an outage, then 10 after the recovery, all must arrive in order."""
+    logs = []
+    up = make(server, spool, logs)
+    node = uploader.Datanode(name, "/test")
+    fail()
+    add(up, node, range(10))
+    check(not up.online, "{}: online during the outage", name)
+    check(up.spooled(), "{}: nothing spooled", name)
+    check(stored(server, name) == [], "{}: stored during the outage", name)
+    check(not any("dropped" in line for line in logs), "{}: batch dropped", name)
+    recover()
+    time.sleep(RETRY)
+    add(up, node, range(10, 20))
+    up.flush()
+    up.poll()
+    check(up.online, "{}: offline after the recovery", name)
+    check(not os.path.exists(spool), "{}: spool left after the drain", name)
+    check(stored(server, name) == list(range(20)), "{}: stored {}", name, stored(server, name))
+
+
+def main():
+    server = Server()
+    threading.Thread(target=server.serve_forever, daemon=True).start()
+    tmp = tempfile.mkdtemp()
+    spool = os.path.join(tmp, "spool.jsonl")
+    try:
+        def set_status(status):
+            server.status = status
+
+        def set_drop(rate):
+            server.drop_rate = rate
+
+        outage("HTTP_503", server, spool, lambda: set_status(503), lambda: set_status(None))
+        outage("HTTP_429", server, spool, lambda: set_status(429), lambda: set_status(None))
+        outage("dropped", server, spool, lambda: set_drop(1.0), lambda: set_drop(0.0))
+
+        # a restart in the middle of the outage: the new uploader drains the old spool
+        logs = []
+        node = uploader.Datanode("restart", "/test")
+        set_status(503)
+        up = make(server, spool, logs)
+        add(up, node, range(8))
+        up = make(server, spool, logs)
+        check(up.spooled(), "restart: spool lost")
+        set_status(None)
+        add(up, node, range(8, 12))
+        check(not os.path.exists(spool), "restart: spool left after the drain")
+        check(stored(server, "restart") == list(range(12)), "restart: stored {}",
+              stored(server, "restart"))
+
+        # other 4xx: the batch is dropped, the spool stays empty
+        logs = []
+        up = make(server, spool, logs)
+        node = uploader.Datanode("rejected", "/test")
+        set_status(400)
+        add(up, node, range(4))
+        set_status(None)
+        check(up.online, "HTTP 400: uploader offline")
+        check(not up.spooled(), "HTTP 400: batch spooled")
+        check(any("dropped" in line for line in logs), "HTTP 400: drop not logged")
+        add(up, node, range(4, 8))
+        check(stored(server, "rejected") == list(range(4, 8)), "HTTP 400: stored {}",
+              stored(server, "rejected"))
+    finally:
+        server.shutdown()
+        shutil.rmtree(tmp)
+    return result("uploader_test")
+
+
+if __name__ == "__main__":
+    sys.exit(main())